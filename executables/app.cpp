@@ -1,5 +1,16 @@
+#include <csignal>
 #include "system/slam_assembly.h"
 
+//ds SLAM system handle for signal handling
+proslam::SLAMAssembly* slam_system_for_signals = nullptr;
+
+//ds SIGUSR1: export the latency profile after the current frame
+void handleSignalUser1(int32_t signal_) {
+  if (slam_system_for_signals) {
+    slam_system_for_signals->requestLatencyProfileExport();
+  }
+}
+
 int32_t main(int32_t argc_, char** argv_) {
 
 #ifdef SRRG_MERGE_DESCRIPTORS
@@ -28,6 +39,8 @@ int32_t main(int32_t argc_, char** argv_) {
 
   //ds allocate SLAM system (has internal access to parameter server)
   proslam::SLAMAssembly slam_system(parameters);
+  slam_system_for_signals = &slam_system;
+  std::signal(SIGUSR1, handleSignalUser1);
 
   //ds worker thread
   std::shared_ptr<std::thread> slam_thread = nullptr;
@@ -95,6 +108,7 @@ int32_t main(int32_t argc_, char** argv_) {
 
     //ds print full report
     slam_system.printReport();
+    slam_system.writeLatencyProfile();
 
     //ds save trajectories to disk
     slam_system.writeTrajectoryKITTI("trajectory_kitti.txt");
@@ -118,6 +132,8 @@ int32_t main(int32_t argc_, char** argv_) {
   }
 
   //ds clean up dynamic memory
+  std::signal(SIGUSR1, SIG_DFL);
+  slam_system_for_signals = nullptr;
   delete parameters;
   return 0;
 }
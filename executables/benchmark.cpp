@@ -0,0 +1,377 @@
+#include <fstream>
+#include <iomanip>
+#include <cstring>
+#include <sys/resource.h>
+#include "system/slam_assembly.h"
+#include "types/trajectory_analysis.h"
+
+using namespace proslam;
+
+//ds latency budget for a single stage quantile
+struct LatencyBudget {
+  LatencyBudget(const std::string& stage_name_,
+                const std::string& quantile_name_,
+                const double& maximum_milliseconds_): stage_name(stage_name_),
+                                                      quantile_name(quantile_name_),
+                                                      maximum_milliseconds(maximum_milliseconds_) {}
+  std::string stage_name;
+  std::string quantile_name;
+  double maximum_milliseconds;
+};
+
+//ds evaluated budget
+struct BudgetCheck {
+  BudgetCheck(const std::string& name_,
+              const double& value_,
+              const double& limit_,
+              const bool& is_upper_limit_): name(name_),
+                                            value(value_),
+                                            limit(limit_),
+                                            is_passed(is_upper_limit_ ? value_ <= limit_ : value_ >= limit_) {}
+  std::string name;
+  double value;
+  double limit;
+  bool is_passed;
+};
+
+//ds replays a KITTI odometry sequence folder (image_0, image_1, calib.txt, times.txt) frame by frame
+void playbackKITTI(SLAMAssembly& slam_system_, const std::string& folder_sequence_);
+
+//ds peak resident set size of this process in megabytes
+const double getPeakResidentSetSizeMegabytes();
+
+int32_t main(int32_t argc_, char** argv_) {
+
+  //ds default configuration
+  std::string folder_kitti_sequence         = "";
+  std::string file_name_ground_truth_kitti  = "";
+  std::string file_name_ground_truth_asl    = "";
+  std::string file_name_report              = "";
+  int32_t number_of_opencv_threads          = 1;
+  double minimum_frames_per_second          = 0;
+  double maximum_peak_memory_megabytes      = 0;
+  double maximum_absolute_trajectory_error  = 0;
+  std::vector<LatencyBudget> latency_budgets;
+
+  //ds parse benchmark configuration - all other arguments are forwarded to the ProSLAM parameter parser
+  std::vector<char*> arguments_proslam(1, argv_[0]);
+  int32_t number_of_checked_parameters = 1;
+  while (number_of_checked_parameters < argc_) {
+    if (!std::strcmp(argv_[number_of_checked_parameters], "-h") || !std::strcmp(argv_[number_of_checked_parameters], "--help")) {
+      std::cerr << "usage: ./benchmark [proslam options] <dataset> [-kitti <sequence folder>] [-ground-truth-kitti <poses.txt>] [-ground-truth-asl <data.csv>]\n"
+                   "                   [-threads <integer>] [-report <report.json>]\n"
+                   "                   [-budget-fps <hz>] [-budget-memory <MB>] [-budget-ate <m>] [-budget-latency <stage> <p50|p95|p99|max> <ms>]*\n"
+                   "without ground truth file the ground truth of the txt_io messages is used (if available)\n"
+                   "exit code: 0 all budgets met, 1 budget exceeded, 2 error" << std::endl;
+      return 0;
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-kitti")) {
+      ++number_of_checked_parameters;
+      if (number_of_checked_parameters == argc_) {break;}
+      folder_kitti_sequence = argv_[number_of_checked_parameters];
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-ground-truth-kitti")) {
+      ++number_of_checked_parameters;
+      if (number_of_checked_parameters == argc_) {break;}
+      file_name_ground_truth_kitti = argv_[number_of_checked_parameters];
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-ground-truth-asl")) {
+      ++number_of_checked_parameters;
+      if (number_of_checked_parameters == argc_) {break;}
+      file_name_ground_truth_asl = argv_[number_of_checked_parameters];
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-threads")) {
+      ++number_of_checked_parameters;
+      if (number_of_checked_parameters == argc_) {break;}
+      number_of_opencv_threads = std::stoi(argv_[number_of_checked_parameters]);
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-report")) {
+      ++number_of_checked_parameters;
+      if (number_of_checked_parameters == argc_) {break;}
+      file_name_report = argv_[number_of_checked_parameters];
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-budget-fps")) {
+      ++number_of_checked_parameters;
+      if (number_of_checked_parameters == argc_) {break;}
+      minimum_frames_per_second = std::stod(argv_[number_of_checked_parameters]);
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-budget-memory")) {
+      ++number_of_checked_parameters;
+      if (number_of_checked_parameters == argc_) {break;}
+      maximum_peak_memory_megabytes = std::stod(argv_[number_of_checked_parameters]);
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-budget-ate")) {
+      ++number_of_checked_parameters;
+      if (number_of_checked_parameters == argc_) {break;}
+      maximum_absolute_trajectory_error = std::stod(argv_[number_of_checked_parameters]);
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-budget-latency")) {
+      if (number_of_checked_parameters+3 >= argc_) {
+        std::cerr << "main|-budget-latency requires: <stage> <p50|p95|p99|max> <ms>" << std::endl;
+        return 2;
+      }
+      latency_budgets.push_back(LatencyBudget(argv_[number_of_checked_parameters+1],
+                                              argv_[number_of_checked_parameters+2],
+                                              std::stod(argv_[number_of_checked_parameters+3])));
+      number_of_checked_parameters += 3;
+    } else {
+      arguments_proslam.push_back(argv_[number_of_checked_parameters]);
+    }
+    ++number_of_checked_parameters;
+  }
+
+  //ds validate latency budgets before spending time on the dataset
+  const std::map<std::string, double> quantiles = {{"p50", 0.5}, {"p95", 0.95}, {"p99", 0.99}, {"max", 1.0}};
+  for (const LatencyBudget& budget: latency_budgets) {
+    if (quantiles.find(budget.quantile_name) == quantiles.end()) {
+      std::cerr << "main|invalid latency budget quantile: " << budget.quantile_name << " (use: p50, p95, p99 or max)" << std::endl;
+      return 2;
+    }
+  }
+
+  //ds load ProSLAM parameters, the benchmark never opens a GUI
+  ParameterCollection* parameters = new ParameterCollection();
+  try {
+    parameters->parseFromCommandLine(arguments_proslam.size(), arguments_proslam.data());
+  } catch (const std::runtime_error& exception_) {
+    std::cerr << "main|caught exception '" << exception_.what() << "'" << std::endl;
+    delete parameters;
+    return 2;
+  }
+  parameters->command_line_parameters->option_use_gui = false;
+  parameters->command_line_parameters->print();
+
+  //ds pin the OpenCV thread count for reproducible timings
+  cv::setUseOptimized(true);
+  cv::setNumThreads(number_of_opencv_threads);
+
+  //ds run the complete dataset
+  std::vector<BudgetCheck> budget_checks;
+  double frames_per_second         = 0;
+  double frames_per_second_wall    = 0;
+  double peak_memory_megabytes     = 0;
+  double absolute_trajectory_error = -1;
+  Count number_of_frames           = 0;
+  try {
+    SLAMAssembly slam_system(parameters);
+    const double time_start_seconds = srrg_core::getTime();
+    if (!folder_kitti_sequence.empty()) {
+      playbackKITTI(slam_system, folder_kitti_sequence);
+    } else {
+      slam_system.loadCamerasFromMessageFile();
+      slam_system.playbackMessageFile();
+    }
+    slam_system.flushBackend();
+    const double duration_seconds_wall = srrg_core::getTime()-time_start_seconds;
+
+    //ds throughput: processing only and including data loading
+    const LatencyHistogram histogram_frame = slam_system.latencyProfiler().histogram(SLAMAssembly::FRAME);
+    number_of_frames = histogram_frame.numberOfSamples();
+    if (number_of_frames == 0) {
+      throw std::runtime_error("no frames processed");
+    }
+    frames_per_second      = number_of_frames/histogram_frame.totalSeconds();
+    frames_per_second_wall = number_of_frames/duration_seconds_wall;
+    peak_memory_megabytes  = getPeakResidentSetSizeMegabytes();
+
+    //ds gather trajectory correspondences from the selected ground truth source
+    PositionCorrespondenceVector position_correspondences;
+    if (!file_name_ground_truth_asl.empty()) {
+
+      //ds timestamp based association (EuRoC)
+      std::vector<std::pair<real, TransformMatrix3D>> poses;
+      slam_system.writeTrajectoryWithTimestamps<real>(poses);
+      PositionMeasurementVector positions;
+      for (const std::pair<real, TransformMatrix3D>& pose: poses) {
+        positions.push_back(PositionMeasurement(pose.first, pose.second.translation()));
+      }
+      position_correspondences = getPositionCorrespondences(positions, loadPositionsASL(file_name_ground_truth_asl));
+    } else if (!file_name_ground_truth_kitti.empty()) {
+
+      //ds index based association (one ground truth pose per image)
+      std::vector<Matrix4, Eigen::aligned_allocator<Matrix4>> poses;
+      slam_system.writeTrajectory<real>(poses);
+      const PositionMeasurementVector positions_ground_truth = loadPositionsKITTI(file_name_ground_truth_kitti);
+      for (size_t index = 0; index < std::min(poses.size(), positions_ground_truth.size()); ++index) {
+        position_correspondences.push_back(std::make_pair(PositionMeasurement(index, poses[index].block<3,1>(0,3)), positions_ground_truth[index]));
+      }
+    } else {
+
+      //ds ground truth delivered with the messages
+      for (const FramePointerMapElement& frame: slam_system.worldMap()->frames()) {
+        if (frame.second->isGroundTruthSet()) {
+          position_correspondences.push_back(std::make_pair(PositionMeasurement(frame.second->timestampImageLeftSeconds(), frame.second->robotToWorld().translation()),
+                                                            PositionMeasurement(frame.second->timestampImageLeftSeconds(), frame.second->robotToWorldGroundTruth().translation())));
+        }
+      }
+    }
+
+    //ds compute ATE after rigid alignment
+    if (!position_correspondences.empty()) {
+      alignPositions(position_correspondences);
+      absolute_trajectory_error = getAbsoluteTranslationRootMeanSquaredError(position_correspondences);
+    } else if (maximum_absolute_trajectory_error > 0) {
+      throw std::runtime_error("ATE budget set but no ground truth available");
+    }
+
+    //ds summary
+    std::cerr << DOUBLE_BAR << std::endl;
+    std::cerr << "benchmark summary" << std::endl;
+    std::cerr << BAR << std::endl;
+    std::cerr << "                    frames: " << number_of_frames << std::endl;
+    std::cerr << "   throughput (processing): " << frames_per_second << " FPS" << std::endl;
+    std::cerr << "         throughput (wall): " << frames_per_second_wall << " FPS (OpenCV threads: " << number_of_opencv_threads << ")" << std::endl;
+    std::cerr << "          peak memory (MB): " << peak_memory_megabytes << std::endl;
+    if (absolute_trajectory_error >= 0) {
+    std::cerr << "                   ATE (m): " << absolute_trajectory_error << " (correspondences: " << position_correspondences.size() << ")" << std::endl;
+    }
+    std::cerr << BAR << std::endl;
+    slam_system.latencyProfiler().print(std::cerr);
+    slam_system.writeLatencyProfile();
+
+    //ds evaluate budgets (only the configured ones)
+    if (minimum_frames_per_second > 0) {
+      budget_checks.push_back(BudgetCheck("throughput_fps", frames_per_second, minimum_frames_per_second, false));
+    }
+    if (maximum_peak_memory_megabytes > 0) {
+      budget_checks.push_back(BudgetCheck("peak_memory_megabytes", peak_memory_megabytes, maximum_peak_memory_megabytes, true));
+    }
+    if (maximum_absolute_trajectory_error > 0) {
+      budget_checks.push_back(BudgetCheck("ate_meters", absolute_trajectory_error, maximum_absolute_trajectory_error, true));
+    }
+    for (const LatencyBudget& budget: latency_budgets) {
+      const std::vector<std::string>& stage_names = slam_system.latencyProfiler().stageNames();
+      const std::vector<std::string>::const_iterator stage = std::find(stage_names.begin(), stage_names.end(), budget.stage_name);
+      if (stage == stage_names.end()) {
+        throw std::runtime_error("unknown latency budget stage: " + budget.stage_name);
+      }
+      const LatencyHistogram histogram = slam_system.latencyProfiler().histogram(stage-stage_names.begin());
+      budget_checks.push_back(BudgetCheck(budget.stage_name + "_" + budget.quantile_name + "_milliseconds",
+                                          1e3*histogram.quantileSeconds(quantiles.at(budget.quantile_name)),
+                                          budget.maximum_milliseconds, true));
+    }
+  } catch (const std::runtime_error& exception_) {
+    std::cerr << DOUBLE_BAR << std::endl;
+    std::cerr << "main|caught runtime exception: '" << exception_.what() << "'" << std::endl;
+    std::cerr << DOUBLE_BAR << std::endl;
+    delete parameters;
+    return 2;
+  }
+  delete parameters;
+
+  //ds report budget results
+  bool is_passed = true;
+  if (!budget_checks.empty()) {
+    std::cerr << BAR << std::endl;
+    for (const BudgetCheck& check: budget_checks) {
+      std::cerr << (check.is_passed ? "PASSED" : "FAILED") << " | " << check.name << ": " << check.value << " (limit: " << check.limit << ")" << std::endl;
+      is_passed = is_passed && check.is_passed;
+    }
+  }
+  std::cerr << DOUBLE_BAR << std::endl;
+
+  //ds write machine-readable report
+  if (!file_name_report.empty()) {
+    std::ofstream stream(file_name_report, std::ofstream::out);
+    if (!stream.is_open()) {
+      std::cerr << "main|unable to write report: " << file_name_report << std::endl;
+      return 2;
+    }
+    stream << std::setprecision(9);
+    stream << "{\n  \"frames\": " << number_of_frames
+           << ",\n  \"fps\": " << frames_per_second
+           << ",\n  \"fps_wall\": " << frames_per_second_wall
+           << ",\n  \"opencv_threads\": " << number_of_opencv_threads
+           << ",\n  \"peak_memory_megabytes\": " << peak_memory_megabytes
+           << ",\n  \"ate_meters\": ";
+    if (absolute_trajectory_error >= 0) {
+      stream << absolute_trajectory_error;
+    } else {
+      stream << "null";
+    }
+    stream << ",\n  \"budgets\": [";
+    for (size_t index = 0; index < budget_checks.size(); ++index) {
+      const BudgetCheck& check = budget_checks[index];
+      stream << ((index > 0) ? "," : "") << "\n    {\"name\": \"" << check.name << "\", \"value\": " << check.value
+             << ", \"limit\": " << check.limit << ", \"passed\": " << (check.is_passed ? "true" : "false") << "}";
+    }
+    stream << "\n  ],\n  \"passed\": " << (is_passed ? "true" : "false") << "\n}\n";
+    stream.close();
+    std::cerr << "main|saved report to: " << file_name_report << std::endl;
+  }
+  return (is_passed) ? 0 : 1;
+}
+
+void playbackKITTI(SLAMAssembly& slam_system_, const std::string& folder_sequence_) {
+
+  //ds load projection matrices of the rectified grayscale cameras (P0: left, P1: right)
+  std::ifstream stream_calibration(folder_sequence_ + "/calib.txt");
+  if (!stream_calibration.is_open()) {
+    throw std::runtime_error("unable to open: " + folder_sequence_ + "/calib.txt");
+  }
+  std::map<std::string, ProjectionMatrix, std::less<std::string>, Eigen::aligned_allocator<std::pair<const std::string, ProjectionMatrix>>> projection_matrices;
+  std::string buffer_line;
+  while (std::getline(stream_calibration, buffer_line)) {
+    std::istringstream stringstream(buffer_line);
+    std::string name;
+    ProjectionMatrix projection_matrix(ProjectionMatrix::Zero());
+    stringstream >> name;
+    for (uint32_t row = 0; row < 3; ++row) {
+      for (uint32_t col = 0; col < 4; ++col) {
+        stringstream >> projection_matrix(row, col);
+      }
+    }
+    if (stringstream) {
+      projection_matrices[name] = projection_matrix;
+    }
+  }
+  stream_calibration.close();
+  if (projection_matrices.count("P0:") == 0 || projection_matrices.count("P1:") == 0) {
+    throw std::runtime_error("calib.txt does not contain P0 and P1");
+  }
+
+  //ds load timestamps (one per image pair)
+  std::ifstream stream_timestamps(folder_sequence_ + "/times.txt");
+  if (!stream_timestamps.is_open()) {
+    throw std::runtime_error("unable to open: " + folder_sequence_ + "/times.txt");
+  }
+  std::vector<double> timestamps_seconds;
+  double timestamp_seconds = 0;
+  while (stream_timestamps >> timestamp_seconds) {
+    timestamps_seconds.push_back(timestamp_seconds);
+  }
+  stream_timestamps.close();
+  if (timestamps_seconds.empty()) {
+    throw std::runtime_error("no timestamps in: " + folder_sequence_ + "/times.txt");
+  }
+
+  //ds the image dimensions are taken from the first image
+  char buffer_file_name[32];
+  std::snprintf(buffer_file_name, sizeof(buffer_file_name), "%06u.png", 0);
+  const cv::Mat image_first = cv::imread(folder_sequence_ + "/image_0/" + buffer_file_name, CV_LOAD_IMAGE_GRAYSCALE);
+  if (image_first.empty()) {
+    throw std::runtime_error("unable to load first image: " + folder_sequence_ + "/image_0/" + buffer_file_name);
+  }
+
+  //ds set up cameras (the baseline is encoded in the right projection matrix)
+  const ProjectionMatrix& projection_matrix_left  = projection_matrices.at("P0:");
+  const ProjectionMatrix& projection_matrix_right = projection_matrices.at("P1:");
+  Camera* camera_left = new Camera(image_first.rows, image_first.cols, projection_matrix_left.block<3,3>(0,0));
+  camera_left->setProjectionMatrix(projection_matrix_left);
+  Camera* camera_right = new Camera(image_first.rows, image_first.cols, projection_matrix_right.block<3,3>(0,0));
+  camera_right->setProjectionMatrix(projection_matrix_right);
+  camera_right->setBaselineHomogeneous(projection_matrix_right.col(3));
+  slam_system_.loadCameras(camera_left, camera_right);
+
+  //ds process all image pairs in order
+  for (Index index_image = 0; index_image < timestamps_seconds.size(); ++index_image) {
+    std::snprintf(buffer_file_name, sizeof(buffer_file_name), "%06u.png", index_image);
+    const cv::Mat image_left  = cv::imread(folder_sequence_ + "/image_0/" + buffer_file_name, CV_LOAD_IMAGE_GRAYSCALE);
+    const cv::Mat image_right = cv::imread(folder_sequence_ + "/image_1/" + buffer_file_name, CV_LOAD_IMAGE_GRAYSCALE);
+    if (image_left.empty() || image_right.empty()) {
+      throw std::runtime_error("unable to load image pair: " + std::string(buffer_file_name));
+    }
+    slam_system_.process(image_left, image_right, timestamps_seconds[index_image]);
+  }
+}
+
+const double getPeakResidentSetSizeMegabytes() {
+  struct rusage resource_usage;
+  if (getrusage(RUSAGE_SELF, &resource_usage) != 0) {
+    return 0;
+  }
+
+  //ds ru_maxrss is reported in kilobytes on Linux
+  return resource_usage.ru_maxrss/1e3;
+}
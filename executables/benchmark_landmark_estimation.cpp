@@ -0,0 +1,292 @@
+#include <fstream>
+#include <random>
+#include <numeric>
+#include <cstring>
+#include "types/world_map.h"
+
+using namespace proslam;
+
+//ds simulated landmark track
+struct Track {
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  Track(const Index& identifier_, const PointCoordinates& world_coordinates_, const Count& length_): identifier(identifier_),
+                                                                                                   world_coordinates(world_coordinates_),
+                                                                                                   length(length_) {}
+  Index identifier;
+  PointCoordinates world_coordinates;
+  Count length;
+  FramePoint* last_point       = nullptr;
+  Landmark* landmark           = nullptr;
+  Count number_of_measurements = 0;
+};
+
+//ds estimation statistics of a single run
+struct Result {
+  double duration_seconds_total = 0;
+  Count number_of_updates       = 0;
+
+  //ds update cost per track length bucket (seconds, updates)
+  std::vector<double> duration_seconds_per_bucket;
+  std::vector<Count> number_of_updates_per_bucket;
+
+  //ds final landmark estimate for each track (identifier) and its squared error to the ground truth
+  std::map<Index, PointCoordinates, std::less<Index>, Eigen::aligned_allocator<std::pair<const Index, PointCoordinates>>> estimates;
+  double error_squared_total = 0;
+};
+
+//ds track length buckets (upper bounds)
+const std::vector<Count> track_length_buckets = {10, 25, 50, 100, 250, std::numeric_limits<Count>::max()};
+
+//ds simulates a forward moving stereo camera observing tracks of the given lengths and estimates all landmarks
+void simulate(Result& result_,
+              const std::vector<Count>& track_lengths_,
+              const Count& number_of_frames_,
+              const Count& number_of_tracks_per_frame_,
+              const Count& number_of_measurements_in_window_,
+              const uint32_t& seed_);
+
+int32_t main(int32_t argc_, char** argv_) {
+
+  //ds default configuration
+  std::string file_name_track_lengths    = "";
+  Count number_of_frames                 = 1000;
+  Count number_of_tracks_per_frame       = 150;
+  Count number_of_measurements_in_window = 10;
+  uint32_t seed                          = 0;
+
+  //ds parse configuration
+  int32_t number_of_checked_parameters = 1;
+  while (number_of_checked_parameters < argc_) {
+    if (!std::strcmp(argv_[number_of_checked_parameters], "-h") || !std::strcmp(argv_[number_of_checked_parameters], "--help")) {
+      std::cerr << "usage: ./benchmark_landmark_estimation [-tracks <track_lengths.txt>] [-frames <integer>] [-points <integer>] [-window <integer>] [-seed <integer>]" << std::endl;
+      std::cerr << "track_lengths.txt: recorded track lengths, one per line (if not provided a geometric distribution with mean 25 is used)" << std::endl;
+      return 0;
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-tracks")) {
+      ++number_of_checked_parameters;
+      if (number_of_checked_parameters == argc_) {break;}
+      file_name_track_lengths = argv_[number_of_checked_parameters];
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-frames")) {
+      ++number_of_checked_parameters;
+      if (number_of_checked_parameters == argc_) {break;}
+      number_of_frames = std::stoi(argv_[number_of_checked_parameters]);
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-points")) {
+      ++number_of_checked_parameters;
+      if (number_of_checked_parameters == argc_) {break;}
+      number_of_tracks_per_frame = std::stoi(argv_[number_of_checked_parameters]);
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-window")) {
+      ++number_of_checked_parameters;
+      if (number_of_checked_parameters == argc_) {break;}
+      number_of_measurements_in_window = std::stoi(argv_[number_of_checked_parameters]);
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-seed")) {
+      ++number_of_checked_parameters;
+      if (number_of_checked_parameters == argc_) {break;}
+      seed = std::stoi(argv_[number_of_checked_parameters]);
+    }
+    ++number_of_checked_parameters;
+  }
+
+  //ds load recorded track lengths if provided
+  std::vector<Count> track_lengths;
+  if (!file_name_track_lengths.empty()) {
+    std::ifstream input_stream_track_lengths(file_name_track_lengths);
+    if (!input_stream_track_lengths.good() || !input_stream_track_lengths.is_open()) {
+      std::cerr << "ERROR: unable to open: '" << file_name_track_lengths << "'" << std::endl;
+      return -1;
+    }
+    int64_t track_length = 0;
+    while (input_stream_track_lengths >> track_length) {
+      if (track_length > 1) {
+        track_lengths.push_back(track_length);
+      }
+    }
+    if (track_lengths.empty()) {
+      std::cerr << "ERROR: no track lengths (> 1) in: '" << file_name_track_lengths << "'" << std::endl;
+      return -1;
+    }
+  } else {
+
+    //ds long-tailed synthetic distribution (mean 25)
+    std::mt19937 generator(seed);
+    std::geometric_distribution<Count> track_length_distribution(1.0/23);
+    track_lengths.resize(10000);
+    for (Count& track_length: track_lengths) {
+      track_length = 2+track_length_distribution(generator);
+    }
+  }
+  const Count track_length_maximum = *std::max_element(track_lengths.begin(), track_lengths.end());
+  const double track_length_mean   = std::accumulate(track_lengths.begin(), track_lengths.end(), 0.0)/track_lengths.size();
+
+  //ds log configuration
+  std::cerr << "file_name_track_lengths: '" << file_name_track_lengths << "' (tracks: " << track_lengths.size()
+            << ", mean length: " << track_length_mean << ", maximum length: " << track_length_maximum << ")" << std::endl;
+  std::cerr << "number_of_frames: " << number_of_frames << std::endl;
+  std::cerr << "number_of_tracks_per_frame: " << number_of_tracks_per_frame << std::endl;
+  std::cerr << "number_of_measurements_in_window: " << number_of_measurements_in_window << std::endl;
+  std::cerr << "seed: " << seed << std::endl;
+
+  //ds run both estimators on identical data: full re-estimation over all measurements and the windowed estimation with marginalized prior
+  Result result_full;
+  Result result_window;
+  std::cerr << "running full estimation" << std::endl;
+  simulate(result_full, track_lengths, number_of_frames, number_of_tracks_per_frame, 0, seed);
+  std::cerr << "running windowed estimation" << std::endl;
+  simulate(result_window, track_lengths, number_of_frames, number_of_tracks_per_frame, number_of_measurements_in_window, seed);
+
+  //ds difference between the estimates of both estimators
+  double difference_squared_total = 0;
+  Count number_of_compared_landmarks = 0;
+  for (const auto& estimate_full: result_full.estimates) {
+    const auto estimate_window = result_window.estimates.find(estimate_full.first);
+    if (estimate_window != result_window.estimates.end()) {
+      difference_squared_total += (estimate_full.second-estimate_window->second).squaredNorm();
+      ++number_of_compared_landmarks;
+    }
+  }
+
+  //ds report
+  std::cerr << BAR << std::endl;
+  std::printf("         estimator |  updates | total (s) | mean (us/update) | landmark RMSE (m)\n");
+  std::cerr << BAR << std::endl;
+  std::printf("              full | %8u | %9.4f | %16.3f | %f\n", result_full.number_of_updates, result_full.duration_seconds_total,
+              1e6*result_full.duration_seconds_total/std::max(result_full.number_of_updates, Count(1)),
+              std::sqrt(result_full.error_squared_total/std::max(result_full.estimates.size(), size_t(1))));
+  std::printf("  window + prior %2u | %8u | %9.4f | %16.3f | %f\n", number_of_measurements_in_window, result_window.number_of_updates, result_window.duration_seconds_total,
+              1e6*result_window.duration_seconds_total/std::max(result_window.number_of_updates, Count(1)),
+              std::sqrt(result_window.error_squared_total/std::max(result_window.estimates.size(), size_t(1))));
+  std::cerr << BAR << std::endl;
+  std::printf("   track length <= | full (us/update) | window (us/update) | updates\n");
+  std::cerr << BAR << std::endl;
+  for (Index index = 0; index < track_length_buckets.size(); ++index) {
+    if (result_full.number_of_updates_per_bucket[index] == 0) {
+      continue;
+    }
+    std::printf("        %10u | %16.3f | %18.3f | %u\n", track_length_buckets[index],
+                1e6*result_full.duration_seconds_per_bucket[index]/result_full.number_of_updates_per_bucket[index],
+                1e6*result_window.duration_seconds_per_bucket[index]/std::max(result_window.number_of_updates_per_bucket[index], Count(1)),
+                result_full.number_of_updates_per_bucket[index]);
+  }
+  std::cerr << BAR << std::endl;
+  std::cerr << "RMSE between full and windowed estimates (m): " << std::sqrt(difference_squared_total/std::max(number_of_compared_landmarks, Count(1)))
+            << " (landmarks: " << number_of_compared_landmarks << ")" << std::endl;
+  return 0;
+}
+
+void simulate(Result& result_,
+              const std::vector<Count>& track_lengths_,
+              const Count& number_of_frames_,
+              const Count& number_of_tracks_per_frame_,
+              const Count& number_of_measurements_in_window_,
+              const uint32_t& seed_) {
+  result_.duration_seconds_per_bucket.assign(track_length_buckets.size(), 0);
+  result_.number_of_updates_per_bucket.assign(track_length_buckets.size(), 0);
+
+  //ds identical random sequence for all estimators
+  std::mt19937 generator(seed_);
+  std::uniform_int_distribution<Index> track_length_sampler(0, track_lengths_.size()-1);
+  std::uniform_real_distribution<real> depth_sampler(2, 40);
+  std::uniform_real_distribution<real> image_sampler(-0.8, 0.8);
+  std::uniform_real_distribution<real> outlier_sampler(0, 1);
+  std::normal_distribution<real> noise(0, 1);
+
+  //ds configure the map (landmarks are created from framepoints with at least 2 measurements, as in tracking)
+  WorldMapParameters parameters;
+  parameters.landmark->maximum_error_squared_meters     = 100;
+  parameters.landmark->number_of_measurements_in_window = number_of_measurements_in_window_;
+  std::shared_ptr<WorldMap> world_map(std::make_shared<WorldMap>(&parameters));
+
+  //ds camera with a 90 degree field of view (the stereo noise model is applied directly to the camera coordinates)
+  CameraMatrix camera_matrix(CameraMatrix::Identity());
+  camera_matrix << 400, 0, 400, 0, 400, 300, 0, 0, 1;
+  Camera camera(600, 800, camera_matrix);
+  const real baseline_meters = 0.5;
+  const real focal_length    = camera_matrix(0, 0);
+
+  //ds simulation
+  std::vector<Track*> tracks;
+  Index identifier_next_track = 0;
+  for (Index index_frame = 0; index_frame < number_of_frames_; ++index_frame) {
+
+    //ds robot moves forward on a slight curve
+    TransformMatrix3D robot_to_world(TransformMatrix3D::Identity());
+    robot_to_world.linear()      = Eigen::AngleAxis<real>(0.2*std::sin(0.01*index_frame), Vector3::UnitY()).toRotationMatrix();
+    robot_to_world.translation() = Vector3(5*std::sin(0.01*index_frame), 0, 0.5*index_frame);
+    world_map->setRobotToWorld(robot_to_world);
+    Frame* frame = world_map->createFrame(index_frame);
+    frame->setCameraLeft(&camera);
+    frame->setRobotToWorld(robot_to_world);
+
+    //ds spawn new tracks in the field of view
+    while (tracks.size() < number_of_tracks_per_frame_) {
+      const real depth_meters = depth_sampler(generator);
+      const PointCoordinates camera_coordinates(image_sampler(generator)*depth_meters, 0.5*image_sampler(generator)*depth_meters, depth_meters);
+      tracks.push_back(new Track(identifier_next_track, robot_to_world*camera_coordinates, track_lengths_[track_length_sampler(generator)]));
+      ++identifier_next_track;
+    }
+
+    //ds measure all tracks
+    std::vector<Track*> tracks_active;
+    tracks_active.reserve(tracks.size());
+    for (Track* track: tracks) {
+      const PointCoordinates camera_coordinates_true = frame->worldToCameraLeft()*track->world_coordinates;
+
+      //ds terminate track if finished or not visible anymore
+      if (track->number_of_measurements == track->length || camera_coordinates_true.z() < 1) {
+        if (track->landmark) {
+          result_.estimates.insert(std::make_pair(track->identifier, track->landmark->coordinates()));
+          result_.error_squared_total += (track->landmark->coordinates()-track->world_coordinates).squaredNorm();
+        }
+        delete track;
+        continue;
+      }
+
+      //ds stereo noise: the depth uncertainty grows quadratically with the depth (1 pixel disparity noise), 2% gross outliers
+      const real depth_meters = camera_coordinates_true.z();
+      real sigma_depth_meters = depth_meters*depth_meters/(focal_length*baseline_meters);
+      if (outlier_sampler(generator) < 0.02) {
+        sigma_depth_meters *= 20;
+      }
+      const PointCoordinates camera_coordinates_measured(camera_coordinates_true.x()+noise(generator)*depth_meters/focal_length,
+                                                         camera_coordinates_true.y()+noise(generator)*depth_meters/focal_length,
+                                                         std::max(depth_meters+noise(generator)*sigma_depth_meters, 0.1));
+
+      //ds create a framepoint connected to the track
+      const IntensityFeature feature(cv::KeyPoint(0, 0, 7), BinaryDescriptor(), 0);
+      FramePoint* point = frame->createFramepoint(&feature, camera_coordinates_measured, track->last_point);
+      track->last_point = point;
+      ++track->number_of_measurements;
+
+      //ds landmark estimation (timed)
+      if (track->number_of_measurements > 1) {
+        const double time_start_seconds = srrg_core::getTime();
+        if (!track->landmark) {
+          track->landmark = world_map->createLandmark(point);
+        } else {
+          track->landmark->update(point);
+        }
+        const double duration_seconds = srrg_core::getTime()-time_start_seconds;
+        result_.duration_seconds_total += duration_seconds;
+        ++result_.number_of_updates;
+
+        //ds bookkeep cost per track length
+        Index index_bucket = 0;
+        while (track->length > track_length_buckets[index_bucket]) {
+          ++index_bucket;
+        }
+        result_.duration_seconds_per_bucket[index_bucket] += duration_seconds;
+        ++result_.number_of_updates_per_bucket[index_bucket];
+      }
+      tracks_active.push_back(track);
+    }
+    tracks.swap(tracks_active);
+  }
+
+  //ds collect remaining estimates
+  for (Track* track: tracks) {
+    if (track->landmark) {
+      result_.estimates.insert(std::make_pair(track->identifier, track->landmark->coordinates()));
+      result_.error_squared_total += (track->landmark->coordinates()-track->world_coordinates).squaredNorm();
+    }
+    delete track;
+  }
+  world_map->clear();
+}
@@ -0,0 +1,52 @@
+#include "base_frame_aligner.h"
+
+namespace proslam {
+
+  //ds number of measurements per linearization chunk (fixed, the summation order does not depend on the number of threads)
+  const Count number_of_measurements_per_chunk = 128;
+
+  void BaseFrameAligner::_linearizeInChunks(const std::function<void(const Index&, const Index&, LinearizationChunk&)>& linearize_chunk_, Matrix6& H_, Vector6& b_) {
+    if (_parameters->number_of_linearization_threads > 1 && !_thread_pool) {
+      _thread_pool = std::make_shared<ThreadPool>(_parameters->number_of_linearization_threads);
+    }
+
+    //ds reset chunk accumulators
+    const Count number_of_chunks = (_number_of_measurements+number_of_measurements_per_chunk-1)/number_of_measurements_per_chunk;
+    _linearization_chunks.resize(number_of_chunks);
+    _inlier_flags.resize(_number_of_measurements);
+    auto linearize = [&](const Index& index_chunk_) {
+      LinearizationChunk& chunk = _linearization_chunks[index_chunk_];
+      chunk.H.setZero();
+      chunk.b.setZero();
+      chunk.number_of_inliers = 0;
+      chunk.total_error       = 0;
+      const Index index_begin = index_chunk_*number_of_measurements_per_chunk;
+      linearize_chunk_(index_begin, std::min(index_begin+number_of_measurements_per_chunk, _number_of_measurements), chunk);
+    };
+
+    //ds linearize chunks
+    if (_thread_pool) {
+      _thread_pool->execute(number_of_chunks, linearize);
+    } else {
+      for (Index index_chunk = 0; index_chunk < number_of_chunks; ++index_chunk) {
+        linearize(index_chunk);
+      }
+    }
+
+    //ds deterministic reduction in chunk order
+    H_.setZero();
+    b_.setZero();
+    _number_of_inliers = 0;
+    _total_error       = 0;
+    for (const LinearizationChunk& chunk: _linearization_chunks) {
+      H_ += chunk.H;
+      b_ += chunk.b;
+      _number_of_inliers += chunk.number_of_inliers;
+      _total_error       += chunk.total_error;
+    }
+    _number_of_outliers = _number_of_measurements-_number_of_inliers;
+    for (Index u = 0; u < _number_of_measurements; ++u) {
+      _inliers[u] = _inlier_flags[u];
+    }
+  }
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "types/frame.h"
+#include "types/thread_pool.h"
 #include "base_aligner.h"
 
 namespace proslam {
@@ -26,6 +27,26 @@ public:
 
   inline const TransformMatrix3D& previousToCurrent() const {return _previous_to_current;}
 
+//ds helpers
+protected:
+
+  //! @brief linear system contribution of a chunk of measurements (6 states)
+  struct LinearizationChunk {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    Matrix6 H               = Matrix6::Zero();
+    Vector6 b               = Vector6::Zero();
+    Count number_of_inliers = 0;
+    real total_error        = 0;
+  };
+
+  //! @brief linearizes all measurements in chunks of fixed size, in parallel if number_of_linearization_threads > 1
+  //! @brief the chunks are summed in chunk order, hence the result does not depend on the number of threads
+  //! @param[in] linearize_chunk_ accumulates the measurements in [index_begin, index_end) into the (zero) chunk, it may only write
+  //! @param[in] linearize_chunk_ per-measurement buffers (e.g. _errors) and has to set the inlier flags in _inlier_flags
+  //! @param[out] H_ summed system matrix
+  //! @param[out] b_ summed system vector
+  void _linearizeInChunks(const std::function<void(const Index&, const Index&, LinearizationChunk&)>& linearize_chunk_, Matrix6& H_, Vector6& b_);
+
 //ds attributes
 protected:
 
@@ -38,6 +59,15 @@ protected:
 
   Count _number_of_rows_image = 0;
   Count _number_of_cols_image = 0;
+
+  //! @brief inlier flags written during parallel linearization (copied to _inliers afterwards)
+  std::vector<uint8_t> _inlier_flags;
+
+  //! @brief chunk accumulators of the last linearization
+  std::vector<LinearizationChunk, Eigen::aligned_allocator<LinearizationChunk> > _linearization_chunks;
+
+  //! @brief thread pool for parallel linearization (allocated on first use if number_of_linearization_threads > 1)
+  ThreadPoolPtr _thread_pool = nullptr;
 };
 
 typedef std::shared_ptr<BaseFrameAligner> BaseFrameAlignerPtr;
@@ -71,119 +71,114 @@ namespace proslam {
   //ds linearize the system: to be called inside oneRound
   void StereoUVAligner::linearize(const bool& ignore_outliers_) {
 
-    //ds initialize setup
-    _H.setZero();
-    _b.setZero();
-    _number_of_inliers = 0;
-    _total_error       = 0;
+    //ds linearize all current framepoints (assuming that each of them has a previous one) in independent chunks
+    _linearizeInChunks([&](const Index& index_begin_, const Index& index_end_, LinearizationChunk& chunk_) {
+      for (Index u = index_begin_; u < index_end_; ++u) {
+        _errors[u]       = -1;
+        _inlier_flags[u] = false;
+        Matrix4 omega    = _information_matrix_vector[u];
+
+        //ds compute the point in the camera frame - prefering a landmark estimate if available
+        const PointCoordinates sampled_point_in_camera_left = _previous_to_current*_moving[u];
+        if (sampled_point_in_camera_left.z() < _minimum_reliable_depth_meters) {
+          continue;
+        }
 
-    //ds loop over all current framepoints (assuming that each of them has a previous one)
-    for (Index u = 0; u < _number_of_measurements; ++u) {
-      _errors[u]  = -1;
-      _inliers[u] = false;
-      _omega      = _information_matrix_vector[u];
-
-      //ds compute the point in the camera frame - prefering a landmark estimate if available
-      const PointCoordinates sampled_point_in_camera_left = _previous_to_current*_moving[u];
-      if (sampled_point_in_camera_left.z() < _minimum_reliable_depth_meters) {
-        continue;
-      }
+        //ds retrieve projections on left and right camera image plane
+        const PointCoordinates sampled_abc_in_camera_left  = _camera_calibration_matrix*sampled_point_in_camera_left;
+        const PointCoordinates sampled_abc_in_camera_right = sampled_abc_in_camera_left+_offset_camera_right;
+        const real& sampled_c_left  = sampled_abc_in_camera_left.z();
+        const real& sampled_c_right = sampled_abc_in_camera_right.z();
 
-      //ds retrieve projections on left and right camera image plane
-      const PointCoordinates sampled_abc_in_camera_left  = _camera_calibration_matrix*sampled_point_in_camera_left;
-      const PointCoordinates sampled_abc_in_camera_right = sampled_abc_in_camera_left+_offset_camera_right;
-      const real& sampled_c_left  = sampled_abc_in_camera_left.z();
-      const real& sampled_c_right = sampled_abc_in_camera_right.z();
+        //ds compute the image coordinates
+        const PointCoordinates sampled_point_in_image_left  = sampled_abc_in_camera_left/sampled_c_left;
+        const PointCoordinates sampled_point_in_image_right = sampled_abc_in_camera_right/sampled_c_right;
 
-      //ds compute the image coordinates
-      const PointCoordinates sampled_point_in_image_left  = sampled_abc_in_camera_left/sampled_c_left;
-      const PointCoordinates sampled_point_in_image_right = sampled_abc_in_camera_right/sampled_c_right;
+        //ds if the point is outside the image, skip
+        if (sampled_point_in_image_left.x() < 0 || sampled_point_in_image_left.x() > _number_of_cols_image||
+            sampled_point_in_image_left.y() < 0 || sampled_point_in_image_left.y() > _number_of_rows_image) {
+          continue;
+        }
+        if (sampled_point_in_image_right.x() < 0 || sampled_point_in_image_right.x() > _number_of_cols_image||
+            sampled_point_in_image_right.y() < 0 || sampled_point_in_image_right.y() > _number_of_rows_image) {
+          continue;
+        }
+        assert(_frame_current->cameraLeft()->isInFieldOfView(sampled_point_in_image_left));
+        assert(_frame_current->cameraRight()->isInFieldOfView(sampled_point_in_image_right));
 
-      //ds if the point is outside the image, skip
-      if (sampled_point_in_image_left.x() < 0 || sampled_point_in_image_left.x() > _number_of_cols_image||
-          sampled_point_in_image_left.y() < 0 || sampled_point_in_image_left.y() > _number_of_rows_image) {
-        continue;
-      }
-      if (sampled_point_in_image_right.x() < 0 || sampled_point_in_image_right.x() > _number_of_cols_image||
-          sampled_point_in_image_right.y() < 0 || sampled_point_in_image_right.y() > _number_of_rows_image) {
-        continue;
-      }
-      assert(_frame_current->cameraLeft()->isInFieldOfView(sampled_point_in_image_left));
-      assert(_frame_current->cameraRight()->isInFieldOfView(sampled_point_in_image_right));
+        //ds compute error (we compute the vertical error only once, since we assume rectified cameras)
+        const Vector4 error(sampled_point_in_image_left.x()-_fixed[u](0),
+                            sampled_point_in_image_left.y()-_fixed[u](1),
+                            sampled_point_in_image_right.x()-_fixed[u](2),
+                            sampled_point_in_image_right.y()-_fixed[u](3));
 
-      //ds compute error (we compute the vertical error only once, since we assume rectified cameras)
-      const Vector4 error(sampled_point_in_image_left.x()-_fixed[u](0),
-                          sampled_point_in_image_left.y()-_fixed[u](1),
-                          sampled_point_in_image_right.x()-_fixed[u](2),
-                          sampled_point_in_image_right.y()-_fixed[u](3));
+        //ds compute squared error
+        const real chi = error.transpose()*omega*error;
 
-      //ds compute squared error
-      const real chi = error.transpose()*_omega*error;
+        //ds update error stats
+        _errors[u] = chi;
 
-      //ds update error stats
-      _errors[u] = chi;
+        //ds check if outlier
+        if (chi > _parameters->maximum_error_kernel) {
+          if (ignore_outliers_) {
+            continue;
+          }
 
-      //ds check if outlier
-      if (chi > _parameters->maximum_error_kernel) {
-        if (ignore_outliers_) {
-          continue;
+          //ds proportionally reduce information value of the measurement
+          omega *= _parameters->maximum_error_kernel/chi;
+        } else {
+          _inlier_flags[u] = true;
+          ++chunk_.number_of_inliers;
         }
 
-        //ds proportionally reduce information value of the measurement
-        _omega *= _parameters->maximum_error_kernel/chi;
-      } else {
-        _inliers[u] = true;
-        ++_number_of_inliers;
-      }
-
-      //ds update total error
-      _total_error += _errors[u];
+        //ds update total error
+        chunk_.total_error += _errors[u];
 
-      //ds compute the jacobian of the transformation
-      Matrix3_6 jacobian_transform;
+        //ds compute the jacobian of the transformation
+        Matrix3_6 jacobian_transform;
 
-      //ds translation contribution (will be scaled with omega)
-      jacobian_transform.block<3,3>(0,0) = _weights_translation[u]*Matrix3::Identity();
+        //ds translation contribution (will be scaled with omega)
+        jacobian_transform.block<3,3>(0,0) = _weights_translation[u]*Matrix3::Identity();
 
-      //ds rotation contribution - compensate for inverse depth (far points should have an equally strong contribution as close ones)
-      jacobian_transform.block<3,3>(0,3) = -2*srrg_core::skew(sampled_point_in_camera_left);
+        //ds rotation contribution - compensate for inverse depth (far points should have an equally strong contribution as close ones)
+        jacobian_transform.block<3,3>(0,3) = -2*srrg_core::skew(sampled_point_in_camera_left);
 
-      //ds precompute
-      const Matrix3_6 camera_matrix_per_jacobian_transform(_camera_calibration_matrix*jacobian_transform);
+        //ds precompute
+        const Matrix3_6 camera_matrix_per_jacobian_transform(_camera_calibration_matrix*jacobian_transform);
 
-      //ds precompute
-      const real inverse_sampled_c_left  = 1/sampled_c_left;
-      const real inverse_sampled_c_right = 1/sampled_c_right;
-      const real inverse_sampled_c_squared_left  = inverse_sampled_c_left*inverse_sampled_c_left;
-      const real inverse_sampled_c_squared_right = inverse_sampled_c_right*inverse_sampled_c_right;
+        //ds precompute
+        const real inverse_sampled_c_left  = 1/sampled_c_left;
+        const real inverse_sampled_c_right = 1/sampled_c_right;
+        const real inverse_sampled_c_squared_left  = inverse_sampled_c_left*inverse_sampled_c_left;
+        const real inverse_sampled_c_squared_right = inverse_sampled_c_right*inverse_sampled_c_right;
 
-      //ds jacobian parts of the homogeneous division: left
-      Matrix2_3 jacobian_left;
-      jacobian_left << inverse_sampled_c_left, 0, -sampled_abc_in_camera_left.x()*inverse_sampled_c_squared_left,
-                       0, inverse_sampled_c_left, -sampled_abc_in_camera_left.y()*inverse_sampled_c_squared_left;
+        //ds jacobian parts of the homogeneous division: left
+        Matrix2_3 jacobian_left;
+        jacobian_left << inverse_sampled_c_left, 0, -sampled_abc_in_camera_left.x()*inverse_sampled_c_squared_left,
+                         0, inverse_sampled_c_left, -sampled_abc_in_camera_left.y()*inverse_sampled_c_squared_left;
 
-      //ds we compute only the contribution for the horizontal error: right
-      Matrix2_3 jacobian_right;
-      jacobian_right << inverse_sampled_c_right, 0, -sampled_abc_in_camera_right.x()*inverse_sampled_c_squared_right,
-                        0, inverse_sampled_c_right, -sampled_abc_in_camera_right.y()*inverse_sampled_c_squared_right;
+        //ds we compute only the contribution for the horizontal error: right
+        Matrix2_3 jacobian_right;
+        jacobian_right << inverse_sampled_c_right, 0, -sampled_abc_in_camera_right.x()*inverse_sampled_c_squared_right,
+                          0, inverse_sampled_c_right, -sampled_abc_in_camera_right.y()*inverse_sampled_c_squared_right;
 
-      //ds assemble final jacobian
-      _jacobian.setZero();
+        //ds assemble final jacobian (both blocks are fully overwritten)
+        Matrix4_6 jacobian;
 
-      //ds we have to compute the full block
-      _jacobian.block<2,6>(0,0) = jacobian_left*camera_matrix_per_jacobian_transform;
+        //ds we have to compute the full block
+        jacobian.block<2,6>(0,0) = jacobian_left*camera_matrix_per_jacobian_transform;
 
-      //ds we only have to compute the horizontal block
-      _jacobian.block<2,6>(2,0) = jacobian_right*camera_matrix_per_jacobian_transform;
+        //ds we only have to compute the horizontal block
+        jacobian.block<2,6>(2,0) = jacobian_right*camera_matrix_per_jacobian_transform;
 
-      //ds precompute transposed
-      const Matrix6_4 jacobian_transposed(_jacobian.transpose());
+        //ds precompute transposed times information, shared by H and b
+        const Matrix6_4 jacobian_transposed_omega(jacobian.transpose()*omega);
 
-      //ds update H and b
-      _H += jacobian_transposed*_omega*_jacobian;
-      _b += jacobian_transposed*_omega*error;
-    }
-    _number_of_outliers = _number_of_measurements-_number_of_inliers;
+        //ds update H and b of the chunk
+        chunk_.H.noalias() += jacobian_transposed_omega*jacobian;
+        chunk_.b.noalias() += jacobian_transposed_omega*error;
+      }
+    }, _H, _b);
   }
 
   //ds solve alignment problem for one round
@@ -76,98 +76,92 @@ namespace proslam {
   //ds linearize the system: to be called inside oneRound
   void UVDAligner::linearize(const bool& ignore_outliers_) {
 
-    //ds initialize setup
-    _H.setZero();
-    _b.setZero();
-    _number_of_inliers  = 0;
-    _number_of_outliers = 0;
-    _total_error        = 0;
-
-    //ds loop over all points (assumed to have previous points)
-    for (Index u = 0; u < _frame_current->points().size(); ++u) {
-      _errors[u]  = -1;
-      _inliers[u] = false;
-      _omega      = _information_matrix_vector[u];
-
-      //ds compute the point in the camera frame
-      const PointCoordinates predicted_point_in_camera = _previous_to_current*_moving[u];
-      const real depth_meters                          = predicted_point_in_camera.z();
-      if (depth_meters <= _minimum_reliable_depth_meters) {
-        continue;
-      }
+    //ds linearize all points (assumed to have previous points) in independent chunks
+    _linearizeInChunks([&](const Index& index_begin_, const Index& index_end_, LinearizationChunk& chunk_) {
+      for (Index u = index_begin_; u < index_end_; ++u) {
+        _errors[u]       = -1;
+        _inlier_flags[u] = false;
+        Matrix3 omega    = _information_matrix_vector[u];
+
+        //ds compute the point in the camera frame
+        const PointCoordinates predicted_point_in_camera = _previous_to_current*_moving[u];
+        const real depth_meters                          = predicted_point_in_camera.z();
+        if (depth_meters <= _minimum_reliable_depth_meters) {
+          continue;
+        }
 
-      //ds retrieve homogeneous projections
-      const PointCoordinates predicted_uvd_in_camera = _camera_calibration_matrix*predicted_point_in_camera;
+        //ds retrieve homogeneous projections
+        const PointCoordinates predicted_uvd_in_camera = _camera_calibration_matrix*predicted_point_in_camera;
       
-      //ds compute the image coordinates (homogeneous division)
-      PointCoordinates predicted_point_in_image  = predicted_uvd_in_camera/predicted_uvd_in_camera.z();
+        //ds compute the image coordinates (homogeneous division)
+        PointCoordinates predicted_point_in_image  = predicted_uvd_in_camera/predicted_uvd_in_camera.z();
 
-      //ds restore the depth in the third component as we will confront it with the measured depth from the sensor
-      predicted_point_in_image.z() = depth_meters;
+        //ds restore the depth in the third component as we will confront it with the measured depth from the sensor
+        predicted_point_in_image.z() = depth_meters;
       
-      //ds if the point is outside the image, skip
-      if (predicted_point_in_image.x() < 0 || predicted_point_in_image.x() > _number_of_cols_image||
-          predicted_point_in_image.y() < 0 || predicted_point_in_image.y() > _number_of_rows_image) {
-        continue;
-      }
+        //ds if the point is outside the image, skip
+        if (predicted_point_in_image.x() < 0 || predicted_point_in_image.x() > _number_of_cols_image||
+            predicted_point_in_image.y() < 0 || predicted_point_in_image.y() > _number_of_rows_image) {
+          continue;
+        }
 
-      //ds compute error (U V D)
-      const Vector3 error(predicted_point_in_image.x()-_fixed[u](0),
-                          predicted_point_in_image.y()-_fixed[u](1),
-                          predicted_point_in_image.z()-_fixed[u](2));
+        //ds compute error (U V D)
+        const Vector3 error(predicted_point_in_image.x()-_fixed[u](0),
+                            predicted_point_in_image.y()-_fixed[u](1),
+                            predicted_point_in_image.z()-_fixed[u](2));
 
-      //ds compute squared error
-      const real chi = error.transpose()*_omega*error;
+        //ds compute squared error
+        const real chi = error.transpose()*omega*error;
 
-      //ds update error stats
-      _errors[u] = chi;
+        //ds update error stats
+        _errors[u] = chi;
 
-      //ds check if outlier
-      if (chi > _parameters->maximum_error_kernel) {
-        if (ignore_outliers_) {
-          continue;
-        }
+        //ds check if outlier
+        if (chi > _parameters->maximum_error_kernel) {
+          if (ignore_outliers_) {
+            continue;
+          }
 
-        //ds proportionally reduce information value of the measurement
-        _omega *= _parameters->maximum_error_kernel/chi;
-      } else {
-        _inliers[u] = true;
-        ++_number_of_inliers;
-      }
+          //ds proportionally reduce information value of the measurement
+          omega *= _parameters->maximum_error_kernel/chi;
+        } else {
+          _inlier_flags[u] = true;
+          ++chunk_.number_of_inliers;
+        }
 
-      //ds update total error
-      _total_error += _errors[u];
+        //ds update total error
+        chunk_.total_error += _errors[u];
 
-      //ds precompute partial derivatives of homogeneous division
-      const real inverse_z         = 1/depth_meters;
-      const real inverse_z_squared = inverse_z*inverse_z;
+        //ds precompute partial derivatives of homogeneous division
+        const real inverse_z         = 1/depth_meters;
+        const real inverse_z_squared = inverse_z*inverse_z;
 
-      //ds compute the jacobian of the transformation
-      Matrix3_6 jacobian_transform;
+        //ds compute the jacobian of the transformation
+        Matrix3_6 jacobian_transform;
 
-      //ds translation contribution
-      jacobian_transform.block<3,3>(0,0) = _weights_translation[u]*Matrix3::Identity();
+        //ds translation contribution
+        jacobian_transform.block<3,3>(0,0) = _weights_translation[u]*Matrix3::Identity();
 
-      //ds always consider rotation
-      jacobian_transform.block<3,3>(0,3) = -2*skew(predicted_point_in_camera);
+        //ds always consider rotation
+        jacobian_transform.block<3,3>(0,3) = -2*skew(predicted_point_in_camera);
 
-      //ds jacobian parts of the homogeneous division (note that we have a 3x3 instead of a 2x3 matrix since we want to map the depth as well)
-      Matrix3 jacobian_projection;
-      jacobian_projection << inverse_z, 0, -predicted_uvd_in_camera.x()*inverse_z_squared,
-                             0, inverse_z, -predicted_uvd_in_camera.y()*inverse_z_squared,
-                             0, 0, 1;
+        //ds jacobian parts of the homogeneous division (note that we have a 3x3 instead of a 2x3 matrix since we want to map the depth as well)
+        Matrix3 jacobian_projection;
+        jacobian_projection << inverse_z, 0, -predicted_uvd_in_camera.x()*inverse_z_squared,
+                               0, inverse_z, -predicted_uvd_in_camera.y()*inverse_z_squared,
+                               0, 0, 1;
 
-      //ds assemble final jacobian
-      _jacobian = jacobian_projection*_camera_calibration_matrix*jacobian_transform;
+        //ds assemble final jacobian
+        const Matrix3_6 jacobian(jacobian_projection*_camera_calibration_matrix*jacobian_transform);
 
-      //ds precompute transposed
-      const Matrix6_3 jacobian_transposed(_jacobian.transpose());
+        //ds precompute transposed times information, shared by H and b
+        const Matrix6_3 jacobian_transposed_omega(jacobian.transpose()*omega);
 
-      //ds update H and b
-      _H += jacobian_transposed*_omega*_jacobian;
-      _b += jacobian_transposed*_omega*error;
-    }
-    _number_of_outliers = _number_of_measurements-_number_of_inliers;
+        //ds update H and b of the chunk
+        chunk_.H.noalias() += jacobian_transposed_omega*jacobian;
+        chunk_.b.noalias() += jacobian_transposed_omega*error;
+      }
+    }, _H, _b);
   }
 
   //ds solve alignment problem for one round
@@ -3,7 +3,9 @@
 namespace proslam {
 
   XYZAligner::XYZAligner(AlignerParameters* parameters_): BaseLocalMapAligner(parameters_) {
-    //ds nothing to do
+
+    //ds no damping for point cloud registration (set once, since the parameters may be shared among several aligners)
+    _parameters->damping = 0;
   }
 
   XYZAligner::~XYZAligner() {
@@ -15,7 +17,6 @@ namespace proslam {
     //ds initialize base components
     _context              = context_;
     _current_to_reference = current_to_reference_;
-    _parameters->damping = 0;
     _number_of_measurements = _context->correspondences.size();
     _errors.resize(_number_of_measurements);
     _inliers.resize(_number_of_measurements);
@@ -103,6 +104,54 @@ namespace proslam {
     _current_to_reference.linear()      -= 0.5*rotation*rotation_squared;
   }
 
+  const Count XYZAligner::sampleConsensus(const Count& number_of_iterations_, std::mt19937& random_number_generator_) {
+    if (_number_of_measurements < 3) {
+      return 0;
+    }
+    std::uniform_int_distribution<Index> sample_distribution(0, _number_of_measurements-1);
+    Count number_of_inliers_best = 0;
+    for (Count iteration = 0; iteration < number_of_iterations_; ++iteration) {
+
+      //ds draw 3 distinct correspondences
+      const Index index_0 = sample_distribution(random_number_generator_);
+      const Index index_1 = sample_distribution(random_number_generator_);
+      const Index index_2 = sample_distribution(random_number_generator_);
+      if (index_0 == index_1 || index_0 == index_2 || index_1 == index_2) {
+        continue;
+      }
+
+      //ds skip degenerate (collinear) samples
+      if ((_moving[index_1]-_moving[index_0]).cross(_moving[index_2]-_moving[index_0]).squaredNorm() < 1e-8) {
+        continue;
+      }
+
+      //ds compute the rigid transform for the minimal sample in closed form
+      Matrix3 moving_sample;
+      Matrix3 fixed_sample;
+      moving_sample << _moving[index_0], _moving[index_1], _moving[index_2];
+      fixed_sample << _fixed[index_0], _fixed[index_1], _fixed[index_2];
+      TransformMatrix3D current_to_reference(TransformMatrix3D::Identity());
+      current_to_reference.matrix() = Eigen::umeyama(moving_sample, fixed_sample, false);
+
+      //ds count inliers with the same error measure as used in linearize
+      Count number_of_inliers = 0;
+      for (Index u = 0; u < _number_of_measurements; ++u) {
+        const Vector3 error      = current_to_reference*_moving[u]-_fixed[u];
+        const real error_squared = error.transpose()*_information_matrix_vector[u]*error;
+        if (error_squared <= _parameters->maximum_error_kernel) {
+          ++number_of_inliers;
+        }
+      }
+
+      //ds keep the best hypothesis as initial guess
+      if (number_of_inliers > number_of_inliers_best) {
+        number_of_inliers_best = number_of_inliers;
+        _current_to_reference  = current_to_reference;
+      }
+    }
+    return number_of_inliers_best;
+  }
+
   void XYZAligner::converge() {
 
     //ds previous error to check for convergence
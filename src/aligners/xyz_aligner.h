@@ -1,4 +1,5 @@
 #pragma once
+#include <random>
 #include "base_local_map_aligner.h"
 
 namespace proslam {
@@ -24,6 +25,12 @@ public:
   //ds solve alignment problem until convergence is reached
   virtual void converge();
 
+  //! @brief 3-point RANSAC on the initialized correspondences, setting the current estimate to the hypothesis with the largest consensus
+  //! @param[in] number_of_iterations_ number of sampled hypotheses
+  //! @param[in,out] random_number_generator_ sampling source
+  //! @return number of inliers of the best hypothesis (0 if no hypothesis could be computed)
+  const Count sampleConsensus(const Count& number_of_iterations_, std::mt19937& random_number_generator_);
+
 //ds attributes
 protected:
 
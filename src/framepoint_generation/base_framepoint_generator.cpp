@@ -20,57 +20,33 @@ void  BaseFramePointGenerator::configure(){
   //ds initialize feature matcher
   _feature_matcher_left.configure(_number_of_rows_image, _number_of_cols_image);
 
+  //ds allocate descriptor extractor
+  _descriptor_extractor = _createDescriptorExtractor();
+
+  //ds the descriptor storage size is fixed at compile time - larger descriptors (e.g. BRISK-512, FREAK-512) require a rebuild
+  const uint32_t descriptor_size_bits = _descriptor_extractor->descriptorSize()*8;
+  if (descriptor_size_bits > SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS) {
+    throw std::runtime_error("BaseFramePointGenerator::configure|descriptor_type: " + _parameters->descriptor_type +
+                             " (" + std::to_string(descriptor_size_bits) + "b) exceeds the compiled descriptor storage size (" +
+                             std::to_string(SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS) + "b) - rebuild with -DSRRG_PROSLAM_DESCRIPTOR_SIZE_BITS=" +
+                             std::to_string(descriptor_size_bits));
+  }
+
+  //ds activate the descriptor size of the extractor for all descriptor comparisons
+  setDescriptorSizeBits(descriptor_size_bits);
+  _descriptor_distance_kernel = getDescriptorDistanceKernel();
+
+  //ds descriptor distances are configured for the storage size - adapt them to the active size (parameters remain untouched)
+  _minimum_descriptor_distance_tracking_scaled = getScaledDescriptorDistance(_parameters->minimum_descriptor_distance_tracking);
+  _maximum_descriptor_distance_tracking_scaled = getScaledDescriptorDistance(_parameters->maximum_descriptor_distance_tracking);
+
   //ds configure tracking window
   _projection_tracking_distance_pixels  = _parameters->maximum_projection_tracking_distance_pixels;
-  _maximum_descriptor_distance_tracking = _parameters->maximum_descriptor_distance_tracking;
-
-  //ds allocate descriptor extractor TODO enable further support and check BIT SIZES
-#if CV_MAJOR_VERSION == 2
-  if (_parameters->descriptor_type == "BRIEF-256") {
-    _descriptor_extractor = new cv::BriefDescriptorExtractor(DESCRIPTOR_SIZE_BYTES);
-  } else if (_parameters->descriptor_type == "ORB-256") {
-    _descriptor_extractor        = new cv::OrbDescriptorExtractor();
-    _parameters->descriptor_type = "ORB-256";
-  } else {
-    LOG_WARNING(std::cerr << "BaseFramePointGenerator::configure|descriptor_type: " << _parameters->descriptor_type
-                          << " is not implemented, defaulting to ORB-256" << std::endl)
-    _descriptor_extractor        = new cv::OrbDescriptorExtractor();
-    _parameters->descriptor_type = "ORB-256";
-  }
-#elif CV_MAJOR_VERSION == 3
-  if (_parameters->descriptor_type == "BRIEF-256") {
-    #ifdef SRRG_PROSLAM_HAS_OPENCV_CONTRIB
-      _descriptor_extractor = cv::xfeatures2d::BriefDescriptorExtractor::create(DESCRIPTOR_SIZE_BYTES);
-    #else
-      LOG_WARNING(std::cerr << "BaseFramePointGenerator::configure|descriptor_type: BRIEF-256"
-                            << " is not available in current build, defaulting to ORB-256" << std::endl)
-      _descriptor_extractor        = cv::ORB::create();
-      _parameters->descriptor_type = "ORB-256";
-    #endif
-  } else if (_parameters->descriptor_type == "ORB-256") {
-    _descriptor_extractor = cv::ORB::create();
-  } else if (_parameters->descriptor_type == "BRISK-512") {
-    _descriptor_extractor = cv::BRISK::create();
-  } else if (_parameters->descriptor_type == "FREAK-512") {
-    #ifdef SRRG_PROSLAM_HAS_OPENCV_CONTRIB
-        _descriptor_extractor = cv::xfeatures2d::FREAK::create();
-    #else
-        LOG_WARNING(std::cerr << "BaseFramePointGenerator::configure|descriptor_type: FREAK-512"
-                              << " is not available in current build, defaulting to ORB-256" << std::endl)
-        _descriptor_extractor        = cv::ORB::create();
-        _parameters->descriptor_type = "ORB-256";
-    #endif
-  } else {
-    LOG_WARNING(std::cerr << "BaseFramePointGenerator::configure|descriptor_type: " << _parameters->descriptor_type
-                          << " is not implemented, defaulting to ORB-256" << std::endl)
-    _descriptor_extractor        = cv::ORB::create();
-    _parameters->descriptor_type = "ORB-256";
-  }
-#endif
+  _maximum_descriptor_distance_tracking = _maximum_descriptor_distance_tracking_scaled;
 
   //ds log chosen descriptor type and size
   LOG_INFO(std::cerr << "BaseFramePointGenerator::configure|descriptor_type: " << _parameters->descriptor_type
-                     << " (memory: " << SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS << "b)" << std::endl)
+                     << " (size: " << getDescriptorSizeBits() << "b, memory: " << SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS << "b)" << std::endl)
 
   //ds allocate and initialize detector grid structure
   _detectors           = new cv::Ptr<cv::FastFeatureDetector>*[_parameters->number_of_detectors_vertical];
@@ -130,6 +106,12 @@ void  BaseFramePointGenerator::configure(){
   _number_of_detectors = _parameters->number_of_detectors_vertical*_parameters->number_of_detectors_horizontal;
   _mean_detector_threshold = _parameters->detector_threshold_minimum;
 
+  //ds allocate thread pool for parallel detection (the calling thread is part of the pool)
+  if (_parameters->number_of_detection_threads > 1) {
+    _thread_pool = std::make_shared<ThreadPool>(std::min(_parameters->number_of_detection_threads, _number_of_detectors));
+    LOG_INFO(std::cerr << "BaseFramePointGenerator::configure|parallel keypoint detection threads: " << _thread_pool->numberOfThreads() << std::endl)
+  }
+
   //ds compute binning configuration
   _number_of_cols_bin = std::floor(static_cast<real>(_camera_left->numberOfImageCols())/_parameters->bin_size_pixels)+1;
   _number_of_rows_bin = std::floor(static_cast<real>(_camera_left->numberOfImageRows())/_parameters->bin_size_pixels)+1;
@@ -181,81 +163,244 @@ BaseFramePointGenerator::~BaseFramePointGenerator() {
   LOG_INFO(std::cerr << "BaseFramePointGenerator::~BaseFramePointGenerator|destroyed" << std::endl)
 }
 
+cv::Ptr<cv::DescriptorExtractor> BaseFramePointGenerator::_createDescriptorExtractor() {
+  cv::Ptr<cv::DescriptorExtractor> descriptor_extractor;
+
+  //ds TODO enable further support and check BIT SIZES
+#if CV_MAJOR_VERSION == 2
+  if (_parameters->descriptor_type == "BRIEF-128" || _parameters->descriptor_type == "BRIEF-256" || _parameters->descriptor_type == "BRIEF-512") {
+    descriptor_extractor = new cv::BriefDescriptorExtractor(std::stoi(_parameters->descriptor_type.substr(6))/8);
+  } else if (_parameters->descriptor_type == "ORB-256") {
+    descriptor_extractor         = new cv::OrbDescriptorExtractor();
+    _parameters->descriptor_type = "ORB-256";
+  } else {
+    LOG_WARNING(std::cerr << "BaseFramePointGenerator::_createDescriptorExtractor|descriptor_type: " << _parameters->descriptor_type
+                          << " is not implemented, defaulting to ORB-256" << std::endl)
+    descriptor_extractor         = new cv::OrbDescriptorExtractor();
+    _parameters->descriptor_type = "ORB-256";
+  }
+#elif CV_MAJOR_VERSION == 3
+  if (_parameters->descriptor_type == "BRIEF-128" || _parameters->descriptor_type == "BRIEF-256" || _parameters->descriptor_type == "BRIEF-512") {
+    #ifdef SRRG_PROSLAM_HAS_OPENCV_CONTRIB
+      descriptor_extractor = cv::xfeatures2d::BriefDescriptorExtractor::create(std::stoi(_parameters->descriptor_type.substr(6))/8);
+    #else
+      LOG_WARNING(std::cerr << "BaseFramePointGenerator::_createDescriptorExtractor|descriptor_type: " << _parameters->descriptor_type
+                            << " is not available in current build, defaulting to ORB-256" << std::endl)
+      descriptor_extractor         = cv::ORB::create();
+      _parameters->descriptor_type = "ORB-256";
+    #endif
+  } else if (_parameters->descriptor_type == "ORB-256") {
+    descriptor_extractor = cv::ORB::create();
+  } else if (_parameters->descriptor_type == "BRISK-512") {
+    descriptor_extractor = cv::BRISK::create();
+  } else if (_parameters->descriptor_type == "FREAK-512") {
+    #ifdef SRRG_PROSLAM_HAS_OPENCV_CONTRIB
+        descriptor_extractor = cv::xfeatures2d::FREAK::create();
+    #else
+        LOG_WARNING(std::cerr << "BaseFramePointGenerator::_createDescriptorExtractor|descriptor_type: FREAK-512"
+                              << " is not available in current build, defaulting to ORB-256" << std::endl)
+        descriptor_extractor         = cv::ORB::create();
+        _parameters->descriptor_type = "ORB-256";
+    #endif
+  } else {
+    LOG_WARNING(std::cerr << "BaseFramePointGenerator::_createDescriptorExtractor|descriptor_type: " << _parameters->descriptor_type
+                          << " is not implemented, defaulting to ORB-256" << std::endl)
+    descriptor_extractor         = cv::ORB::create();
+    _parameters->descriptor_type = "ORB-256";
+  }
+#endif
+  return descriptor_extractor;
+}
+
 void BaseFramePointGenerator::detectKeypoints(const cv::Mat& intensity_image_,
                                               std::vector<cv::KeyPoint>& keypoints_,
                                               const bool ignore_minimum_detector_threshold_) {
   CHRONOMETER_START(keypoint_detection)
+  _detectKeypoints(intensity_image_, keypoints_, ignore_minimum_detector_threshold_);
+  CHRONOMETER_STOP(keypoint_detection)
+}
 
-  //ds detect new keypoints in each image region
-  for (uint32_t r = 0; r < _parameters->number_of_detectors_vertical; ++r) {
-    for (uint32_t c = 0; c < _parameters->number_of_detectors_horizontal; ++c) {
+void BaseFramePointGenerator::_detectKeypoints(const cv::Mat& intensity_image_,
+                                               std::vector<cv::KeyPoint>& keypoints_,
+                                               const bool ignore_minimum_detector_threshold_) {
+  const uint32_t& number_of_detectors_horizontal = _parameters->number_of_detectors_horizontal;
+
+  //ds per region buffers - each region is processed independently (possibly in parallel)
+  std::vector<std::vector<cv::KeyPoint>> keypoints_per_detector(_number_of_detectors);
+  std::vector<real> detector_thresholds(_number_of_detectors, 0);
+
+  //ds single pass over the full image
+  if (_parameters->enable_single_pass_detection) {
+    _detectKeypointsSinglePass(intensity_image_, keypoints_per_detector, detector_thresholds);
+  } else {
+
+    //ds detect new keypoints in an image region
+    const std::function<void(const Index&)> detect = [&](const Index& index_) {
+      const uint32_t r = index_/number_of_detectors_horizontal;
+      const uint32_t c = index_%number_of_detectors_horizontal;
 
       //ds detect keypoints in current region
-      std::vector<cv::KeyPoint> keypoints_per_detector(0);
-      _detectors[r][c]->detect(intensity_image_(_detector_regions[r][c]), keypoints_per_detector);
+      //ds the threshold of a detector is only changed in adjustDetectorThresholds (never concurrent to detection)
+      std::vector<cv::KeyPoint>& keypoints(keypoints_per_detector[index_]);
+      _detectors[r][c]->detect(intensity_image_(_detector_regions[r][c]), keypoints);
 
-      //ds retrieve currently set threshold for this detector
-#if CV_MAJOR_VERSION == 2
-      real detector_threshold = _detectors[r][c]->getInt("threshold");
-#else
-      real detector_threshold = _detectors[r][c]->getThreshold();
-#endif
+      //ds compute adjusted threshold for this detector
+      detector_thresholds[index_] = _getAdjustedDetectorThreshold(_getDetectorThreshold(r, c), keypoints.size());
 
-      //ds compute point delta: 100% loss > -1, 100% gain > +1
-      const real delta = (static_cast<real>(keypoints_per_detector.size())-_target_number_of_keypoints_per_detector)/_target_number_of_keypoints_per_detector;
+      //ds shift keypoint coordinates to whole image region
+      const cv::Point2f& offset = _detector_regions[r][c].tl();
+      std::for_each(keypoints.begin(), keypoints.end(), [&offset](cv::KeyPoint& keypoint_) {keypoint_.pt += offset;});
+    };
+
+    //ds process all regions
+    if (_thread_pool) {
+      _thread_pool->execute(_number_of_detectors, detect);
+    } else {
+      for (Index index = 0; index < _number_of_detectors; ++index) {
+        detect(index);
+      }
+    }
+  }
 
-      //ds check if there's a significant loss of target points (delta is negative)
-      if (delta < -_parameters->target_number_of_keypoints_tolerance) {
+  //ds merge region results in fixed (row major) order to obtain a deterministic keypoint vector
+  Count number_of_keypoints = keypoints_.size();
+  for (const std::vector<cv::KeyPoint>& keypoints: keypoints_per_detector) {
+    number_of_keypoints += keypoints.size();
+  }
+  keypoints_.reserve(number_of_keypoints);
+  for (const std::vector<cv::KeyPoint>& keypoints: keypoints_per_detector) {
+    keypoints_.insert(keypoints_.end(), keypoints.begin(), keypoints.end());
+  }
 
-        //ds compute new, lower threshold, capped (negative value)
-        const real change = std::max(delta, -_parameters->detector_threshold_maximum_change);
+  //ds set treshold variables (will be effectively changed by calling adjustDetectorThresholds)
+  std::lock_guard<std::mutex> lock(_mutex_detection);
+  for (Index index = 0; index < _number_of_detectors; ++index) {
+    _detector_thresholds[index/number_of_detectors_horizontal][index%number_of_detectors_horizontal] += detector_thresholds[index];
+  }
+  ++_number_of_detections;
+  _number_of_detected_keypoints = keypoints_.size();
+}
 
-        //ds always lower threshold by at least 1
-        detector_threshold = detector_threshold+std::min(change*detector_threshold, -1.0);
+void BaseFramePointGenerator::_detectKeypointsSinglePass(const cv::Mat& intensity_image_,
+                                                         std::vector<std::vector<cv::KeyPoint>>& keypoints_per_detector_,
+                                                         std::vector<real>& detector_thresholds_) const {
+  const uint32_t& number_of_detectors_vertical   = _parameters->number_of_detectors_vertical;
+  const uint32_t& number_of_detectors_horizontal = _parameters->number_of_detectors_horizontal;
+
+  //ds the full image is scored with the lowest threshold of all regions
+  std::vector<int32_t> thresholds(_number_of_detectors);
+  int32_t threshold_minimum = _parameters->detector_threshold_maximum;
+  for (Index index = 0; index < _number_of_detectors; ++index) {
+    thresholds[index] = std::rint(_getDetectorThreshold(index/number_of_detectors_horizontal, index%number_of_detectors_horizontal));
+    threshold_minimum = std::min(threshold_minimum, thresholds[index]);
+  }
+  std::vector<cv::KeyPoint> keypoints;
+  cv::FAST(intensity_image_, keypoints, threshold_minimum, true);
+
+  //ds assign corners to regions (without region overlap) and build per region score histograms
+  const real pixel_rows_per_detector = static_cast<real>(_number_of_rows_image)/number_of_detectors_vertical;
+  const real pixel_cols_per_detector = static_cast<real>(_number_of_cols_image)/number_of_detectors_horizontal;
+  constexpr Count number_of_scores   = 256;
+  std::vector<Index> detector_indices(keypoints.size());
+  std::vector<Count> score_histograms(_number_of_detectors*number_of_scores, 0);
+  for (Index index = 0; index < keypoints.size(); ++index) {
+    const uint32_t r = std::min(static_cast<uint32_t>(keypoints[index].pt.y/pixel_rows_per_detector), number_of_detectors_vertical-1);
+    const uint32_t c = std::min(static_cast<uint32_t>(keypoints[index].pt.x/pixel_cols_per_detector), number_of_detectors_horizontal-1);
+    detector_indices[index] = r*number_of_detectors_horizontal+c;
+    const Index score = std::min(std::max(static_cast<int32_t>(keypoints[index].response), 0), static_cast<int32_t>(number_of_scores-1));
+    ++score_histograms[detector_indices[index]*number_of_scores+score];
+  }
 
-        //ds check minimum threshold
-        if (detector_threshold < _parameters->detector_threshold_minimum) {
-          detector_threshold = _parameters->detector_threshold_minimum;
-        }
+  //ds per region score cutoff: the strongest corners up to the tolerated target number (top-K), at least the region threshold
+  //ds corners sharing the cutoff score are all kept, hence a region may exceed the target by the corners of that score
+  const Count maximum_number_of_keypoints_per_detector = std::ceil((1+_parameters->target_number_of_keypoints_tolerance)*_target_number_of_keypoints_per_detector);
+  std::vector<int32_t> score_cutoffs(_number_of_detectors);
+  for (Index index = 0; index < _number_of_detectors; ++index) {
+    const Count* score_histogram       = &score_histograms[index*number_of_scores];
+    Count number_of_keypoints          = 0;
+    Count number_of_selected_keypoints = 0;
+    score_cutoffs[index] = number_of_scores;
+    for (int32_t score = number_of_scores-1; score >= thresholds[index]; --score) {
+      number_of_keypoints += score_histogram[score];
+      if (number_of_selected_keypoints < maximum_number_of_keypoints_per_detector) {
+        number_of_selected_keypoints = number_of_keypoints;
+        score_cutoffs[index]         = score;
       }
+    }
+    keypoints_per_detector_[index].reserve(number_of_selected_keypoints);
 
-      //ds or if there's a significant gain of target points (delta is positive)
-      else if (delta > _parameters->target_number_of_keypoints_tolerance) {
+    //ds the threshold adapts to the number of corners a region detector would have reported with its own threshold
+    detector_thresholds_[index] = _getAdjustedDetectorThreshold(thresholds[index], number_of_keypoints);
+  }
 
-        //ds compute new, higher threshold, capped (positive value)
-        const real change = std::min(delta, _parameters->detector_threshold_maximum_change);
+  //ds select corners above the region cutoff (image order within each region)
+  for (Index index = 0; index < keypoints.size(); ++index) {
+    const Index& index_detector = detector_indices[index];
+    if (keypoints[index].response >= score_cutoffs[index_detector]) {
+      keypoints_per_detector_[index_detector].push_back(keypoints[index]);
+    }
+  }
+}
 
-        //ds always increase threshold by at least 1
-        detector_threshold += std::max(change*detector_threshold, 1.0);
+const real BaseFramePointGenerator::_getAdjustedDetectorThreshold(const real& detector_threshold_, const Count& number_of_keypoints_) const {
+  real detector_threshold = detector_threshold_;
 
-        //ds check maximum threshold
-        if (detector_threshold > _parameters->detector_threshold_maximum) {
-          detector_threshold = _parameters->detector_threshold_maximum;
-        }
-      }
+  //ds compute point delta: 100% loss > -1, 100% gain > +1
+  const real delta = (static_cast<real>(number_of_keypoints_)-_target_number_of_keypoints_per_detector)/_target_number_of_keypoints_per_detector;
 
-      //ds set treshold variable (will be effectively changed by calling adjustDetectorThresholds)
-      _detector_thresholds[r][c] += detector_threshold;
+  //ds check if there's a significant loss of target points (delta is negative)
+  if (delta < -_parameters->target_number_of_keypoints_tolerance) {
 
-      //ds shift keypoint coordinates to whole image region
-      const cv::Point2f& offset = _detector_regions[r][c].tl();
-      std::for_each(keypoints_per_detector.begin(), keypoints_per_detector.end(), [&offset](cv::KeyPoint& keypoint_) {keypoint_.pt += offset;});
+    //ds compute new, lower threshold, capped (negative value)
+    const real change = std::max(delta, -_parameters->detector_threshold_maximum_change);
 
-      //ds add to complete vector
-      keypoints_.insert(keypoints_.end(), keypoints_per_detector.begin(), keypoints_per_detector.end());
+    //ds always lower threshold by at least 1
+    detector_threshold = detector_threshold+std::min(change*detector_threshold, -1.0);
+
+    //ds check minimum threshold
+    if (detector_threshold < _parameters->detector_threshold_minimum) {
+      detector_threshold = _parameters->detector_threshold_minimum;
     }
   }
-  ++_number_of_detections;
-  _number_of_detected_keypoints = keypoints_.size();
-  CHRONOMETER_STOP(keypoint_detection)
+
+  //ds or if there's a significant gain of target points (delta is positive)
+  else if (delta > _parameters->target_number_of_keypoints_tolerance) {
+
+    //ds compute new, higher threshold, capped (positive value)
+    const real change = std::min(delta, _parameters->detector_threshold_maximum_change);
+
+    //ds always increase threshold by at least 1
+    detector_threshold += std::max(change*detector_threshold, 1.0);
+
+    //ds check maximum threshold
+    if (detector_threshold > _parameters->detector_threshold_maximum) {
+      detector_threshold = _parameters->detector_threshold_maximum;
+    }
+  }
+  return detector_threshold;
+}
+
+const real BaseFramePointGenerator::_getDetectorThreshold(const uint32_t& r_, const uint32_t& c_) const {
+#if CV_MAJOR_VERSION == 2
+  return _detectors[r_][c_]->getInt("threshold");
+#else
+  return _detectors[r_][c_]->getThreshold();
+#endif
 }
 
 void BaseFramePointGenerator::computeDescriptors(const cv::Mat& intensity_image_, std::vector<cv::KeyPoint>& keypoints_, cv::Mat& descriptors_) {
   CHRONOMETER_START(descriptor_extraction)
-  _descriptor_extractor->compute(intensity_image_, keypoints_, descriptors_);
+  _computeDescriptors(_descriptor_extractor, intensity_image_, keypoints_, descriptors_);
   CHRONOMETER_STOP(descriptor_extraction)
 }
 
+void BaseFramePointGenerator::_computeDescriptors(cv::Ptr<cv::DescriptorExtractor> descriptor_extractor_,
+                                                  const cv::Mat& intensity_image_,
+                                                  std::vector<cv::KeyPoint>& keypoints_,
+                                                  cv::Mat& descriptors_) {
+  descriptor_extractor_->compute(intensity_image_, keypoints_, descriptors_);
+}
+
 void BaseFramePointGenerator::adjustDetectorThresholds() {
   _mean_detector_threshold = 0;
   for (uint32_t r = 0; r < _parameters->number_of_detectors_vertical; ++r) {
@@ -279,6 +424,135 @@ void BaseFramePointGenerator::adjustDetectorThresholds() {
   _mean_detector_threshold /= _number_of_detectors;
 }
 
+const std::vector<cv::Mat>& BaseFramePointGenerator::_getImagePyramidLeft(Frame* frame_) const {
+  if (frame_->imagePyramidLeft().size() != _parameters->number_of_pyramid_levels) {
+
+    //ds the full resolution level shares the image memory
+    std::vector<cv::Mat> image_pyramid(_parameters->number_of_pyramid_levels);
+    image_pyramid[0] = frame_->intensityImageLeft();
+    for (Index level = 1; level < image_pyramid.size(); ++level) {
+      cv::pyrDown(image_pyramid[level-1], image_pyramid[level]);
+    }
+    frame_->setImagePyramidLeft(image_pyramid);
+  }
+  return frame_->imagePyramidLeft();
+}
+
+const bool BaseFramePointGenerator::_estimateProjectionOffsetCoarse(Frame* frame_,
+                                                                    Frame* frame_previous_,
+                                                                    const TransformMatrix3D& camera_left_previous_in_current_,
+                                                                    cv::Point2f& projection_offset_) {
+  projection_offset_ = cv::Point2f(0, 0);
+  if (_parameters->number_of_pyramid_levels < 2 || frame_->intensityImageLeft().empty() || frame_previous_->intensityImageLeft().empty()) {
+    return false;
+  }
+  CHRONOMETER_START(coarse_tracking)
+
+  //ds patch correlation settings at the coarse level
+  const int32_t& patch_radius_pixels = _parameters->coarse_tracking_patch_radius_pixels;
+
+  //ds coarsest level images
+  const Index level             = _parameters->number_of_pyramid_levels-1;
+  const float scale             = 1 << level;
+  const cv::Mat& image          = _getImagePyramidLeft(frame_)[level];
+  const cv::Mat& image_previous = _getImagePyramidLeft(frame_previous_)[level];
+  const cv::Rect image_region(0, 0, image.cols, image.rows);
+  const int32_t search_radius_pixels = std::ceil(_projection_tracking_distance_pixels/scale);
+
+  //ds select the points to locate - landmarks are preferred
+  FramePointPointerVector points_to_locate;
+  points_to_locate.reserve(frame_previous_->points().size());
+  for (FramePoint* point_previous: frame_previous_->points()) {
+    if (point_previous->landmark()) {
+      points_to_locate.push_back(point_previous);
+    }
+  }
+  if (points_to_locate.size() < _parameters->number_of_coarse_tracking_points) {
+    for (FramePoint* point_previous: frame_previous_->points()) {
+      if (!point_previous->landmark()) {
+        points_to_locate.push_back(point_previous);
+      }
+    }
+  }
+  const Count stride = std::max(points_to_locate.size()/std::max(_parameters->number_of_coarse_tracking_points, Count(1)), size_t(1));
+
+  //ds locate the points around their predicted projections
+  std::vector<float> offsets_col;
+  std::vector<float> offsets_row;
+  cv::Mat correlations;
+  for (Index index = 0; index < points_to_locate.size(); index += stride) {
+    const FramePoint* point_previous = points_to_locate[index];
+
+    //ds predict the projection in the current coarse image
+    const PointCoordinates point_in_camera_left(camera_left_previous_in_current_*point_previous->cameraCoordinatesLeft());
+    if (point_in_camera_left.z() <= 0) {
+      continue;
+    }
+    const PointCoordinates point_in_image_left(_camera_left->cameraMatrix()*point_in_camera_left);
+    const float col_projection = point_in_image_left.x()/point_in_image_left.z()/scale;
+    const float row_projection = point_in_image_left.y()/point_in_image_left.z()/scale;
+
+    //ds patch around the point in the previous coarse image
+    const cv::Rect patch(std::round(point_previous->keypointLeft().pt.x/scale)-patch_radius_pixels,
+                         std::round(point_previous->keypointLeft().pt.y/scale)-patch_radius_pixels,
+                         2*patch_radius_pixels+1,
+                         2*patch_radius_pixels+1);
+    if ((patch & image_region) != patch) {
+      continue;
+    }
+
+    //ds search region around the prediction (clipped to the image)
+    const int32_t search_half_size = search_radius_pixels+patch_radius_pixels;
+    const cv::Rect search_region = cv::Rect(std::round(col_projection)-search_half_size,
+                                            std::round(row_projection)-search_half_size,
+                                            2*search_half_size+1,
+                                            2*search_half_size+1) & image_region;
+    if (search_region.width < patch.width || search_region.height < patch.height) {
+      continue;
+    }
+
+    //ds locate the patch
+    cv::matchTemplate(image(search_region), image_previous(patch), correlations, cv::TM_CCOEFF_NORMED);
+    double correlation_best = 0;
+    cv::Point location_best;
+    cv::minMaxLoc(correlations, 0, &correlation_best, 0, &location_best);
+    if (correlation_best < _parameters->minimum_coarse_tracking_correlation) {
+      continue;
+    }
+    offsets_col.push_back((search_region.x+location_best.x+patch_radius_pixels-col_projection)*scale);
+    offsets_row.push_back((search_region.y+location_best.y+patch_radius_pixels-row_projection)*scale);
+  }
+  if (offsets_col.size() < _parameters->minimum_number_of_coarse_tracks) {
+    CHRONOMETER_STOP(coarse_tracking)
+    return false;
+  }
+
+  //ds robust offset estimate: median per dimension
+  std::vector<float> offsets_col_sorted(offsets_col);
+  std::vector<float> offsets_row_sorted(offsets_row);
+  std::nth_element(offsets_col_sorted.begin(), offsets_col_sorted.begin()+offsets_col_sorted.size()/2, offsets_col_sorted.end());
+  std::nth_element(offsets_row_sorted.begin(), offsets_row_sorted.begin()+offsets_row_sorted.size()/2, offsets_row_sorted.end());
+  const cv::Point2f projection_offset(offsets_col_sorted[offsets_col_sorted.size()/2], offsets_row_sorted[offsets_row_sorted.size()/2]);
+
+  //ds require the majority of the located points to agree with the offset (within two coarse pixels)
+  Count number_of_inliers = 0;
+  for (Index index = 0; index < offsets_col.size(); ++index) {
+    if (std::fabs(offsets_col[index]-projection_offset.x) <= 2*scale && std::fabs(offsets_row[index]-projection_offset.y) <= 2*scale) {
+      ++number_of_inliers;
+    }
+  }
+  CHRONOMETER_STOP(coarse_tracking)
+  if (2*number_of_inliers < offsets_col.size()) {
+    LOG_DEBUG(std::cerr << "BaseFramePointGenerator::_estimateProjectionOffsetCoarse|inconsistent offsets, inliers: "
+                        << number_of_inliers << "/" << offsets_col.size() << std::endl)
+    return false;
+  }
+  projection_offset_ = projection_offset;
+  LOG_DEBUG(std::cerr << "BaseFramePointGenerator::_estimateProjectionOffsetCoarse|projection offset: " << projection_offset_
+                      << " inliers: " << number_of_inliers << "/" << offsets_col.size() << std::endl)
+  return true;
+}
+
 const PointCoordinates BaseFramePointGenerator::getPointInCamera(const cv::Point2f& image_point_previous_,
                                                                  const cv::Point2f& image_point_current_,
                                                                  const TransformMatrix3D& camera_previous_to_current_,
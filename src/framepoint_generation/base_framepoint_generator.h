@@ -1,5 +1,7 @@
 #pragma once
+#include <mutex>
 #include "types/frame.h"
+#include "types/thread_pool.h"
 #include "intensity_feature_matcher.h"
 
 
@@ -22,6 +24,8 @@ public:
   virtual void compute(Frame* frame_) = 0;
 
   //ds detects keypoints and stores them in a vector (called within initialize)
+  //ds detector regions are processed in parallel if configured (number_of_detection_threads), the result is independent of the number of threads
+  //ds with enable_single_pass_detection the full image is scored once and the regions only select their strongest keypoints
   void detectKeypoints(const cv::Mat& intensity_image_,
                        std::vector<cv::KeyPoint>& keypoints_,
                        const bool ignore_minimum_detector_threshold_ = false);
@@ -40,9 +44,63 @@ public:
   //! @brief adjust detector thresholds (for all image streams)
   void adjustDetectorThresholds();
 
+//ds helpers
+protected:
+
+  //! @brief allocates a descriptor extractor according to the configured descriptor type
+  cv::Ptr<cv::DescriptorExtractor> _createDescriptorExtractor();
+
+  //! @brief detectKeypoints without timing, may be called concurrently for different images (e.g. left and right)
+  //! @brief the caller is responsible for timing the (parallel) section once
+  void _detectKeypoints(const cv::Mat& intensity_image_,
+                        std::vector<cv::KeyPoint>& keypoints_,
+                        const bool ignore_minimum_detector_threshold_);
+
+  //! @brief single pass detection: computes FAST corners over the full image at the lowest region threshold
+  //! @brief and keeps per region the strongest corners above the region threshold, up to the tolerated target number
+  //! @brief (score cutoff determined from a per region score histogram)
+  //! @param[in] intensity_image_ image to detect keypoints in
+  //! @param[out] keypoints_per_detector_ selected keypoints for each detector region (row major)
+  //! @param[out] detector_thresholds_ adjusted threshold for each detector region (row major)
+  void _detectKeypointsSinglePass(const cv::Mat& intensity_image_,
+                                  std::vector<std::vector<cv::KeyPoint>>& keypoints_per_detector_,
+                                  std::vector<real>& detector_thresholds_) const;
+
+  //! @brief adaptive threshold logic: returns the detector threshold adjusted towards the target number of keypoints per detector region
+  //! @param[in] detector_threshold_ currently set threshold of the region
+  //! @param[in] number_of_keypoints_ number of keypoints detected with the current threshold in the region
+  const real _getAdjustedDetectorThreshold(const real& detector_threshold_, const Count& number_of_keypoints_) const;
+
+  //! @brief retrieves the currently set threshold of a detector
+  const real _getDetectorThreshold(const uint32_t& r_, const uint32_t& c_) const;
+
+  //! @brief returns the left image pyramid of a frame (number_of_pyramid_levels), building and storing it in the frame if not available
+  const std::vector<cv::Mat>& _getImagePyramidLeft(Frame* frame_) const;
+
+  //! @brief coarse-to-fine tracking: estimates the offset between predicted and observed point projections at the coarsest pyramid level
+  //! @brief a subset of the previous points (landmarks first) is located by patch correlation within the current tracking distance
+  //! @param[in] frame_ current frame
+  //! @param[in] frame_previous_ previous frame carrying the points to locate
+  //! @param[in] camera_left_previous_in_current_ the relative camera motion guess between frame_ and frame_previous_
+  //! @param[out] projection_offset_ offset to add to predicted projections (full resolution pixels)
+  //! @return true if a consistent offset was found, i.e. tracking can be performed with tight search windows
+  const bool _estimateProjectionOffsetCoarse(Frame* frame_,
+                                             Frame* frame_previous_,
+                                             const TransformMatrix3D& camera_left_previous_in_current_,
+                                             cv::Point2f& projection_offset_);
+
+  //! @brief extracts descriptors using the provided extractor without timing (an extractor must not be used by two threads at once)
+  void _computeDescriptors(cv::Ptr<cv::DescriptorExtractor> descriptor_extractor_,
+                           const cv::Mat& intensity_image_,
+                           std::vector<cv::KeyPoint>& keypoints_,
+                           cv::Mat& descriptors_);
+
+//ds functionality
+public:
+
   //! @brief attempts to recover framepoints in the current image using the more precise pose estimate, retrieved after pose optimization
   //! @brief param[in] current_frame_ the affected frame carrying points to be recovered
-  virtual void recoverPoints(Frame* current_frame_, const FramePointPointerVector& lost_points_) const = 0;
+  virtual void recoverPoints(Frame* current_frame_, const FramePointPointerVector& lost_points_) = 0;
 
   //! @brief brutal midpoint triangulation to obtain a 3D point in the current camera frame
   const PointCoordinates getPointInCamera(const cv::Point2f& image_point_previous_,
@@ -64,7 +122,11 @@ public:
   void setProjectionTrackingDistancePixels(const int32_t& projection_tracking_distance_pixels_) {_projection_tracking_distance_pixels = projection_tracking_distance_pixels_;}
   void setMaximumDescriptorDistanceTracking(const real& maximum_descriptor_distance_tracking_) {_maximum_descriptor_distance_tracking = maximum_descriptor_distance_tracking_;}
 
-  const int32_t matchingDistanceTrackingThreshold() const {return _parameters->minimum_descriptor_distance_tracking;}
+  const int32_t matchingDistanceTrackingThreshold() const {return _minimum_descriptor_distance_tracking_scaled;}
+
+  //! @brief bounds of the dynamic tracking descriptor distance, scaled to the active descriptor size in configure
+  const real& minimumDescriptorDistanceTracking() const {return _minimum_descriptor_distance_tracking_scaled;}
+  const real& maximumDescriptorDistanceTracking() const {return _maximum_descriptor_distance_tracking_scaled;}
   const Count& numberOfDetectedKeypoints() const {return _number_of_detected_keypoints;}
   const Count& numberOfTrackedLandmarks() const {return _number_of_tracked_landmarks;}
   const real meanDetectorThreshold() const {return _mean_detector_threshold;}
@@ -104,6 +166,12 @@ protected:
   //! @brief number of detections since last adjustDetectorThresholds() call
   Count _number_of_detections = 0;
 
+  //! @brief thread pool for parallel detection over the detector regions (only allocated for number_of_detection_threads > 1)
+  ThreadPoolPtr _thread_pool = nullptr;
+
+  //! @brief protects detector threshold bookkeeping for concurrent _detectKeypoints calls
+  std::mutex _mutex_detection;
+
   //ds descriptor extraction
   cv::Ptr<cv::DescriptorExtractor> _descriptor_extractor;
 
@@ -122,6 +190,13 @@ protected:
   //! @brief current maximum descriptor distance for tracking
   real _maximum_descriptor_distance_tracking   = 0;
 
+  //! @brief tracking descriptor distance bounds of the parameters, scaled to the active descriptor size
+  real _minimum_descriptor_distance_tracking_scaled = 0;
+  real _maximum_descriptor_distance_tracking_scaled = 0;
+
+  //! @brief Hamming distance kernel of the active descriptor size (chosen once in configure)
+  DescriptorDistanceKernel _descriptor_distance_kernel = nullptr;
+
   //! @brief status
   Count _number_of_tracked_landmarks = 0;
 
@@ -130,6 +205,7 @@ private:
   //ds informative only
   CREATE_CHRONOMETER(keypoint_detection)
   CREATE_CHRONOMETER(descriptor_extraction)
+  CREATE_CHRONOMETER(coarse_tracking)
 };
 
 typedef std::shared_ptr<BaseFramePointGenerator> BaseFramePointGeneratorPtr;
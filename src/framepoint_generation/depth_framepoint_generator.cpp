@@ -1,8 +1,17 @@
 #include "depth_framepoint_generator.h"
+
+#include <cstring>
+#include <limits>
 #include "types/landmark.h"
 
 namespace proslam {
 
+//ds number of image rows processed per depth map task
+const Count number_of_rows_per_task = 16;
+
+//ds z-buffer entry for pixels without reprojected depth
+const uint64_t depth_buffer_empty = std::numeric_limits<uint64_t>::max();
+
 DepthFramePointGenerator::DepthFramePointGenerator(DepthFramePointGeneratorParameters* parameters_): BaseFramePointGenerator(parameters_),
                                                                                                      _parameters(parameters_) {
   LOG_INFO(std::cerr << "DepthFramePointGenerator::DepthFramePointGenerator|constructed" << std::endl)
@@ -13,6 +22,56 @@ void DepthFramePointGenerator::configure(){
   LOG_INFO(std::cerr << "DepthFramePointGenerator::configure|configuring" << std::endl)
   assert(_camera_right);
   BaseFramePointGenerator::configure();
+
+  //ds depth camera to left camera registration
+  _right_to_left_transform     = _camera_left->robotToCamera()*_camera_right->cameraToRobot();
+  _left_to_right_transform     = _right_to_left_transform.inverse();
+  _inverse_camera_matrix_left  = _camera_left->cameraMatrix().inverse();
+  _inverse_camera_matrix_right = _camera_right->cameraMatrix().inverse();
+
+  //ds check if the depth image is registered to the left image (no reprojection required)
+  _is_depth_registered = (_right_to_left_transform.matrix()-TransformMatrix3D::Identity().matrix()).norm() < 1e-6 &&
+                         (_camera_right->cameraMatrix()-_camera_left->cameraMatrix()).norm() < 1e-6;
+  if (_is_depth_registered) {
+    LOG_INFO(std::cerr << "DepthFramePointGenerator::configure|depth image is registered, skipping depth map computation" << std::endl)
+  } else if (_parameters->enable_sparse_depth_lookup) {
+    LOG_INFO(std::cerr << "DepthFramePointGenerator::configure|sparse depth lookup, search radius (pixels): " << _parameters->sparse_depth_search_radius_pixels << std::endl)
+  } else {
+
+    //ds precompute the depth camera rays in the left camera frame: point_left = R*K_right^-1*[c*d, r*d, d]+t = d*(R*K_right^-1*[c, r, 1])+t
+    const Matrix3 rotation_inverse_camera_matrix_right(_right_to_left_transform.linear()*_inverse_camera_matrix_right);
+    const Count number_of_pixels = _number_of_rows_image*_number_of_cols_image;
+    _rays_right_in_left_x.resize(number_of_pixels);
+    _rays_right_in_left_y.resize(number_of_pixels);
+    _rays_right_in_left_z.resize(number_of_pixels);
+    for (int32_t row = 0; row < _number_of_rows_image; ++row) {
+      for (int32_t col = 0; col < _number_of_cols_image; ++col) {
+        const Vector3 ray(rotation_inverse_camera_matrix_right*Vector3(col, row, 1));
+        const Index index = row*_number_of_cols_image+col;
+        _rays_right_in_left_x[index] = ray.x();
+        _rays_right_in_left_y[index] = ray.y();
+        _rays_right_in_left_z[index] = ray.z();
+      }
+    }
+    for (uint32_t u = 0; u < 3; ++u) {
+      _translation_right_to_left[u] = _right_to_left_transform.translation()(u);
+      for (uint32_t v = 0; v < 3; ++v) {
+        _camera_matrix_left[u][v] = _camera_left->cameraMatrix()(u, v);
+      }
+    }
+
+    //ds allocate the z-buffer
+    _depth_buffer_left.reset(new std::atomic<uint64_t>[number_of_pixels]);
+    for (Index index = 0; index < number_of_pixels; ++index) {
+      _depth_buffer_left[index].store(depth_buffer_empty, std::memory_order_relaxed);
+    }
+
+    //ds allocate thread pool for the row-parallel depth map computation (the calling thread is part of the pool)
+    if (_parameters->number_of_depth_map_threads > 1) {
+      _thread_pool_depth_map = std::make_shared<ThreadPool>(_parameters->number_of_depth_map_threads);
+      LOG_INFO(std::cerr << "DepthFramePointGenerator::configure|parallel depth map threads: " << _thread_pool_depth_map->numberOfThreads() << std::endl)
+    }
+  }
   LOG_INFO(std::cerr << "DepthFramePointGenerator::configure|configured" << std::endl)
 }
 
@@ -62,7 +121,7 @@ void DepthFramePointGenerator::compute(Frame* frame_) {
   }
 
   //ds prepare for fast stereo matching
-  IntensityFeaturePointerVector& features_left(_feature_matcher_left.feature_vector);
+  const std::vector<Index>& features_left(_feature_matcher_left.feature_vector);
 
   //ds new framepoints - optionally filtered in a consecutive binning
   FramePointPointerVector framepoints_new(_number_of_detected_keypoints);
@@ -70,30 +129,29 @@ void DepthFramePointGenerator::compute(Frame* frame_) {
   Count number_of_new_points_with_infinity_depth = 0;
 
   //ds compute depth for all remaining features
-  std::set<uint32_t> matched_indices_left;
-  for (const IntensityFeature* feature_left: features_left) {
+  for (const Index& index_feature_left: features_left) {
+    const IntensityFeature feature_left(_feature_matcher_left.getFeature(index_feature_left));
 
     //ds retrieve depth point at given pixel
-    const cv::Vec3f& depth_point = _space_map_left_meters.at<const cv::Vec3f>(feature_left->row, feature_left->col);
+    const cv::Vec3f depth_point = _getDepthPoint(feature_left.row, feature_left.col);
 
     //ds skip if below minimum depth
     if (depth_point[2] < _parameters->minimum_depth_meters) {
       continue;
     }
 
-    //ds remove feature from lattice as we will generate a framepoint with it that takes ownership
-    _feature_matcher_left.feature_lattice[feature_left->row][feature_left->col] = nullptr;
-    matched_indices_left.insert(feature_left->index_in_vector);
+    //ds remove feature from candidates as we will generate a framepoint with it
+    _feature_matcher_left.setMatched(index_feature_left);
 
     //ds if depth could not be retrieved and point triangulation is enabled
     if (depth_point[2] >= _parameters->maximum_depth_meters && _parameters->enable_point_triangulation) {
 
       //ds allocate a new framepoint (will be stored in temporary points) - currently not checked with binning!
-      FramePoint* framepoint = frame_->createFramepoint(feature_left);
+      FramePoint* framepoint = frame_->createFramepoint(&feature_left);
 
       //ds set raw estimated depth manually - reverse homogeneous division TODO wrap this in framepoint factory?
       const real depth_meters = _parameters->maximum_depth_meters;
-      const PointCoordinates point_homogeneous(feature_left->col*depth_meters, feature_left->row*depth_meters, depth_meters);
+      const PointCoordinates point_homogeneous(feature_left.col*depth_meters, feature_left.row*depth_meters, depth_meters);
       framepoint->setCameraCoordinatesLeft(inverse_camera_matrix*point_homogeneous);
       framepoint->setHasUnreliableDepth(true);
       ++number_of_new_points_with_infinity_depth;
@@ -101,7 +159,7 @@ void DepthFramePointGenerator::compute(Frame* frame_) {
     }
 
     //ds allocate a new framepoint
-    FramePoint* framepoint = frame_->createFramepoint(feature_left, PointCoordinates(depth_point[0], depth_point[1], depth_point[2]));
+    FramePoint* framepoint = frame_->createFramepoint(&feature_left, PointCoordinates(depth_point[0], depth_point[1], depth_point[2]));
 
     //ds set point to buffer
     framepoints_new[number_of_new_points] = framepoint;
@@ -109,8 +167,8 @@ void DepthFramePointGenerator::compute(Frame* frame_) {
 
     //ds store point for optional binning
     if (_parameters->enable_keypoint_binning) {
-      const Index row_bin = std::rint(static_cast<real>(feature_left->row)/_parameters->bin_size_pixels);
-      const Index col_bin = std::rint(static_cast<real>(feature_left->col)/_parameters->bin_size_pixels);
+      const Index row_bin = std::rint(static_cast<real>(feature_left.row)/_parameters->bin_size_pixels);
+      const Index col_bin = std::rint(static_cast<real>(feature_left.col)/_parameters->bin_size_pixels);
 
       //ds if there is already a point in the bin
       if (_bin_map_left[row_bin][col_bin]) {
@@ -134,8 +192,8 @@ void DepthFramePointGenerator::compute(Frame* frame_) {
                       << number_of_new_points << " with infinity depth: "
                       << number_of_new_points_with_infinity_depth << std::endl)
 
-  //ds remove unmatched features from candidate pool
-  _feature_matcher_left.prune(matched_indices_left);
+  //ds remove matched features from candidate pool
+  _feature_matcher_left.prune();
 
   //ds update framepoints - optionally binning them
   if (_parameters->enable_keypoint_binning) {
@@ -187,15 +245,17 @@ void DepthFramePointGenerator::track(Frame* frame_,
   //ds store points for which we couldn't find a track candidate
   lost_points_.resize(framepoints_previous.size());
 
-  //ds tracked and triangulated features (to not consider them in the exhaustive stereo matching)
-  std::set<uint32_t> matched_indices_left;
   Count number_of_points       = 0;
   Count number_of_points_lost  = 0;
   _number_of_tracked_landmarks = 0;
   Count number_of_points_upgraded_from_estimated_depth = 0;
 
-  //ds for each previous point
-  for (FramePoint* point_previous: framepoints_previous) {
+  //ds predict the projections of all previous points into the current left image and collect the tracking queries
+  std::vector<int32_t> indices_query(framepoints_previous.size(), -1);
+  IntensityFeatureMatcher::RegionQueryVector queries;
+  queries.reserve(framepoints_previous.size());
+  for (Index index_point = 0; index_point < framepoints_previous.size(); ++index_point) {
+    const FramePoint* point_previous = framepoints_previous[index_point];
 
     //ds transform the point into the current camera frame
     const Vector3 point_in_camera_left_prediction(camera_left_previous_in_current_*point_previous->cameraCoordinatesLeft());
@@ -211,47 +271,54 @@ void DepthFramePointGenerator::track(Frame* frame_,
       continue;
     }
 
-    //ds TRACKING obtain matching feature in left image (if any)
-    real descriptor_distance_best = _parameters->minimum_descriptor_distance_tracking;
-
-    //ds define search region (rectangular ROI)
-    int32_t row_start_point = std::max(row_projection_left-_projection_tracking_distance_pixels, 0);
-    int32_t row_end_point   = std::min(row_projection_left+_projection_tracking_distance_pixels+1, _number_of_rows_image);
-    int32_t col_start_point = std::max(col_projection_left-_projection_tracking_distance_pixels, 0);
-    int32_t col_end_point   = std::min(col_projection_left+_projection_tracking_distance_pixels+1, _number_of_cols_image);
-
-    //ds find the best match for the previous left feature (i.e. track it)
-    IntensityFeature* feature_left = _feature_matcher_left.getMatchingFeatureInRectangularRegion(row_projection_left,
-                                                                                                 col_projection_left,
-                                                                                                 point_previous->descriptorLeft(),
-                                                                                                 row_start_point,
-                                                                                                 row_end_point,
-                                                                                                 col_start_point,
-                                                                                                 col_end_point,
-                                                                                                 _parameters->minimum_descriptor_distance_tracking,
-                                                                                                 track_by_appearance_,
-                                                                                                 descriptor_distance_best);
+    //ds TRACKING obtain matching feature in left image (if any) in a rectangular ROI
+    queries.push_back(IntensityFeatureMatcher::RegionQuery(row_projection_left,
+                                                           col_projection_left,
+                                                           &point_previous->binaryDescriptorLeft(),
+                                                           std::max(row_projection_left-_projection_tracking_distance_pixels, 0),
+                                                           std::min(row_projection_left+_projection_tracking_distance_pixels+1, _number_of_rows_image),
+                                                           std::max(col_projection_left-_projection_tracking_distance_pixels, 0),
+                                                           std::min(col_projection_left+_projection_tracking_distance_pixels+1, _number_of_cols_image)));
+    indices_query[index_point] = queries.size()-1;
+  }
+
+  //ds find the best matches for the previous left features on the current feature availability
+  _feature_matcher_left.getMatchingFeaturesInRectangularRegions(queries, _minimum_descriptor_distance_tracking_scaled, track_by_appearance_, _thread_pool.get());
+
+  //ds resolve the matches in point order - features claimed by earlier points are searched again, which yields the sequential result
+  for (Index index_point = 0; index_point < framepoints_previous.size(); ++index_point) {
+    FramePoint* point_previous = framepoints_previous[index_point];
+    if (indices_query[index_point] < 0) {
+      continue;
+    }
+    const IntensityFeatureMatcher::RegionQuery& query = queries[indices_query[index_point]];
+    const int32_t col_projection_left = query.col_reference;
+    const int32_t row_projection_left = query.row_reference;
+
+    //ds obtain the left match (if any)
+    real descriptor_distance_best = _minimum_descriptor_distance_tracking_scaled;
+    const int32_t index_feature_left = _feature_matcher_left.getMatchingFeature(query, _minimum_descriptor_distance_tracking_scaled, track_by_appearance_, descriptor_distance_best);
 
     //ds if we found a match
-    if (feature_left) {
+    if (index_feature_left >= 0) {
+      const IntensityFeature feature_left(_feature_matcher_left.getFeature(index_feature_left));
 
       //ds retrieve depth point at given pixel
-      const cv::Vec3f& depth_point = _space_map_left_meters.at<const cv::Vec3f>(feature_left->row, feature_left->col);
+      const cv::Vec3f depth_point = _getDepthPoint(feature_left.row, feature_left.col);
 
       //ds skip if below minimum depth
       if (depth_point[2] < _parameters->minimum_depth_meters) {
         continue;
       }
 
-      //ds remove feature from lattice as we will generate a framepoint with it that takes ownership
-      matched_indices_left.insert(feature_left->index_in_vector);
-      _feature_matcher_left.feature_lattice[feature_left->row][feature_left->col] = nullptr;
+      //ds remove feature from candidates as we will generate a framepoint with it
+      _feature_matcher_left.setMatched(index_feature_left);
 
       //ds if depth could not be retrieved but point triangulation is enabled
       if (depth_point[2] >= _parameters->maximum_depth_meters && _parameters->enable_point_triangulation) {
 
         //ds allocate a new framepoint to the temporary framepoints buffer (points without measured depth)
-        FramePoint* framepoint = frame_->createFramepoint(feature_left, point_previous);
+        FramePoint* framepoint = frame_->createFramepoint(&feature_left, point_previous);
 
         //ds VSUALIZATION ONLY
         framepoint->setProjectionEstimateLeft(cv::Point2f(col_projection_left, row_projection_left));
@@ -259,7 +326,7 @@ void DepthFramePointGenerator::track(Frame* frame_,
       }
 
       //ds allocate a framepoint for the measured depth
-      FramePoint* framepoint = frame_->createFramepoint(feature_left, PointCoordinates(depth_point[0], depth_point[1], depth_point[2]), point_previous);
+      FramePoint* framepoint = frame_->createFramepoint(&feature_left, PointCoordinates(depth_point[0], depth_point[1], depth_point[2]), point_previous);
 
       //ds check if we have an estimated depth point that entered the active point set
       if (framepoint->hasUnreliableDepth()) {
@@ -287,8 +354,8 @@ void DepthFramePointGenerator::track(Frame* frame_,
   framepoints.resize(number_of_points);
   lost_points_.resize(number_of_points_lost);
 
-  //ds remove matched indices from candidate pools
-  _feature_matcher_left.prune(matched_indices_left);
+  //ds remove matched features from candidate pools
+  _feature_matcher_left.prune();
   LOG_DEBUG(std::cerr << "DepthFramePointGenerator::track|tracked points with depth: " << number_of_points
                       << "/" << framepoints_previous.size() << " (landmarks: " << _number_of_tracked_landmarks << ")" << std::endl)
   LOG_DEBUG(std::cerr << "DepthFramePointGenerator::track|tracked points with infinity depth: " << frame_->temporaryPoints().size() << std::endl)
@@ -297,7 +364,7 @@ void DepthFramePointGenerator::track(Frame* frame_,
                       << "/" << framepoints_previous.size() << std::endl)
 }
 
-void DepthFramePointGenerator::recoverPoints(Frame* current_frame_, const FramePointPointerVector& lost_points_) const {
+void DepthFramePointGenerator::recoverPoints(Frame* current_frame_, const FramePointPointerVector& lost_points_) {
 
   //ds precompute transforms
   const TransformMatrix3D world_to_camera_left  = current_frame_->worldToCameraLeft();
@@ -346,15 +413,6 @@ void DepthFramePointGenerator::recoverPoints(Frame* current_frame_, const FrameP
     //ds set projections - at subpixel accuarcy
     const cv::Point2f projection_left(point_in_image_left.x(), point_in_image_left.y());
 
-    //ds check if we have depth information at this pixel, retrieve depth point at given pixel
-    const cv::Vec3f& depth_point = _space_map_left_meters.at<const cv::Vec3f>(std::rint(projection_left.y), std::rint(projection_left.x));
-
-    //ds if depth is in the invalid range - skip the point
-    if (depth_point[2] < _parameters->minimum_depth_meters ||
-        depth_point[2] >= _parameters->maximum_depth_meters) {
-      continue;
-    }
-
     //ds this can be moved outside of the loop if keypoint sizes are constant
     const float regional_border_center = 5*point_previous->keypointLeft().size;
     const cv::Point2f offset_keypoint_half(regional_border_center, regional_border_center);
@@ -370,6 +428,15 @@ void DepthFramePointGenerator::recoverPoints(Frame* current_frame_, const FrameP
       continue;
     }
 
+    //ds check if we have depth information at this pixel, retrieve depth point at given pixel
+    const cv::Vec3f depth_point = _getDepthPoint(std::rint(projection_left.y), std::rint(projection_left.x));
+
+    //ds if depth is in the invalid range - skip the point
+    if (depth_point[2] < _parameters->minimum_depth_meters ||
+        depth_point[2] >= _parameters->maximum_depth_meters) {
+      continue;
+    }
+
     //ds left search regions
     const cv::Point2f corner_left(projection_left-offset_keypoint_half);
     const cv::Rect_<float> region_of_interest_left(corner_left.x, corner_left.y, regional_full_height, regional_full_height);
@@ -387,16 +454,17 @@ void DepthFramePointGenerator::recoverPoints(Frame* current_frame_, const FrameP
     }
 
     //ds if descriptor distance is to high
-    if (cv::norm(point_previous->descriptorLeft(), descriptor_left, SRRG_PROSLAM_DESCRIPTOR_NORM) > _parameters->minimum_descriptor_distance_tracking) {
+    const BinaryDescriptor binary_descriptor_left(descriptor_left);
+    if (_descriptor_distance_kernel(point_previous->binaryDescriptorLeft(), binary_descriptor_left) > _minimum_descriptor_distance_tracking_scaled) {
       continue;
     }
     keypoint_buffer_left[0].pt += corner_left;
 
-    //ds instantiate a new feature (will be owned by the framepoint)
-    IntensityFeature* feature = new IntensityFeature(keypoint_buffer_left[0], descriptor_left, 0);
+    //ds instantiate a new feature (copied by the framepoint)
+    const IntensityFeature feature(keypoint_buffer_left[0], binary_descriptor_left, 0);
 
     //ds at this point we have a valid depth measurement - obtain coordinates in the depth image
-    FramePoint* framepoint = current_frame_->createFramepoint(feature, PointCoordinates(depth_point[0], depth_point[1], depth_point[2]), point_previous);
+    FramePoint* framepoint = current_frame_->createFramepoint(&feature, PointCoordinates(depth_point[0], depth_point[1], depth_point[2]), point_previous);
 
     //ds set the point to the control structure
     current_frame_->points()[index_lost_point_recovered] = framepoint;
@@ -421,65 +489,232 @@ void DepthFramePointGenerator::_computeDepthMap(cv::Mat& right_depth_image) {
     right_depth_image_float_out.convertTo(right_depth_image, CV_16UC1, 1.0/_parameters->depth_scale_factor_intensity_to_meters);
   }
 
-  //ds allocate new space map and initialize fields with invalid maximum depth
-  _space_map_left_meters.create(_number_of_rows_image,_number_of_cols_image, CV_32FC3);
-  for (int32_t row = 0; row < _number_of_rows_image; ++row) {
-    for (int32_t col = 0; col < _number_of_cols_image; ++col) {
-      _space_map_left_meters.at<cv::Vec3f>(row, col) = cv::Vec3f(0, 0, _parameters->maximum_depth_meters);
+  _depth_image_right = right_depth_image;
+  _depth_points_sparse.clear();
+
+  //ds registered depth is read directly from the depth image, sparse lookups are computed on request
+  if (_is_depth_registered || _parameters->enable_sparse_depth_lookup) {
+    return;
+  }
+
+  const float depth_scale_factor    = _parameters->depth_scale_factor_intensity_to_meters;
+  const float maximum_depth_meters  = _parameters->maximum_depth_meters;
+  const Count number_of_row_tasks   = (_number_of_rows_image+number_of_rows_per_task-1)/number_of_rows_per_task;
+
+  //ds runs a task over all row bands, in parallel if configured
+  auto process_rows = [&](const std::function<void(const Index&)>& task_) {
+    if (_thread_pool_depth_map) {
+      _thread_pool_depth_map->execute(number_of_row_tasks, task_);
+    } else {
+      for (Index index_task = 0; index_task < number_of_row_tasks; ++index_task) {
+        task_(index_task);
+      }
+    }
+  };
+
+  //ds clear the z-buffer (all rows must be cleared before any reprojection starts)
+  process_rows([&](const Index& index_task_) {
+    const Index index_begin = index_task_*number_of_rows_per_task*_number_of_cols_image;
+    const Index index_end   = std::min(index_task_*number_of_rows_per_task+number_of_rows_per_task, static_cast<Index>(_number_of_rows_image))*_number_of_cols_image;
+    for (Index index = index_begin; index < index_end; ++index) {
+      _depth_buffer_left[index].store(depth_buffer_empty, std::memory_order_relaxed);
+    }
+  });
+
+  //ds local copies of the kernel constants (no aliasing with the output buffers)
+  const float translation_x = _translation_right_to_left[0];
+  const float translation_y = _translation_right_to_left[1];
+  const float translation_z = _translation_right_to_left[2];
+  const float k00 = _camera_matrix_left[0][0], k01 = _camera_matrix_left[0][1], k02 = _camera_matrix_left[0][2];
+  const float k10 = _camera_matrix_left[1][0], k11 = _camera_matrix_left[1][1], k12 = _camera_matrix_left[1][2];
+  const float maximum_row = _number_of_rows_image-0.5f;
+  const float maximum_col = _number_of_cols_image-0.5f;
+
+  //ds reproject all depth pixels into the left image: a branch-free float kernel per row followed by the z-buffer update
+  process_rows([&](const Index& index_task_) {
+    std::vector<float> cols_left(_number_of_cols_image);
+    std::vector<float> rows_left(_number_of_cols_image);
+    std::vector<float> depths_left(_number_of_cols_image);
+    const int32_t row_begin = index_task_*number_of_rows_per_task;
+    const int32_t row_end   = std::min(row_begin+static_cast<int32_t>(number_of_rows_per_task), _number_of_rows_image);
+    for (int32_t row = row_begin; row < row_end; ++row) {
+      const unsigned short* raw_depths = right_depth_image.ptr<const unsigned short>(row);
+      const Index index_row            = row*_number_of_cols_image;
+      const float* rays_x = _rays_right_in_left_x.data()+index_row;
+      const float* rays_y = _rays_right_in_left_y.data()+index_row;
+      const float* rays_z = _rays_right_in_left_z.data()+index_row;
+
+      //ds reprojection kernel (vectorizable, invalid pixels are filtered below)
+      for (int32_t col = 0; col < _number_of_cols_image; ++col) {
+        const float depth_right_meters = raw_depths[col]*depth_scale_factor;
+        const float x = depth_right_meters*rays_x[col]+translation_x;
+        const float y = depth_right_meters*rays_y[col]+translation_y;
+        const float z = depth_right_meters*rays_z[col]+translation_z;
+        const float inverse_z = 1.0f/z;
+        cols_left[col]   = (k00*x+k01*y)*inverse_z+k02;
+        rows_left[col]   = (k10*x+k11*y)*inverse_z+k12;
+        depths_left[col] = z;
+      }
+
+      //ds z-buffering: keep the closest point per left pixel (ties are broken by the depth pixel index)
+      for (int32_t col = 0; col < _number_of_cols_image; ++col) {
+        const float depth_left_meters = depths_left[col];
+
+        //ds skip invalid depth and points behind the camera or beyond the maximum depth
+        if (!raw_depths[col] || !(depth_left_meters > 0) || depth_left_meters >= maximum_depth_meters) {
+          continue;
+        }
+
+        //ds skip points that do not round to a pixel of the left image
+        if (!(rows_left[col] > -0.5f && rows_left[col] < maximum_row && cols_left[col] > -0.5f && cols_left[col] < maximum_col)) {
+          continue;
+        }
+        const int32_t row_left = std::round(rows_left[col]);
+        const int32_t col_left = std::round(cols_left[col]);
+
+        //ds atomic minimum on the packed entry
+        uint32_t depth_bits = 0;
+        std::memcpy(&depth_bits, &depth_left_meters, sizeof(float));
+        const uint64_t entry = (static_cast<uint64_t>(depth_bits) << 32) | (index_row+col);
+        std::atomic<uint64_t>& entry_current = _depth_buffer_left[row_left*_number_of_cols_image+col_left];
+        uint64_t value_current = entry_current.load(std::memory_order_relaxed);
+        while (entry < value_current && !entry_current.compare_exchange_weak(value_current, entry, std::memory_order_relaxed)) {}
+      }
     }
+  });
+
+  //ds in lazy mode points are resolved from the z-buffer on request (at keypoint locations only)
+  if (_parameters->enable_lazy_depth_map) {
+    return;
   }
 
-  _row_map.create(_number_of_rows_image,_number_of_cols_image, CV_16SC1);
-  _row_map=-1;
+  //ds resolve the dense space map and index maps
+  _space_map_left_meters.create(_number_of_rows_image, _number_of_cols_image, CV_32FC3);
+  _row_map.create(_number_of_rows_image, _number_of_cols_image, CV_16SC1);
+  _col_map.create(_number_of_rows_image, _number_of_cols_image, CV_16SC1);
+  process_rows([&](const Index& index_task_) {
+    const int32_t row_begin = index_task_*number_of_rows_per_task;
+    const int32_t row_end   = std::min(row_begin+static_cast<int32_t>(number_of_rows_per_task), _number_of_rows_image);
+    for (int32_t row = row_begin; row < row_end; ++row) {
+      cv::Vec3f* space_points = _space_map_left_meters.ptr<cv::Vec3f>(row);
+      short* rows_right       = _row_map.ptr<short>(row);
+      short* cols_right       = _col_map.ptr<short>(row);
+      const Index index_row   = row*_number_of_cols_image;
+      for (int32_t col = 0; col < _number_of_cols_image; ++col) {
+        const uint64_t entry = _depth_buffer_left[index_row+col].load(std::memory_order_relaxed);
+        if (entry == depth_buffer_empty) {
+          space_points[col] = cv::Vec3f(0, 0, maximum_depth_meters);
+          rows_right[col]   = -1;
+          cols_right[col]   = -1;
+        } else {
+          const Index index_pixel_right = entry & 0xFFFFFFFF;
+          const int32_t row_right       = index_pixel_right/_number_of_cols_image;
+          const int32_t col_right       = index_pixel_right%_number_of_cols_image;
+          space_points[col] = _getPointInLeft(index_pixel_right, right_depth_image.at<const unsigned short>(row_right, col_right)*depth_scale_factor);
+          rows_right[col]   = row_right;
+          cols_right[col]   = col_right;
+        }
+      }
+    }
+  });
+}
 
-  _col_map.create(_number_of_rows_image,_number_of_cols_image, CV_16SC1);
-  _col_map=-1;
+const cv::Vec3f DepthFramePointGenerator::_getDepthPoint(const int32_t& row_, const int32_t& col_) {
+  assert(row_ >= 0 && row_ < _number_of_rows_image);
+  assert(col_ >= 0 && col_ < _number_of_cols_image);
 
-  const Matrix3 inverse_camera_matrix_right = _camera_right->cameraMatrix().inverse();
-  const Matrix3 camera_matrix_left          = _camera_left->cameraMatrix();
+  //ds registered depth: the point lies on the left pixel ray
+  if (_is_depth_registered) {
+    const float depth_meters = _depth_image_right.at<const unsigned short>(row_, col_)*_parameters->depth_scale_factor_intensity_to_meters;
+    if (!(depth_meters > 0) || depth_meters >= _parameters->maximum_depth_meters) {
+      return cv::Vec3f(0, 0, _parameters->maximum_depth_meters);
+    }
+    const Vector3 point(depth_meters*_inverse_camera_matrix_left*Vector3(col_, row_, 1));
+    return cv::Vec3f(point.x(), point.y(), point.z());
+  }
 
-  TransformMatrix3D right_to_left_transform = _camera_left->robotToCamera()*_camera_right->cameraToRobot();
-  for (int32_t r=0; r<_number_of_rows_image; ++r){
-    const unsigned short* raw_depth=right_depth_image.ptr<const unsigned short>(r);
-    for (int32_t c=0; c<_number_of_cols_image; ++c, raw_depth++){
-      if (!*raw_depth)
-        continue;
-      // retrieve depth
-      const real depth_right_meters=(*raw_depth)*_parameters->depth_scale_factor_intensity_to_meters;
-      // retrieve point in right camers, meters
-      Vector3 point_in_right_camera_meters=inverse_camera_matrix_right*Vector3(c*depth_right_meters, r*depth_right_meters,depth_right_meters);
-      // map the point to the left camera
-      Vector3 point_in_left_camera_meters=right_to_left_transform*point_in_right_camera_meters;
-      // if beyond camera, discard
-      const real depth_left_meters=point_in_left_camera_meters.z();
-      if (depth_left_meters<=0)
-        continue;
-      // project to image coordinates
-      Vector3 point_in_left_camera_pixels = camera_matrix_left*point_in_left_camera_meters;
-      point_in_left_camera_pixels /= point_in_left_camera_pixels.z();
-
-      // round to int
-      const int32_t dest_r=round(point_in_left_camera_pixels.y());
-      const int32_t dest_c=round(point_in_left_camera_pixels.x());
-
-      // if outside skip
-      if (dest_r<0 ||
-          dest_r>=_number_of_rows_image ||
-          dest_c<0 ||
-          dest_c>=_number_of_cols_image)
-        continue;
+  //ds sparse lookup, reuse the result if the pixel was already queried for this frame
+  if (_parameters->enable_sparse_depth_lookup) {
+    const Index index_pixel_left = row_*_number_of_cols_image+col_;
+    std::unordered_map<Index, cv::Vec3f>::const_iterator iterator = _depth_points_sparse.find(index_pixel_left);
+    if (iterator != _depth_points_sparse.end()) {
+      return iterator->second;
+    }
+    const cv::Vec3f depth_point = _getDepthPointSparse(row_, col_);
+    _depth_points_sparse.insert(std::make_pair(index_pixel_left, depth_point));
+    return depth_point;
+  }
+  if (!_parameters->enable_lazy_depth_map) {
+    return _space_map_left_meters.at<const cv::Vec3f>(row_, col_);
+  }
 
-      // do z buffering and update indices
-      cv::Vec3f& dest_space=_space_map_left_meters.at<cv::Vec3f>(dest_r, dest_c);
+  //ds resolve the closest reprojected depth pixel
+  const uint64_t entry = _depth_buffer_left[row_*_number_of_cols_image+col_].load(std::memory_order_relaxed);
+  if (entry == depth_buffer_empty) {
+    return cv::Vec3f(0, 0, _parameters->maximum_depth_meters);
+  }
+  const Index index_pixel_right = entry & 0xFFFFFFFF;
+  return _getPointInLeft(index_pixel_right, _depth_image_right.at<const unsigned short>(index_pixel_right/_number_of_cols_image, index_pixel_right%_number_of_cols_image)*
+                                            _parameters->depth_scale_factor_intensity_to_meters);
+}
+
+const cv::Vec3f DepthFramePointGenerator::_getDepthPointSparse(const int32_t& row_, const int32_t& col_) const {
+  const real depth_scale_factor   = _parameters->depth_scale_factor_intensity_to_meters;
+  const real maximum_depth_meters = _parameters->maximum_depth_meters;
+  const CameraMatrix& camera_matrix_right = _camera_right->cameraMatrix();
+
+  //ds locate the depth pixel observing the left pixel ray: start at maximum depth and move along the ray to the measured depth
+  const Vector3 ray_left(_inverse_camera_matrix_left*Vector3(col_, row_, 1));
+  PointCoordinates point_in_left(maximum_depth_meters*ray_left);
+  int32_t row_right = -1;
+  int32_t col_right = -1;
+  for (uint32_t iteration = 0; iteration < 3; ++iteration) {
+    const PointCoordinates point_in_right(_left_to_right_transform*point_in_left);
+    if (point_in_right.z() <= 0) {
+      break;
+    }
+    const Vector3 projection_right(camera_matrix_right*point_in_right/point_in_right.z());
+    if (projection_right.y() <= -0.5 || projection_right.y() >= _number_of_rows_image-0.5 ||
+        projection_right.x() <= -0.5 || projection_right.x() >= _number_of_cols_image-0.5) {
+      break;
+    }
+    row_right = std::round(projection_right.y());
+    col_right = std::round(projection_right.x());
 
-      if (dest_space[2] > depth_left_meters){
-        dest_space=cv::Vec3f(point_in_left_camera_meters.x(),
-                             point_in_left_camera_meters.y(),
-                             point_in_left_camera_meters.z());
-        _row_map.at<short>(dest_r, dest_c)=r;
-        _col_map.at<short>(dest_r, dest_c)=c;
+    //ds move to the measured depth (if any)
+    const unsigned short raw_depth = _depth_image_right.at<const unsigned short>(row_right, col_right);
+    if (!raw_depth) {
+      break;
+    }
+    const real depth_left_meters = (_right_to_left_transform*(raw_depth*depth_scale_factor*_inverse_camera_matrix_right*Vector3(col_right, row_right, 1))).z();
+    if (depth_left_meters <= 0) {
+      break;
+    }
+    point_in_left = depth_left_meters*ray_left/ray_left.z();
+  }
+  if (row_right < 0) {
+    return cv::Vec3f(0, 0, maximum_depth_meters);
+  }
+
+  //ds z-buffer the depth neighborhood: keep the closest point that lands on the queried pixel (same result as the dense map if it lies in the neighborhood)
+  const int32_t radius = _parameters->sparse_depth_search_radius_pixels;
+  cv::Vec3f depth_point_best(0, 0, maximum_depth_meters);
+  for (int32_t row = std::max(row_right-radius, 0); row <= std::min(row_right+radius, _number_of_rows_image-1); ++row) {
+    const unsigned short* raw_depths = _depth_image_right.ptr<const unsigned short>(row);
+    for (int32_t col = std::max(col_right-radius, 0); col <= std::min(col_right+radius, _number_of_cols_image-1); ++col) {
+      if (!raw_depths[col]) {
+        continue;
+      }
+      const PointCoordinates point(_right_to_left_transform*(raw_depths[col]*depth_scale_factor*_inverse_camera_matrix_right*Vector3(col, row, 1)));
+      if (point.z() <= 0 || point.z() >= depth_point_best[2]) {
+        continue;
+      }
+      const Vector3 projection_left(_camera_left->cameraMatrix()*point/point.z());
+      if (std::round(projection_left.y()) == row_ && std::round(projection_left.x()) == col_) {
+        depth_point_best = cv::Vec3f(point.x(), point.y(), point.z());
       }
     }
   }
+  return depth_point_best;
 }
 }
@@ -1,4 +1,6 @@
 #pragma once
+#include <atomic>
+#include <unordered_map>
 #include "base_framepoint_generator.h"
 
 namespace proslam {
@@ -32,7 +34,7 @@ public:
 
   //! @brief attempts to recover framepoints in the current image using the more precise pose estimate, retrieved after pose optimization
   //! @brief param[in] current_frame_ the affected frame carrying points to be recovered
-  virtual void recoverPoints(Frame* current_frame_, const FramePointPointerVector& lost_points_) const override;
+  virtual void recoverPoints(Frame* current_frame_, const FramePointPointerVector& lost_points_) override;
 
 //ds setters/getters
 public:
@@ -41,8 +43,31 @@ public:
 
 protected:
 
+  //! @brief reprojects the depth image (right) into the left camera with a row-parallel z-buffer
+  //! @brief the dense space map is resolved from the z-buffer unless lazy computation is enabled
+  //! @brief nothing is computed for registered depth or sparse lookups
+  //! @param[in, out] right_depth_image 16 bit depth image (filtered in place if bilateral filtering is enabled)
   void _computeDepthMap(cv::Mat& right_depth_image);
 
+  //! @brief retrieves the depth point (left camera, meters) at a pixel of the left image
+  //! @brief for registered depth the point is read directly from the depth image, in sparse mode it is reprojected from the depth neighborhood (cached per frame)
+  //! @brief otherwise it is taken from the space map, or resolved from the z-buffer if lazy computation is enabled
+  //! @param[in] row_ pixel row in the left image
+  //! @param[in] col_ pixel column in the left image
+  //! @return xyz coordinates in meters, z is set to maximum_depth_meters if no depth is available
+  const cv::Vec3f _getDepthPoint(const int32_t& row_, const int32_t& col_);
+
+  //! @brief reprojects the depth neighborhood of a left image pixel and returns the closest point landing on it (sparse mode)
+  //! @brief the corresponding depth pixel is located by moving along the left pixel ray to the measured depth, starting at maximum depth
+  const cv::Vec3f _getDepthPointSparse(const int32_t& row_, const int32_t& col_) const;
+
+  //! @brief computes the left camera point of a depth image pixel from the ray tables
+  inline const cv::Vec3f _getPointInLeft(const Index& index_pixel_right_, const float& depth_right_meters_) const {
+    return cv::Vec3f(depth_right_meters_*_rays_right_in_left_x[index_pixel_right_]+_translation_right_to_left[0],
+                     depth_right_meters_*_rays_right_in_left_y[index_pixel_right_]+_translation_right_to_left[1],
+                     depth_right_meters_*_rays_right_in_left_z[index_pixel_right_]+_translation_right_to_left[2]);
+  }
+
 //ds settings
 protected:
 
@@ -53,6 +78,38 @@ protected:
   cv::Mat _row_map;               // row index in the depth image(right) corresponding to the pixel ar [r,c] in left image
   cv::Mat _col_map;               // col index in the depth image(right) corresponding to the pixel ar [r,c] in left image
 
+  //! @brief per-pixel rays of the depth camera rotated into the left camera (K_right^-1*[c, r, 1] rotated), split per coordinate for vectorization
+  //! @brief a depth pixel at index r*cols+c is located at depth*ray+translation in the left camera
+  std::vector<float> _rays_right_in_left_x;
+  std::vector<float> _rays_right_in_left_y;
+  std::vector<float> _rays_right_in_left_z;
+  float _translation_right_to_left[3] = {0, 0, 0};
+
+  //! @brief left camera matrix in single precision (projection in the reprojection kernel)
+  float _camera_matrix_left[3][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+
+  //! @brief z-buffer of the left image: per pixel the minimum of (depth bits << 32 | depth pixel index) over all reprojected depth pixels
+  //! @brief positive floats order like their bit patterns, hence the minimum is well defined and independent of the write order between threads
+  std::unique_ptr<std::atomic<uint64_t>[]> _depth_buffer_left;
+
+  //! @brief depth image of the last computation (shallow copy, required for lazy, sparse and registered lookups)
+  cv::Mat _depth_image_right;
+
+  //! @brief set if the depth image is registered to the left image (identity transform and equal camera matrices): no reprojection required
+  bool _is_depth_registered = false;
+
+  //! @brief transforms and calibration used for sparse lookups
+  TransformMatrix3D _right_to_left_transform = TransformMatrix3D::Identity();
+  TransformMatrix3D _left_to_right_transform = TransformMatrix3D::Identity();
+  Matrix3 _inverse_camera_matrix_left  = Matrix3::Identity();
+  Matrix3 _inverse_camera_matrix_right = Matrix3::Identity();
+
+  //! @brief depth points resolved in sparse mode for the current frame, indexed by left pixel (row*cols+col)
+  std::unordered_map<Index, cv::Vec3f> _depth_points_sparse;
+
+  //! @brief thread pool for the row-parallel depth map computation (only allocated for number_of_depth_map_threads > 1)
+  ThreadPoolPtr _thread_pool_depth_map = nullptr;
+
 private:
 
   //ds informative only
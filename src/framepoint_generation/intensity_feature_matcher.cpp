@@ -12,13 +12,6 @@ IntensityFeatureMatcher::IntensityFeatureMatcher() {
 
 IntensityFeatureMatcher::~IntensityFeatureMatcher() {
   LOG_INFO(std::cerr << "IntensityFeatureMatcher::~IntensityFeatureMatcher|destroying" << std::endl)
-  for (int32_t r = 0; r < number_of_rows; ++r) {
-    delete[] feature_lattice[r];
-  }
-  delete[] feature_lattice;
-  for (IntensityFeature* feature: feature_vector) {
-    delete feature;
-  }
   feature_vector.clear();
   LOG_INFO(std::cerr << "IntensityFeatureMatcher::~IntensityFeatureMatcher|destroyed" << std::endl)
 }
@@ -26,20 +19,14 @@ IntensityFeatureMatcher::~IntensityFeatureMatcher() {
 void IntensityFeatureMatcher::configure(const int32_t& rows_, const int32_t& cols_) {
   LOG_INFO(std::cerr << "IntensityFeatureMatcher::configure|configuring" << std::endl)
   if (rows_ <= 0 || cols_ <= 0) {
-    throw std::runtime_error("KeypointWithDescriptorLattice::configure|invalid image dimensions");
+    throw std::runtime_error("IntensityFeatureMatcher::configure|invalid image dimensions");
   }
-  if (feature_lattice) {
-    throw std::runtime_error("KeypointWithDescriptorLattice::configure|lattice already allocated");
+  if (!row_offsets.empty()) {
+    throw std::runtime_error("IntensityFeatureMatcher::configure|row index already allocated");
   }
 
-  //ds initialize empty lattice
-  feature_lattice = new IntensityFeature**[rows_];
-  for (int32_t r = 0; r < rows_; ++r) {
-    feature_lattice[r] = new IntensityFeature*[cols_];
-    for (int32_t c = 0; c < cols_; ++c) {
-      feature_lattice[r][c] = nullptr;
-    }
-  }
+  //ds initialize empty row index
+  row_offsets.resize(rows_+1, 0);
   number_of_rows = rows_;
   number_of_cols = cols_;
   LOG_INFO(std::cerr << "IntensityFeatureMatcher::configure|configured" << std::endl)
@@ -47,127 +34,233 @@ void IntensityFeatureMatcher::configure(const int32_t& rows_, const int32_t& col
 
 void IntensityFeatureMatcher::setFeatures(const std::vector<cv::KeyPoint>& keypoints_, const cv::Mat& descriptors_) {
   if (keypoints_.size() != static_cast<size_t>(descriptors_.rows)) {
-    throw std::runtime_error("KeypointWithDescriptorLattice::setFeatures|mismatching keypoints and descriptor numbers");
+    throw std::runtime_error("IntensityFeatureMatcher::setFeatures|mismatching keypoints and descriptor numbers");
   }
-
-  //ds clear the lattice - freeing remaining features
-  for (int32_t r = 0; r < number_of_rows; ++r) {
-    for (int32_t c = 0; c < number_of_cols; ++c) {
-      feature_lattice[r][c] = nullptr;
-    }
+  const int32_t descriptor_size_bytes = getDescriptorSizeBits()/8;
+  if (descriptors_.rows > 0 && (descriptors_.cols != descriptor_size_bytes || descriptors_.type() != CV_8U)) {
+    throw std::runtime_error("IntensityFeatureMatcher::setFeatures|descriptor size does not match the active descriptor size: " + std::to_string(getDescriptorSizeBits()));
   }
-  for (IntensityFeature* feature: feature_vector) {
-    delete feature;
+  const Count number_of_features = keypoints_.size();
+
+  //ds fill in features (overwriting the previous ones)
+  keypoints = keypoints_;
+  rows.resize(number_of_features);
+  cols.resize(number_of_features);
+  descriptors.resize(number_of_features);
+  is_available.assign(number_of_features, true);
+  feature_vector.resize(number_of_features);
+  std::fill(row_offsets.begin(), row_offsets.end(), 0);
+  for (Index index = 0; index < number_of_features; ++index) {
+    rows[index] = keypoints_[index].pt.y;
+    cols[index] = keypoints_[index].pt.x;
+    std::memcpy(descriptors[index].blocks, descriptors_.ptr<uchar>(index), descriptor_size_bytes);
+    feature_vector[index] = index;
+    ++row_offsets[rows[index]+1];
   }
 
-  //ds fill in features
-  feature_vector.resize(keypoints_.size());
-  for (uint32_t index = 0; index < keypoints_.size(); ++index) {
-    IntensityFeature* feature = new IntensityFeature(keypoints_[index], descriptors_.row(index), index);
-    feature_vector[index] = feature;
-    feature_lattice[feature->row][feature->col] = feature;
+  //ds build row index (counting sort by row, then by column within each row)
+  for (int32_t row = 0; row < number_of_rows; ++row) {
+    row_offsets[row+1] += row_offsets[row];
+  }
+  indices_by_row.resize(number_of_features);
+  std::vector<Index> row_fill(row_offsets.begin(), row_offsets.end()-1);
+  for (Index index = 0; index < number_of_features; ++index) {
+    indices_by_row[row_fill[rows[index]]] = index;
+    ++row_fill[rows[index]];
+  }
+  for (int32_t row = 0; row < number_of_rows; ++row) {
+    if (row_offsets[row+1]-row_offsets[row] > 1) {
+      std::sort(indices_by_row.begin()+row_offsets[row], indices_by_row.begin()+row_offsets[row+1], [this](const Index& a_, const Index& b_){
+        return cols[a_] < cols[b_];
+      });
+    }
   }
 }
 
-void IntensityFeatureMatcher::sortFeatureVector() {
+const int32_t IntensityFeatureMatcher::getMatchingFeatureInRectangularRegion(const int32_t& row_reference_,
+                                                                             const int32_t& col_reference_,
+                                                                             const BinaryDescriptor& descriptor_reference_,
+                                                                             const int32_t& row_start_point,
+                                                                             const int32_t& row_end_point,
+                                                                             const int32_t& col_start_point,
+                                                                             const int32_t& col_end_point,
+                                                                             const real& maximum_descriptor_distance_tracking_,
+                                                                             const bool track_by_appearance_,
+                                                                             real& descriptor_distance_best_) const {
 
-  //ds we do not want to update the IntensityFeature.index_in_vector fields for this operation (costly)
-  //ds the IntensityFeature.index_in_vector fields will be restored upon prune is called
-  std::sort(feature_vector.begin(), feature_vector.end(),  [](const IntensityFeature* a_, const IntensityFeature* b_){
-    return ((a_->row < b_->row) || (a_->row == b_->row && a_->col < b_->col));
-  });
+  //ds dispatch once on the active descriptor size (fully unrolled distance computation in the search loop)
+  switch (getDescriptorSizeBits()) {
+    case 128: {
+      return _getMatchingFeatureInRectangularRegion<128>(row_reference_, col_reference_, descriptor_reference_, row_start_point, row_end_point,
+                                                         col_start_point, col_end_point, maximum_descriptor_distance_tracking_, track_by_appearance_, descriptor_distance_best_);
+    }
+    case 512: {
+      return _getMatchingFeatureInRectangularRegion<512>(row_reference_, col_reference_, descriptor_reference_, row_start_point, row_end_point,
+                                                         col_start_point, col_end_point, maximum_descriptor_distance_tracking_, track_by_appearance_, descriptor_distance_best_);
+    }
+    default: {
+      return _getMatchingFeatureInRectangularRegion<256>(row_reference_, col_reference_, descriptor_reference_, row_start_point, row_end_point,
+                                                         col_start_point, col_end_point, maximum_descriptor_distance_tracking_, track_by_appearance_, descriptor_distance_best_);
+    }
+  }
 }
 
-IntensityFeature* IntensityFeatureMatcher::getMatchingFeatureInRectangularRegion(const int32_t& row_reference_,
-                                                                                 const int32_t& col_reference_,
-                                                                                 const cv::Mat& descriptor_reference_,
-                                                                                 const int32_t& row_start_point,
-                                                                                 const int32_t& row_end_point,
-                                                                                 const int32_t& col_start_point,
-                                                                                 const int32_t& col_end_point,
-                                                                                 const real& maximum_descriptor_distance_tracking_,
-                                                                                 const bool track_by_appearance_,
-                                                                                 real& descriptor_distance_best_) {
+template<uint32_t NUMBER_OF_BITS>
+const int32_t IntensityFeatureMatcher::_getMatchingFeatureInRectangularRegion(const int32_t& row_reference_,
+                                                                              const int32_t& col_reference_,
+                                                                              const BinaryDescriptor& descriptor_reference_,
+                                                                              const int32_t& row_start_point,
+                                                                              const int32_t& row_end_point,
+                                                                              const int32_t& col_start_point,
+                                                                              const int32_t& col_end_point,
+                                                                              const real& maximum_descriptor_distance_tracking_,
+                                                                              const bool track_by_appearance_,
+                                                                              real& descriptor_distance_best_) const {
   descriptor_distance_best_ = maximum_descriptor_distance_tracking_;
-  int32_t row_best = -1;
-  int32_t col_best = -1;
-
-  //ds locate best match in appearance
-  if (track_by_appearance_) {
-    for (int32_t row = row_start_point; row < row_end_point; ++row) {
-      for (int32_t col = col_start_point; col < col_end_point; ++col) {
-        if (feature_lattice[row][col]) {
-          const real descriptor_distance = cv::norm(descriptor_reference_,
-                                                    feature_lattice[row][col]->descriptor,
-                                                    SRRG_PROSLAM_DESCRIPTOR_NORM);
-
-          if (descriptor_distance < descriptor_distance_best_) {
-            descriptor_distance_best_ = descriptor_distance;
-            row_best = row;
-            col_best = col;
-          }
-        }
+  int32_t index_best = -1;
+  uint32_t projection_distance_pixels_best = 10000;
+
+  //ds scan all rows of the region
+  for (int32_t row = row_start_point; row < row_end_point; ++row) {
+
+    //ds locate the first feature in the region (features in a row are sorted by column)
+    const std::vector<Index>::const_iterator row_end = indices_by_row.begin()+row_offsets[row+1];
+    std::vector<Index>::const_iterator iterator = std::lower_bound(indices_by_row.begin()+row_offsets[row], row_end, col_start_point,
+                                                                   [this](const Index& index_, const int32_t& col_){return cols[index_] < col_;});
+    for (; iterator != row_end && cols[*iterator] < col_end_point; ++iterator) {
+      const Index& index = *iterator;
+      if (!is_available[index]) {
+        continue;
       }
-    }
+      const real descriptor_distance = getDescriptorDistance<NUMBER_OF_BITS>(descriptor_reference_, descriptors[index]);
 
-  //ds locate best match in projection error, within maximum appearance distance
-  } else {
-    uint32_t projection_distance_pixels_best = 10000;
-    for (int32_t row = row_start_point; row < row_end_point; ++row) {
-      for (int32_t col = col_start_point; col < col_end_point; ++col) {
-        if (feature_lattice[row][col]) {
-          const real descriptor_distance = cv::norm(descriptor_reference_,
-                                                    feature_lattice[row][col]->descriptor,
-                                                    SRRG_PROSLAM_DESCRIPTOR_NORM);
-          if (descriptor_distance < maximum_descriptor_distance_tracking_) {
-
-            //ds compute projection distance
-            const int32_t row_distance_pixels         = row_reference_-row;
-            const int32_t col_distance_pixels         = col_reference_-col;
-            const uint32_t projection_distance_pixels = row_distance_pixels*row_distance_pixels+col_distance_pixels*col_distance_pixels;
-
-            //ds if better than best so far
-            if (projection_distance_pixels < projection_distance_pixels_best) {
-              projection_distance_pixels_best = projection_distance_pixels;
-              descriptor_distance_best_       = descriptor_distance;
-              row_best = row;
-              col_best = col;
-            }
-          }
+      //ds locate best match in appearance
+      if (track_by_appearance_) {
+        if (descriptor_distance < descriptor_distance_best_) {
+          descriptor_distance_best_ = descriptor_distance;
+          index_best = index;
+        }
+
+      //ds locate best match in projection error, within maximum appearance distance
+      } else if (descriptor_distance < maximum_descriptor_distance_tracking_) {
+
+        //ds compute projection distance
+        const int32_t row_distance_pixels         = row_reference_-row;
+        const int32_t col_distance_pixels         = col_reference_-cols[index];
+        const uint32_t projection_distance_pixels = row_distance_pixels*row_distance_pixels+col_distance_pixels*col_distance_pixels;
+
+        //ds if better than best so far
+        if (projection_distance_pixels < projection_distance_pixels_best) {
+          projection_distance_pixels_best = projection_distance_pixels;
+          descriptor_distance_best_       = descriptor_distance;
+          index_best = index;
         }
       }
     }
   }
+  return index_best;
+}
+
+void IntensityFeatureMatcher::getMatchingFeaturesInRectangularRegions(RegionQueryVector& queries_,
+                                                                      const real& maximum_descriptor_distance_tracking_,
+                                                                      const bool track_by_appearance_,
+                                                                      ThreadPool* thread_pool_) const {
+  if (queries_.empty()) {
+    return;
+  }
 
-  //ds if we found a match
-  if (row_best != -1) {
-    return feature_lattice[row_best][col_best];
+  //ds tile size in pixels (neighboring queries share most of the rows and candidates in their regions)
+  const int32_t tile_size_pixels    = 64;
+  const int32_t number_of_tile_cols = number_of_cols/tile_size_pixels+1;
+  const int32_t number_of_tiles     = (number_of_rows/tile_size_pixels+1)*number_of_tile_cols;
+
+  //ds group the queries by tile of their reference (counting sort, order within a tile is preserved)
+  std::vector<Index> query_offsets(number_of_tiles+1, 0);
+  std::vector<Index> tiles(queries_.size());
+  for (Index index = 0; index < queries_.size(); ++index) {
+    const int32_t row_tile = std::min(std::max(queries_[index].row_reference, 0), number_of_rows-1)/tile_size_pixels;
+    const int32_t col_tile = std::min(std::max(queries_[index].col_reference, 0), number_of_cols-1)/tile_size_pixels;
+    tiles[index] = row_tile*number_of_tile_cols+col_tile;
+    ++query_offsets[tiles[index]+1];
+  }
+  for (int32_t tile = 0; tile < number_of_tiles; ++tile) {
+    query_offsets[tile+1] += query_offsets[tile];
+  }
+  std::vector<Index> indices_by_tile(queries_.size());
+  std::vector<Index> tile_fill(query_offsets.begin(), query_offsets.end()-1);
+  for (Index index = 0; index < queries_.size(); ++index) {
+    indices_by_tile[tile_fill[tiles[index]]] = index;
+    ++tile_fill[tiles[index]];
+  }
+
+  //ds evaluate the queries tile by tile (each query only writes its own result)
+  auto evaluate = [&](const Index& tile_) {
+    for (Index offset = query_offsets[tile_]; offset < query_offsets[tile_+1]; ++offset) {
+      RegionQuery& query = queries_[indices_by_tile[offset]];
+      query.index_best = getMatchingFeatureInRectangularRegion(query.row_reference,
+                                                               query.col_reference,
+                                                               *query.descriptor_reference,
+                                                               query.row_start_point,
+                                                               query.row_end_point,
+                                                               query.col_start_point,
+                                                               query.col_end_point,
+                                                               maximum_descriptor_distance_tracking_,
+                                                               track_by_appearance_,
+                                                               query.descriptor_distance_best);
+    }
+  };
+  if (thread_pool_) {
+    thread_pool_->execute(number_of_tiles, evaluate);
   } else {
-    return nullptr;
+    for (int32_t tile = 0; tile < number_of_tiles; ++tile) {
+      evaluate(tile);
+    }
   }
 }
 
-void IntensityFeatureMatcher::prune(const std::set<uint32_t>& matched_indices_) {
-
-  //ds remove matched indices from candidate pools
-  size_t number_of_unmatched_elements = 0;
-  for (size_t index = 0; index < feature_vector.size(); ++index) {
+const int32_t IntensityFeatureMatcher::getMatchingFeature(const RegionQuery& query_,
+                                                          const real& maximum_descriptor_distance_tracking_,
+                                                          const bool track_by_appearance_,
+                                                          real& descriptor_distance_best_) const {
 
-    //ds if we haven't matched this index yet
-    if (matched_indices_.count(index) == 0) {
+  //ds the batch result remains the best match as long as it is available (availability only decreases)
+  if (query_.index_best < 0 || is_available[query_.index_best]) {
+    descriptor_distance_best_ = query_.descriptor_distance_best;
+    return query_.index_best;
+  }
 
-      //ds keep the element (this operation is not problemenatic since we do not loop reversely here)
-      feature_vector[number_of_unmatched_elements] = feature_vector[index];
+  //ds the feature was claimed in the meantime - repeat the search
+  return getMatchingFeatureInRectangularRegion(query_.row_reference,
+                                               query_.col_reference,
+                                               *query_.descriptor_reference,
+                                               query_.row_start_point,
+                                               query_.row_end_point,
+                                               query_.col_start_point,
+                                               query_.col_end_point,
+                                               maximum_descriptor_distance_tracking_,
+                                               track_by_appearance_,
+                                               descriptor_distance_best_);
+}
 
-      //ds adjust the index for the resulting vector
-      feature_vector[number_of_unmatched_elements]->index_in_vector = number_of_unmatched_elements;
+void IntensityFeatureMatcher::prune() {
 
-      //ds move on
+  //ds remove matched features from candidate pool (order is preserved)
+  size_t number_of_unmatched_elements = 0;
+  for (size_t index = 0; index < feature_vector.size(); ++index) {
+    if (is_available[feature_vector[index]]) {
+      feature_vector[number_of_unmatched_elements] = feature_vector[index];
       ++number_of_unmatched_elements;
-    } else {
-      delete feature_vector[index];
     }
   }
   feature_vector.resize(number_of_unmatched_elements);
 }
+
+void IntensityFeatureMatcher::setMatchedInRow(const int32_t& row_, const int32_t& col_start_, const int32_t& col_end_) {
+  const std::vector<Index>::const_iterator row_end = indices_by_row.cbegin()+row_offsets[row_+1];
+  std::vector<Index>::const_iterator iterator = std::lower_bound(indices_by_row.cbegin()+row_offsets[row_], row_end, col_start_,
+                                                                 [this](const Index& index_, const int32_t& col_){return cols[index_] < col_;});
+  for (; iterator != row_end && cols[*iterator] < col_end_; ++iterator) {
+    is_available[*iterator] = false;
+  }
+}
 } //namespace proslam
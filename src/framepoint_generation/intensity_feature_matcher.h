@@ -1,15 +1,49 @@
 #pragma once
 #include "intensity_feature_extractor.h"
 #include "types/frame_point.h"
+#include "types/thread_pool.h"
 
 
 
 namespace proslam {
 
 //! @struct support structure
+//! @brief features are kept in a structure of arrays (indexed by the feature index = keypoint index in setFeatures)
+//! @brief spatial queries use a compact row-bucketed index instead of a per-pixel lattice
 class IntensityFeatureMatcher {
 public:
 
+  //! @struct rectangular region search query and its result, for batched searches
+  struct RegionQuery {
+    RegionQuery(const int32_t& row_reference_,
+                const int32_t& col_reference_,
+                const BinaryDescriptor* descriptor_reference_,
+                const int32_t& row_start_point_,
+                const int32_t& row_end_point_,
+                const int32_t& col_start_point_,
+                const int32_t& col_end_point_): row_reference(row_reference_),
+                                                col_reference(col_reference_),
+                                                descriptor_reference(descriptor_reference_),
+                                                row_start_point(row_start_point_),
+                                                row_end_point(row_end_point_),
+                                                col_start_point(col_start_point_),
+                                                col_end_point(col_end_point_) {}
+
+    //ds query (the descriptor must outlive the query)
+    int32_t row_reference;
+    int32_t col_reference;
+    const BinaryDescriptor* descriptor_reference;
+    int32_t row_start_point;
+    int32_t row_end_point;
+    int32_t col_start_point;
+    int32_t col_end_point;
+
+    //ds result of the batch search: best feature index (-1 if none) and its descriptor distance
+    int32_t index_best            = -1;
+    real descriptor_distance_best = 0;
+  };
+  typedef std::vector<RegionQuery> RegionQueryVector;
+
   IntensityFeatureMatcher();
   ~IntensityFeatureMatcher();
 
@@ -21,25 +55,69 @@ public:
   //ds create features from keypoints and descriptors
   void setFeatures(const std::vector<cv::KeyPoint>& keypoints_, const cv::Mat& descriptors_);
 
-  //ds sort all input vectors by ascending row positions (preparation for stereo matching)
-  //ds NOTE: calling this function breaks the IntensityFeature.index_in_vector fields until prune is called
-  //ds this behavior is desired for high efficiency
-  void sortFeatureVector();
-
-  //ds performs a local search in a rectangular area on the feature lattice
-  IntensityFeature* getMatchingFeatureInRectangularRegion(const int32_t& row_reference_,
-                                                          const int32_t& col_reference_,
-                                                          const cv::Mat& descriptor_reference_,
-                                                          const int32_t& row_start_point,
-                                                          const int32_t& row_end_point,
-                                                          const int32_t& col_start_point,
-                                                          const int32_t& col_end_point,
-                                                          const real& maximum_descriptor_distance_tracking_,
-                                                          const bool track_by_appearance_,
-                                                          real& descriptor_distance_best_);
-
-  //ds prunes features from feature vector if existing
-  void prune(const std::set<uint32_t>& matched_indices_);
+  //ds performs a local search in a rectangular area on the row index - returns the feature index or -1 if no match was found
+  const int32_t getMatchingFeatureInRectangularRegion(const int32_t& row_reference_,
+                                                      const int32_t& col_reference_,
+                                                      const BinaryDescriptor& descriptor_reference_,
+                                                      const int32_t& row_start_point,
+                                                      const int32_t& row_end_point,
+                                                      const int32_t& col_start_point,
+                                                      const int32_t& col_end_point,
+                                                      const real& maximum_descriptor_distance_tracking_,
+                                                      const bool track_by_appearance_,
+                                                      real& descriptor_distance_best_) const;
+
+  //! @brief evaluates all queries with getMatchingFeatureInRectangularRegion against the current feature availability (no features are claimed)
+  //! @brief queries are grouped by spatial tile and evaluated tile by tile, keeping the row index and descriptors of a tile in cache
+  //! @brief with a thread pool the tiles are distributed over the pool threads, the results do not depend on the number of threads
+  //! @param[in, out] queries_ queries, the results are written into the query structures
+  //! @param[in] maximum_descriptor_distance_tracking_ maximum descriptor distance for all queries
+  //! @param[in] track_by_appearance_ matching criterion for all queries (see getMatchingFeatureInRectangularRegion)
+  //! @param[in] thread_pool_ optional thread pool
+  void getMatchingFeaturesInRectangularRegions(RegionQueryVector& queries_,
+                                               const real& maximum_descriptor_distance_tracking_,
+                                               const bool track_by_appearance_,
+                                               ThreadPool* thread_pool_ = nullptr) const;
+
+  //! @brief returns the batch result of a query if the feature is still available, otherwise the query is repeated on the current availability
+  //! @brief for queries resolved in batch order this yields the same matches as sequential getMatchingFeatureInRectangularRegion calls
+  //! @param[in] query_ evaluated query (getMatchingFeaturesInRectangularRegions)
+  //! @param[in] maximum_descriptor_distance_tracking_ maximum descriptor distance used for the batch
+  //! @param[in] track_by_appearance_ matching criterion used for the batch
+  //! @param[out] descriptor_distance_best_ descriptor distance of the returned feature
+  //! @return feature index or -1 if no match was found
+  const int32_t getMatchingFeature(const RegionQuery& query_,
+                                   const real& maximum_descriptor_distance_tracking_,
+                                   const bool track_by_appearance_,
+                                   real& descriptor_distance_best_) const;
+
+  //ds removes all matched features from the feature vector
+  void prune();
+
+  //ds excludes a feature from all further searches (it is removed from the feature vector on the next prune call)
+  inline void setMatched(const Index& index_) {is_available[index_] = false;}
+
+  //ds excludes all features in a row within [col_start_, col_end_) from further searches
+  void setMatchedInRow(const int32_t& row_, const int32_t& col_start_, const int32_t& col_end_);
+
+  //ds assembles a feature from the store (e.g. for framepoint creation)
+  inline IntensityFeature getFeature(const Index& index_) const {return IntensityFeature(keypoints[index_], descriptors[index_], index_);}
+
+//ds helpers
+protected:
+
+  //! @brief getMatchingFeatureInRectangularRegion for a fixed descriptor size (dispatched on the active descriptor size)
+  template<uint32_t NUMBER_OF_BITS>
+  const int32_t _getMatchingFeatureInRectangularRegion(const int32_t& row_reference_,
+                                                       const int32_t& col_reference_,
+                                                       const BinaryDescriptor& descriptor_reference_,
+                                                       const int32_t& row_start_point,
+                                                       const int32_t& row_end_point,
+                                                       const int32_t& col_start_point,
+                                                       const int32_t& col_end_point,
+                                                       const real& maximum_descriptor_distance_tracking_,
+                                                       const bool track_by_appearance_,
+                                                       real& descriptor_distance_best_) const;
 
 //ds attributes
 public:
@@ -48,11 +126,22 @@ public:
   int32_t number_of_rows = 0;
   int32_t number_of_cols = 0;
 
-  //ds feature information stored in a linear array (which is sorted and exploited for e.g. rigid stereo matching)
-  IntensityFeaturePointerVector feature_vector;
+  //ds feature store (structure of arrays, indexed by feature index)
+  std::vector<cv::KeyPoint> keypoints;
+  std::vector<int32_t> rows;
+  std::vector<int32_t> cols;
+  std::vector<BinaryDescriptor> descriptors;
+
+  //ds feature availability: features are set unavailable once matched
+  std::vector<bool> is_available;
+
+  //ds indices of the currently available features (in keypoint order, updated by prune)
+  std::vector<Index> feature_vector;
 
-  //ds image which contains features at pixel positions
-  IntensityFeature*** feature_lattice = nullptr;
+  //ds row index: the indices of all features in image row r, sorted by column, are in [row_offsets[r], row_offsets[r+1]) of indices_by_row
+  //ds exploited for e.g. rigid stereo matching, where each epipolar line is looked up directly
+  std::vector<Index> row_offsets;
+  std::vector<Index> indices_by_row;
 
 };
 } //namespace proslam
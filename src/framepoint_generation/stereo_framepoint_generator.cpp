@@ -17,6 +17,11 @@ void StereoFramePointGenerator::configure(){
   _parameters->number_of_cameras = 2;
   BaseFramePointGenerator::configure();
 
+  //ds descriptor distances are configured for the storage size - adapt them to the active size (set by the base configure)
+  _maximum_matching_distance_triangulation           = getScaledDescriptorDistance(_maximum_matching_distance_triangulation);
+  _minimum_maximum_descriptor_distance_triangulation = 0.1*getDescriptorSizeBits();
+  _current_maximum_descriptor_distance_triangulation = _minimum_maximum_descriptor_distance_triangulation;
+
   //ds configure stereo triangulation parameters
   _baseline        = _camera_right->baselineHomogeneous();
   _b_x             = _baseline(0);
@@ -32,6 +37,13 @@ void StereoFramePointGenerator::configure(){
   //ds initialize feature matcher
   _feature_matcher_right.configure(_number_of_rows_image, _number_of_cols_image);
 
+  //ds the right image is processed by a second pool thread, which requires its own descriptor extractor
+  if (_parameters->enable_parallel_feature_extraction) {
+    _descriptor_extractor_right = _createDescriptorExtractor();
+    _thread_pool_stereo         = std::make_shared<ThreadPool>(2);
+    LOG_INFO(std::cerr << "StereoFramePointGenerator::configure|enabled parallel feature extraction for left and right image" << std::endl)
+  }
+
   //ds configure epipolar search ranges (minimum 0)
   _epipolar_search_offsets_pixel.push_back(0);
   for (int32_t u = 1; u <= _parameters->maximum_epipolar_search_offset_pixels; ++u) {
@@ -60,19 +72,40 @@ void StereoFramePointGenerator::initialize(Frame* frame_, const bool& extract_fe
   //ds check if a new feature extraction is desired (the frame might already be set up)
   if (extract_features_) {
 
-    //ds detect new features - check if we have information from a previous computation
-    if (frame_->previous()) {
-      detectKeypoints(frame_->intensityImageLeft(), frame_->keypointsLeft(), frame_->previous()->hasReliablePoseEstimate());
-      detectKeypoints(frame_->intensityImageRight(), frame_->keypointsRight(), frame_->previous()->hasReliablePoseEstimate());
+    //ds check if we have information from a previous computation
+    const bool ignore_minimum_detector_threshold = (frame_->previous() && frame_->previous()->hasReliablePoseEstimate());
+
+    //ds detect new features and extract descriptors for them
+    if (_thread_pool_stereo) {
+
+      //ds process left (task 0) and right (task 1) image in parallel - each parallel section is timed once (wall time)
+      CHRONOMETER_START(keypoint_detection)
+      _thread_pool_stereo->execute(2, [&](const Index& index_) {
+        if (index_ == 0) {
+          _detectKeypoints(frame_->intensityImageLeft(), frame_->keypointsLeft(), ignore_minimum_detector_threshold);
+        } else {
+          _detectKeypoints(frame_->intensityImageRight(), frame_->keypointsRight(), ignore_minimum_detector_threshold);
+        }
+      });
+      CHRONOMETER_STOP(keypoint_detection)
+      CHRONOMETER_START(descriptor_extraction)
+      _thread_pool_stereo->execute(2, [&](const Index& index_) {
+        if (index_ == 0) {
+          _computeDescriptors(_descriptor_extractor, frame_->intensityImageLeft(), frame_->keypointsLeft(), frame_->descriptorsLeft());
+        } else {
+          _computeDescriptors(_descriptor_extractor_right, frame_->intensityImageRight(), frame_->keypointsRight(), frame_->descriptorsRight());
+        }
+      });
+      CHRONOMETER_STOP(descriptor_extraction)
     } else {
-      detectKeypoints(frame_->intensityImageLeft(), frame_->keypointsLeft());
-      detectKeypoints(frame_->intensityImageRight(), frame_->keypointsRight());
+      detectKeypoints(frame_->intensityImageLeft(), frame_->keypointsLeft(), ignore_minimum_detector_threshold);
+      detectKeypoints(frame_->intensityImageRight(), frame_->keypointsRight(), ignore_minimum_detector_threshold);
+      computeDescriptors(frame_->intensityImageLeft(), frame_->keypointsLeft(), frame_->descriptorsLeft());
+      computeDescriptors(frame_->intensityImageRight(), frame_->keypointsRight(), frame_->descriptorsRight());
     }
-    adjustDetectorThresholds();
 
-    //ds extract descriptors for detected features
-    computeDescriptors(frame_->intensityImageLeft(), frame_->keypointsLeft(), frame_->descriptorsLeft());
-    computeDescriptors(frame_->intensityImageRight(), frame_->keypointsRight(), frame_->descriptorsRight());
+    //ds thresholds are only adjusted after both detections (detectors are shared between the images)
+    adjustDetectorThresholds();
     _number_of_detected_keypoints = frame_->keypointsLeft().size();
     LOG_DEBUG(std::cerr << "StereoFramePointGenerator::initialize|extracted features L: " << frame_->keypointsLeft().size()
                         << " R: " << frame_->keypointsRight().size() << std::endl)
@@ -81,12 +114,12 @@ void StereoFramePointGenerator::initialize(Frame* frame_, const bool& extract_fe
     if (frame_->status() == Frame::Localizing) {
 
       //ds be conservative while localizing
-      _current_maximum_descriptor_distance_triangulation = std::min(0.1*SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS, _parameters->maximum_matching_distance_triangulation);
+      _current_maximum_descriptor_distance_triangulation = std::min(_minimum_maximum_descriptor_distance_triangulation, _maximum_matching_distance_triangulation);
     } else {
 
       //ds adjust triangulation distance: few points > narrow window as we cannot permit a relatively high ratio of invalid triangulations
       const real ratio_available_points = std::min(static_cast<real>(_number_of_detected_keypoints)/_target_number_of_keypoints, 1.0);
-      _current_maximum_descriptor_distance_triangulation = std::max(ratio_available_points*_parameters->maximum_matching_distance_triangulation, 0.1*SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS);
+      _current_maximum_descriptor_distance_triangulation = std::max(ratio_available_points*_maximum_matching_distance_triangulation, _minimum_maximum_descriptor_distance_triangulation);
     }
   }
 
@@ -112,155 +145,181 @@ void StereoFramePointGenerator::compute(Frame* frame_) {
     }
   }
 
-  //ds prepare for fast stereo matching - we temporally break the IntensityFeature.index_in_vector, which will be restored when pruning
-  _feature_matcher_left.sortFeatureVector();
-  _feature_matcher_right.sortFeatureVector();
-
   //ds new framepoints - optionally filtered in a consecutive binning
   FramePointPointerVector framepoints_new(_number_of_detected_keypoints);
-  Count number_of_new_points = 0;
 
-  //ds start stereo matching for all epipolar offsets
-  for (const int32_t& epipolar_offset: _epipolar_search_offsets_pixel) {
-    IntensityFeaturePointerVector& features_left(_feature_matcher_left.feature_vector);
-    IntensityFeaturePointerVector& features_right(_feature_matcher_right.feature_vector);
+  //ds dispatch once on the active descriptor size (fully unrolled distance computation in the matching loop)
+  Count number_of_new_points = 0;
+  switch (getDescriptorSizeBits()) {
+    case 128: {number_of_new_points = _triangulate<128>(frame_, framepoints_new); break;}
+    case 512: {number_of_new_points = _triangulate<512>(frame_, framepoints_new); break;}
+    default:  {number_of_new_points = _triangulate<256>(frame_, framepoints_new); break;}
+  }
 
-    //ds matched features (to not consider them for the next offset search)
-    std::set<uint32_t> matched_indices_left;
-    std::set<uint32_t> matched_indices_right;
+  //ds update candidate pools
+  _feature_matcher_left.prune();
+  _feature_matcher_right.prune();
 
-    //ds running variable
-    uint32_t index_R = 0;
+  framepoints_new.resize(number_of_new_points);
+  LOG_DEBUG(std::cerr << "StereoFramePointGenerator::compute|number of new stereo points: " << number_of_new_points << "/" << _number_of_detected_keypoints << std::endl)
 
-    //ds loop over all left keypoints
-    for (uint32_t index_L = 0; index_L < features_left.size(); index_L++) {
+  //ds update framepoints
+  if (_parameters->enable_keypoint_binning) {
 
-      //ds if there are no more points on the right to match against - stop
-      if (index_R == features_right.size()) {break;}
+    //ds reserve space for the best case (all points can be added)
+    Count number_of_points_binned = number_of_points_tracked;
+    framepoints.resize(number_of_points_tracked+number_of_new_points);
 
-      //ds the right keypoints are on an lower row - skip left
-      while (features_left[index_L]->row < features_right[index_R]->row+epipolar_offset) {
-        index_L++; if (index_L == features_left.size()) {break;}
+    //ds accumulate new points over bin grid
+    for (Index row = 0; row < _number_of_rows_bin; ++row) {
+      for (Index col = 0; col < _number_of_cols_bin; ++col) {
+        if (_bin_map_left[row][col] && !_bin_map_left[row][col]->previous()) {
+          framepoints[number_of_points_binned] = _bin_map_left[row][col];
+          ++number_of_points_binned;
+        }
+        _bin_map_left[row][col] = nullptr;
       }
-      if (index_L == features_left.size()) {break;}
-      IntensityFeature* feature_left = features_left[index_L];
+    }
+    framepoints.resize(number_of_points_binned);
+    LOG_DEBUG(std::cerr << "StereoFramePointGenerator::compute|number of new stereo points binned: " << number_of_points_binned-number_of_points_tracked << std::endl)
+  } else {
 
-      //ds the right keypoints are on an upper row - skip right
-      while (feature_left->row > features_right[index_R]->row+epipolar_offset) {
-        index_R++; if (index_R == features_right.size()) {break;}
-      }
-      if (index_R == features_right.size()) {break;}
+    //ds add all points to frame
+    framepoints.insert(framepoints.end(), framepoints_new.begin(), framepoints_new.end());
+  }
+  CHRONOMETER_STOP(point_triangulation)
+}
 
-      //ds search bookkeeping
-      uint32_t index_search_R       = index_R;
-      real descriptor_distance_best = _current_maximum_descriptor_distance_triangulation;
-      uint32_t index_best_R         = 0;
+template<uint32_t NUMBER_OF_BITS>
+const Count StereoFramePointGenerator::_triangulate(Frame* frame_, FramePointPointerVector& framepoints_new_) {
 
-      //ds scan epipolar line for current keypoint at idx_L - exhaustive
-      while (feature_left->row == features_right[index_search_R]->row+epipolar_offset) {
+  //ds row index of both images (built once per frame in setFeatures): features of row r are in [row_offsets[r], row_offsets[r+1]), sorted by column
+  const std::vector<Index>& row_offsets_left(_feature_matcher_left.row_offsets);
+  const std::vector<Index>& row_offsets_right(_feature_matcher_right.row_offsets);
+  const std::vector<Index>& indices_left(_feature_matcher_left.indices_by_row);
+  const std::vector<Index>& indices_right(_feature_matcher_right.indices_by_row);
+  const std::vector<int32_t>& rows_left(_feature_matcher_left.rows);
+  const std::vector<int32_t>& cols_left(_feature_matcher_left.cols);
+  const std::vector<int32_t>& cols_right(_feature_matcher_right.cols);
 
-        //ds invalid disparity stop condition
-        if (feature_left->col-features_right[index_search_R]->col < 0) {break;}
+  //ds matched features are masked in the feature matchers (tracked features are already masked)
+  const std::vector<bool>& is_available_left(_feature_matcher_left.is_available);
+  const std::vector<bool>& is_available_right(_feature_matcher_right.is_available);
 
-        //ds compute descriptor distance for the stereo match candidates
-        const real descriptor_distance = cv::norm(feature_left->descriptor, features_right[index_search_R]->descriptor, SRRG_PROSLAM_DESCRIPTOR_NORM);
-        if(descriptor_distance < descriptor_distance_best) {
-          descriptor_distance_best = descriptor_distance;
-          index_best_R             = index_search_R;
-        }
-        index_search_R++; if (index_search_R == features_right.size()) {break;}
-      }
+  //ds new framepoints - optionally filtered in a consecutive binning
+  Count number_of_new_points = 0;
 
-      //ds check if something was found
-      if (descriptor_distance_best < _current_maximum_descriptor_distance_triangulation) {
-        IntensityFeature* feature_right = features_right[index_best_R];
+  //ds start stereo matching for all epipolar offsets
+  for (const int32_t& epipolar_offset: _epipolar_search_offsets_pixel) {
 
-        //ds skip points with insufficient stereo disparity
-        if (feature_left->col-feature_right->col < _parameters->minimum_disparity_pixels) {
+    //ds left rows for which the corresponding right row (row-epipolar_offset) lies inside the image
+    const int32_t row_left_begin = std::max(epipolar_offset, 0);
+    const int32_t row_left_end   = std::min(_number_of_rows_image+epipolar_offset, _number_of_rows_image);
+    for (int32_t row_left = row_left_begin; row_left < row_left_end; ++row_left) {
+
+      //ds candidate range on the right epipolar line - skip if either line is empty
+      const int32_t row_right   = row_left-epipolar_offset;
+      Index index_R             = row_offsets_right[row_right];
+      const Index index_end_R   = row_offsets_right[row_right+1];
+      if (index_R == index_end_R || row_offsets_left[row_left] == row_offsets_left[row_left+1]) {
+        continue;
+      }
+
+      //ds loop over all left keypoints on this line
+      for (Index index_L = row_offsets_left[row_left]; index_L < row_offsets_left[row_left+1]; ++index_L) {
+        const Index feature_left = indices_left[index_L];
+        if (!is_available_left[feature_left]) {
           continue;
         }
 
-        //ds compute a new framepoint without track
-        FramePoint* framepoint = frame_->createFramepoint(feature_left,
-                                                          feature_right,
-                                                          descriptor_distance_best,
-                                                          getPointInLeftCamera(feature_left->keypoint.pt, feature_right->keypoint.pt));
-        framepoint->setEpipolarOffset(epipolar_offset);
+        //ds if there are no more points on the right to match against - stop
+        if (index_R == index_end_R) {break;}
 
-        //ds store point for optional binning
-        if (_parameters->enable_keypoint_binning) {
-          const Index row_bin = std::rint(static_cast<real>(feature_left->row)/_parameters->bin_size_pixels);
-          const Index col_bin = std::rint(static_cast<real>(feature_left->col)/_parameters->bin_size_pixels);
+        //ds search bookkeeping
+        real descriptor_distance_best = _current_maximum_descriptor_distance_triangulation;
+        Index index_best_R            = 0;
 
-          //ds if there is already a point in the bin
-          if (_bin_map_left[row_bin][col_bin]) {
-            const FramePoint* current = _bin_map_left[row_bin][col_bin];
+        //ds scan epipolar line for current keypoint - exhaustive
+        for (Index index_search_R = index_R; index_search_R < index_end_R; ++index_search_R) {
+          const Index feature_right = indices_right[index_search_R];
 
-            //ds if the point in the bin is not tracked, we prefer points with maximal disparity (= maximally accurate depth estimate)
-            if (!current->previous() &&
-                framepoint->disparityPixels() > current->disparityPixels() &&
-                framepoint->descriptorDistanceTriangulation() <= current->descriptorDistanceTriangulation()) {
+          //ds invalid disparity stop condition
+          if (cols_left[feature_left]-cols_right[feature_right] < 0) {break;}
 
-              //ds overwrite the entry
-              _bin_map_left[row_bin][col_bin] = framepoint;
-            }
-          } else {
+          //ds skip already matched features
+          if (!is_available_right[feature_right]) {
+            continue;
+          }
 
-            //ds add a new entry
-            _bin_map_left[row_bin][col_bin] = framepoint;
+          //ds compute descriptor distance for the stereo match candidates
+          const real descriptor_distance = getDescriptorDistance<NUMBER_OF_BITS>(_feature_matcher_left.descriptors[feature_left],
+                                                                                 _feature_matcher_right.descriptors[feature_right]);
+          if(descriptor_distance < descriptor_distance_best) {
+            descriptor_distance_best = descriptor_distance;
+            index_best_R             = index_search_R;
           }
         }
 
-        //ds set point to buffer
-        framepoints_new[number_of_new_points] = framepoint;
-        ++number_of_new_points;
-
-        //ds block further matching NOTE: that we have to put the indices of the sorted vector instead of using IntensityFeature.index_in_vector
-        //ds this because the IntensityFeature.index_in_vector gets broken after the sorting and we don't want to spend time on maintaining it for this task
-        matched_indices_left.insert(index_L);
-        matched_indices_right.insert(index_best_R);
-        _feature_matcher_left.feature_lattice[feature_left->row][feature_left->col]    = nullptr;
-        _feature_matcher_right.feature_lattice[feature_right->row][feature_right->col] = nullptr;
+        //ds check if something was found
+        if (descriptor_distance_best < _current_maximum_descriptor_distance_triangulation) {
+          const Index feature_right = indices_right[index_best_R];
 
-        //ds reduce search space (this eliminates all structurally conflicting matches)
-        index_R = index_best_R+1;
-      }
-    }
+          //ds skip points with insufficient stereo disparity
+          if (cols_left[feature_left]-cols_right[feature_right] < _parameters->minimum_disparity_pixels) {
+            continue;
+          }
 
-    //ds remove matched indices from candidate pools
-    _feature_matcher_left.prune(matched_indices_left);
-    _feature_matcher_right.prune(matched_indices_right);
-    LOG_DEBUG(std::cerr << "StereoFramePointGenerator::compute|epipolar offset: " << epipolar_offset
-                        << " number of unmatched features L: " << features_left.size() << " R: " << features_right.size() << std::endl)
-  }
-  framepoints_new.resize(number_of_new_points);
-  LOG_DEBUG(std::cerr << "StereoFramePointGenerator::compute|number of new stereo points: " << number_of_new_points << "/" << _number_of_detected_keypoints << std::endl)
+          //ds compute a new framepoint without track
+          const IntensityFeature intensity_feature_left(_feature_matcher_left.getFeature(feature_left));
+          const IntensityFeature intensity_feature_right(_feature_matcher_right.getFeature(feature_right));
+          FramePoint* framepoint = frame_->createFramepoint(&intensity_feature_left,
+                                                            &intensity_feature_right,
+                                                            descriptor_distance_best,
+                                                            getPointInLeftCamera(intensity_feature_left.keypoint.pt, intensity_feature_right.keypoint.pt));
+          framepoint->setEpipolarOffset(epipolar_offset);
+
+          //ds store point for optional binning
+          if (_parameters->enable_keypoint_binning) {
+            const Index row_bin = std::rint(static_cast<real>(rows_left[feature_left])/_parameters->bin_size_pixels);
+            const Index col_bin = std::rint(static_cast<real>(cols_left[feature_left])/_parameters->bin_size_pixels);
+
+            //ds if there is already a point in the bin
+            if (_bin_map_left[row_bin][col_bin]) {
+              const FramePoint* current = _bin_map_left[row_bin][col_bin];
+
+              //ds if the point in the bin is not tracked, we prefer points with maximal disparity (= maximally accurate depth estimate)
+              if (!current->previous() &&
+                  framepoint->disparityPixels() > current->disparityPixels() &&
+                  framepoint->descriptorDistanceTriangulation() <= current->descriptorDistanceTriangulation()) {
+
+                //ds overwrite the entry
+                _bin_map_left[row_bin][col_bin] = framepoint;
+              }
+            } else {
+
+              //ds add a new entry
+              _bin_map_left[row_bin][col_bin] = framepoint;
+            }
+          }
 
-  //ds update framepoints
-  if (_parameters->enable_keypoint_binning) {
+          //ds set point to buffer
+          framepoints_new_[number_of_new_points] = framepoint;
+          ++number_of_new_points;
 
-    //ds reserve space for the best case (all points can be added)
-    Count number_of_points_binned = number_of_points_tracked;
-    framepoints.resize(number_of_points_tracked+number_of_new_points);
+          //ds block further matching
+          _feature_matcher_left.setMatched(feature_left);
+          _feature_matcher_right.setMatched(feature_right);
 
-    //ds accumulate new points over bin grid
-    for (Index row = 0; row < _number_of_rows_bin; ++row) {
-      for (Index col = 0; col < _number_of_cols_bin; ++col) {
-        if (_bin_map_left[row][col] && !_bin_map_left[row][col]->previous()) {
-          framepoints[number_of_points_binned] = _bin_map_left[row][col];
-          ++number_of_points_binned;
+          //ds reduce search space (this eliminates all structurally conflicting matches)
+          index_R = index_best_R+1;
         }
-        _bin_map_left[row][col] = nullptr;
       }
     }
-    framepoints.resize(number_of_points_binned);
-    LOG_DEBUG(std::cerr << "StereoFramePointGenerator::compute|number of new stereo points binned: " << number_of_points_binned-number_of_points_tracked << std::endl)
-  } else {
-
-    //ds add all points to frame
-    framepoints.insert(framepoints.end(), framepoints_new.begin(), framepoints_new.end());
+    LOG_DEBUG(std::cerr << "StereoFramePointGenerator::_triangulate|epipolar offset: " << epipolar_offset
+                        << " number of new stereo points: " << number_of_new_points << std::endl)
   }
-  CHRONOMETER_STOP(point_triangulation)
+
+  return number_of_new_points;
 }
 
 void StereoFramePointGenerator::track(Frame* frame_,
@@ -282,24 +341,37 @@ void StereoFramePointGenerator::track(Frame* frame_,
   //ds store points for which we couldn't find a track candidate
   lost_points_.resize(framepoints_previous.size());
 
-  //ds tracked and triangulated features (to not consider them in the exhaustive stereo matching)
-  std::set<uint32_t> matched_indices_left;
-  std::set<uint32_t> matched_indices_right;
   Count number_of_tracked_points       = 0;
   Count number_of_points_lost  = 0;
   _number_of_tracked_landmarks = 0;
   real accumulated_descriptor_distance = 0;
 
-  //ds for each previous point
-  for (FramePoint* point_previous: framepoints_previous) {
+  //ds for wide tracking windows (e.g. fast motion) attempt to estimate the projection offset on a coarse pyramid level first
+  cv::Point2f projection_offset(0, 0);
+  int32_t tracking_distance_pixels = _projection_tracking_distance_pixels;
+  if (_parameters->enable_coarse_to_fine_tracking && tracking_distance_pixels > _parameters->coarse_to_fine_tracking_distance_pixels) {
+    if (_estimateProjectionOffsetCoarse(frame_, frame_previous_, camera_left_previous_in_current_, projection_offset)) {
+
+      //ds track at full resolution in tight windows around the corrected projections
+      tracking_distance_pixels = _parameters->coarse_to_fine_tracking_distance_pixels;
+    }
+  }
+
+  //ds predict the projections of all previous points into the current left image and collect the tracking queries
+  std::vector<int32_t> indices_query_left(framepoints_previous.size(), -1);
+  std::vector<Vector3> points_in_image_left(framepoints_previous.size());
+  IntensityFeatureMatcher::RegionQueryVector queries_left;
+  queries_left.reserve(framepoints_previous.size());
+  for (Index index_point = 0; index_point < framepoints_previous.size(); ++index_point) {
+    const FramePoint* point_previous = framepoints_previous[index_point];
 
     //ds transform the point into the current camera frame
     const Vector3 point_in_camera_left_prediction(camera_left_previous_in_current_*point_previous->cameraCoordinatesLeft());
 
     //ds project the point into the current left image plane
     const Vector3 point_in_image_left(camera_calibration_matrix*point_in_camera_left_prediction);
-    const int32_t col_projection_left = point_in_image_left.x()/point_in_image_left.z();
-    const int32_t row_projection_left = point_in_image_left.y()/point_in_image_left.z();
+    const int32_t col_projection_left = point_in_image_left.x()/point_in_image_left.z()+projection_offset.x;
+    const int32_t row_projection_left = point_in_image_left.y()/point_in_image_left.z()+projection_offset.y;
 
     //ds skip point if not in image plane
     if (col_projection_left < 0 || col_projection_left > _number_of_cols_image ||
@@ -307,109 +379,145 @@ void StereoFramePointGenerator::track(Frame* frame_,
       continue;
     }
 
-    //ds TRACKING obtain matching feature in left image (if any)
-    real descriptor_distance_best = _maximum_descriptor_distance_tracking;
+    //ds TRACKING obtain matching feature in left image (if any) in a rectangular ROI
+    queries_left.push_back(IntensityFeatureMatcher::RegionQuery(row_projection_left,
+                                                                col_projection_left,
+                                                                &point_previous->binaryDescriptorLeft(),
+                                                                std::max(row_projection_left-tracking_distance_pixels, 0),
+                                                                std::min(row_projection_left+tracking_distance_pixels+1, _number_of_rows_image),
+                                                                std::max(col_projection_left-tracking_distance_pixels, 0),
+                                                                std::min(col_projection_left+tracking_distance_pixels+1, _number_of_cols_image)));
+    indices_query_left[index_point]   = queries_left.size()-1;
+    points_in_image_left[index_point] = point_in_image_left;
+  }
 
-    //ds define search region (rectangular ROI)
-    int32_t row_start_point = std::max(row_projection_left-_projection_tracking_distance_pixels, 0);
-    int32_t row_end_point   = std::min(row_projection_left+_projection_tracking_distance_pixels+1, _number_of_rows_image);
-    int32_t col_start_point = std::max(col_projection_left-_projection_tracking_distance_pixels, 0);
-    int32_t col_end_point   = std::min(col_projection_left+_projection_tracking_distance_pixels+1, _number_of_cols_image);
-
-    //ds find the best match for the previous left feature (i.e. track it)
-    IntensityFeature* feature_left = _feature_matcher_left.getMatchingFeatureInRectangularRegion(row_projection_left,
-                                                                                                 col_projection_left,
-                                                                                                 point_previous->descriptorLeft(),
-                                                                                                 row_start_point,
-                                                                                                 row_end_point,
-                                                                                                 col_start_point,
-                                                                                                 col_end_point,
-                                                                                                 _maximum_descriptor_distance_tracking,
-                                                                                                 track_by_appearance_,
-                                                                                                 descriptor_distance_best);
+  //ds find the best matches for the previous left features on the current feature availability
+  _feature_matcher_left.getMatchingFeaturesInRectangularRegions(queries_left, _maximum_descriptor_distance_tracking, track_by_appearance_, _thread_pool.get());
 
-    //ds if we found a match
-    if (feature_left) {
+  //ds TRIANGULATION: search region in the right image for a left match (returns false if the projection is not in the image plane)
+  //ds the point is projected into the right image and corrected by the left prediction error (i.e. optical flow)
+  auto getQueryRight = [&](const Index& index_point_, const Index& index_feature_left_, IntensityFeatureMatcher::RegionQuery& query_right_) -> bool {
+    const IntensityFeatureMatcher::RegionQuery& query_left = queries_left[indices_query_left[index_point_]];
+    const cv::Point2f& keypoint_left = _feature_matcher_left.keypoints[index_feature_left_].pt;
+    const cv::Point2f projection_error(query_left.col_reference-keypoint_left.x, query_left.row_reference-keypoint_left.y);
+    const Vector3 point_in_image_right(points_in_image_left[index_point_]+_baseline);
+    const int32_t col_projection_right_corrected = point_in_image_right.x()/point_in_image_right.z()+projection_offset.x-projection_error.x;
+    const int32_t row_projection_right_corrected = point_in_image_right.y()/point_in_image_right.z()+projection_offset.y-projection_error.y;
 
-      //ds compute projection offset (i.e. prediction error > optical flow)
-      const cv::Point2f projection_error(col_projection_left-feature_left->keypoint.pt.x, row_projection_left-feature_left->keypoint.pt.y);
+    //ds skip point if not in image plane
+    if (col_projection_right_corrected < 0 || col_projection_right_corrected > _number_of_cols_image ||
+        row_projection_right_corrected < 0 || row_projection_right_corrected > _number_of_rows_image) {
+      return false;
+    }
 
-      //ds project point into the right image - correcting by the prediction error
-      const Vector3 point_in_image_right(point_in_image_left+_baseline);
-      const int32_t col_projection_right_corrected = point_in_image_right.x()/point_in_image_right.z()-projection_error.x;
-      const int32_t row_projection_right_corrected = point_in_image_right.y()/point_in_image_right.z()-projection_error.y;
+    //ds we reduce the vertical matching space to the epipolar range - we search only to the left of the measure left camera coordinate
+    const int32_t epipolar_offset_previous = std::fabs(framepoints_previous[index_point_]->epipolarOffset());
+    query_right_ = IntensityFeatureMatcher::RegionQuery(row_projection_right_corrected,
+                                                        col_projection_right_corrected,
+                                                        &_feature_matcher_left.descriptors[index_feature_left_],
+                                                        std::max(row_projection_right_corrected-epipolar_offset_previous, 0),
+                                                        std::min(row_projection_right_corrected+epipolar_offset_previous+1, _number_of_rows_image),
+                                                        std::max(col_projection_right_corrected-tracking_distance_pixels, 0),
+                                                        std::min(col_projection_right_corrected+tracking_distance_pixels+1, _feature_matcher_left.cols[index_feature_left_]));
+    return true;
+  };
+
+  //ds collect and evaluate the right queries for the left matches
+  std::vector<int32_t> indices_query_right(framepoints_previous.size(), -1);
+  IntensityFeatureMatcher::RegionQueryVector queries_right;
+  queries_right.reserve(queries_left.size());
+  IntensityFeatureMatcher::RegionQuery query_right(0, 0, nullptr, 0, 0, 0, 0);
+  for (Index index_point = 0; index_point < framepoints_previous.size(); ++index_point) {
+    if (indices_query_left[index_point] >= 0 && queries_left[indices_query_left[index_point]].index_best >= 0 &&
+        getQueryRight(index_point, queries_left[indices_query_left[index_point]].index_best, query_right)) {
+      queries_right.push_back(query_right);
+      indices_query_right[index_point] = queries_right.size()-1;
+    }
+  }
 
-      //ds skip point if not in image plane
-      if (col_projection_right_corrected < 0 || col_projection_right_corrected > _number_of_cols_image ||
-          row_projection_right_corrected < 0 || row_projection_right_corrected > _number_of_rows_image) {
-        continue;
-      }
+  //ds we might increase the matching tolerance (maximum_matching_distance_triangulation) since we have a strong prior on location
+  _feature_matcher_right.getMatchingFeaturesInRectangularRegions(queries_right, _current_maximum_descriptor_distance_triangulation, true, _thread_pool.get());
+
+  //ds resolve the matches in point order - features claimed by earlier points are searched again, which yields the sequential result
+  for (Index index_point = 0; index_point < framepoints_previous.size(); ++index_point) {
+    FramePoint* point_previous = framepoints_previous[index_point];
+    if (indices_query_left[index_point] < 0) {
+      continue;
+    }
+    const IntensityFeatureMatcher::RegionQuery& query_left = queries_left[indices_query_left[index_point]];
+
+    //ds obtain the left match (if any)
+    real descriptor_distance_best = _maximum_descriptor_distance_tracking;
+    const int32_t index_feature_left = _feature_matcher_left.getMatchingFeature(query_left, _maximum_descriptor_distance_tracking, track_by_appearance_, descriptor_distance_best);
 
-      //ds TRIANGULATION: obtain matching feature in right image (if any)
-      //ds we reduce the vertical matching space to the epipolar range - we search only to the left of the measure left camera coordinate
-      const int32_t epipolar_offset_previous = std::fabs(point_previous->epipolarOffset());
-      row_start_point = std::max(row_projection_right_corrected-epipolar_offset_previous, 0);
-      row_end_point   = std::min(row_projection_right_corrected+epipolar_offset_previous+1, _number_of_rows_image);
-      col_start_point = std::max(col_projection_right_corrected-_projection_tracking_distance_pixels, 0);
-      col_end_point   = std::min(col_projection_right_corrected+_projection_tracking_distance_pixels+1, feature_left->col);
-
-      //ds we might increase the matching tolerance (maximum_matching_distance_triangulation) since we have a strong prior on location
-      IntensityFeature* feature_right = _feature_matcher_right.getMatchingFeatureInRectangularRegion(row_projection_right_corrected,
-                                                                                                     col_projection_right_corrected,
-                                                                                                     feature_left->descriptor,
-                                                                                                     row_start_point,
-                                                                                                     row_end_point,
-                                                                                                     col_start_point,
-                                                                                                     col_end_point,
-                                                                                                     _current_maximum_descriptor_distance_triangulation,
-                                                                                                     true,
-                                                                                                     descriptor_distance_best);
+    //ds if we found a match
+    if (index_feature_left >= 0) {
+      const IntensityFeature feature_left(_feature_matcher_left.getFeature(index_feature_left));
+
+      //ds obtain the right match (if any) - the batch query is only valid for the same left match
+      int32_t index_feature_right = -1;
+      if (index_feature_left == query_left.index_best) {
+        if (indices_query_right[index_point] < 0) {
+          continue;
+        }
+        query_right = queries_right[indices_query_right[index_point]];
+        index_feature_right = _feature_matcher_right.getMatchingFeature(query_right, _current_maximum_descriptor_distance_triangulation, true, descriptor_distance_best);
+      } else {
+        if (!getQueryRight(index_point, index_feature_left, query_right)) {
+          continue;
+        }
+        index_feature_right = _feature_matcher_right.getMatchingFeatureInRectangularRegion(query_right.row_reference,
+                                                                                           query_right.col_reference,
+                                                                                           *query_right.descriptor_reference,
+                                                                                           query_right.row_start_point,
+                                                                                           query_right.row_end_point,
+                                                                                           query_right.col_start_point,
+                                                                                           query_right.col_end_point,
+                                                                                           _current_maximum_descriptor_distance_triangulation,
+                                                                                           true,
+                                                                                           descriptor_distance_best);
+      }
 
       //ds if we found a match
-      if (feature_right) {
-        assert(feature_left->col >= feature_right->col);
+      if (index_feature_right >= 0) {
+        const IntensityFeature feature_right(_feature_matcher_right.getFeature(index_feature_right));
+        assert(feature_left.col >= feature_right.col);
 
         //ds skip points with insufficient stereo disparity
-        if (feature_left->col-feature_right->col < _parameters->minimum_disparity_pixels) {
+        if (feature_left.col-feature_right.col < _parameters->minimum_disparity_pixels) {
           continue;
         }
 
         //ds skip feature if descriptor distance to previous is violated
-        if (cv::norm(feature_right->descriptor, point_previous->descriptorRight(), SRRG_PROSLAM_DESCRIPTOR_NORM) > _maximum_descriptor_distance_tracking) {
+        if (_descriptor_distance_kernel(feature_right.descriptor, point_previous->binaryDescriptorRight()) > _maximum_descriptor_distance_tracking) {
           continue;
         }
 
         //ds remove remaining matches in parallax between left and right point in the right image
-        for (int32_t col = feature_right->col+1; col < feature_left->col; ++col) {
-          if (_feature_matcher_right.feature_lattice[feature_right->row][col]) {
-            matched_indices_right.insert(_feature_matcher_right.feature_lattice[feature_right->row][col]->index_in_vector);
-            _feature_matcher_right.feature_lattice[feature_right->row][col] = nullptr;
-          }
-        }
+        _feature_matcher_right.setMatchedInRow(feature_right.row, feature_right.col+1, feature_left.col);
 
         //ds create a stereo match
-        FramePoint* framepoint = frame_->createFramepoint(feature_left,
-                                                          feature_right,
+        FramePoint* framepoint = frame_->createFramepoint(&feature_left,
+                                                          &feature_right,
                                                           descriptor_distance_best,
-                                                          getPointInLeftCamera(feature_left->keypoint.pt, feature_right->keypoint.pt),
+                                                          getPointInLeftCamera(feature_left.keypoint.pt, feature_right.keypoint.pt),
                                                           point_previous);
-        framepoint->setEpipolarOffset(feature_right->row-feature_left->row);
+        framepoint->setEpipolarOffset(feature_right.row-feature_left.row);
         accumulated_descriptor_distance += descriptor_distance_best;
 
         //ds VSUALIZATION ONLY
-        framepoint->setProjectionEstimateLeft(cv::Point2f(col_projection_left, row_projection_left));
+        const Vector3 point_in_image_right(points_in_image_left[index_point]+_baseline);
+        framepoint->setProjectionEstimateLeft(cv::Point2f(query_left.col_reference, query_left.row_reference));
         framepoint->setProjectionEstimateRight(cv::Point2f(point_in_image_right.x()/point_in_image_right.z(), point_in_image_right.y()/point_in_image_right.z()));
-        framepoint->setProjectionEstimateRightCorrected(cv::Point2f(col_projection_right_corrected, row_projection_right_corrected));
+        framepoint->setProjectionEstimateRightCorrected(cv::Point2f(query_right.col_reference, query_right.row_reference));
 
         //ds store and move to next slot
         framepoints[number_of_tracked_points] = framepoint;
         ++number_of_tracked_points;
 
         //ds block matching in exhaustive matching (later)
-        matched_indices_left.insert(feature_left->index_in_vector);
-        matched_indices_right.insert(feature_right->index_in_vector);
-        _feature_matcher_left.feature_lattice[feature_left->row][feature_left->col]    = nullptr;
-        _feature_matcher_right.feature_lattice[feature_right->row][feature_right->col] = nullptr;
+        _feature_matcher_left.setMatched(index_feature_left);
+        _feature_matcher_right.setMatched(index_feature_right);
 
         if (point_previous->landmark()) {
           ++_number_of_tracked_landmarks;
@@ -428,15 +536,15 @@ void StereoFramePointGenerator::track(Frame* frame_,
   frame_previous_->setAverageDescriptorDistanceTracking(accumulated_descriptor_distance/number_of_tracked_points);
 
   //ds remove matched indices from candidate pools
-  _feature_matcher_left.prune(matched_indices_left);
-  _feature_matcher_right.prune(matched_indices_right);
+  _feature_matcher_left.prune();
+  _feature_matcher_right.prune();
   LOG_DEBUG(std::cerr << "StereoFramePointGenerator::track|tracked and triangulated points: " << number_of_tracked_points
                       << "/" << framepoints_previous.size() << " (landmarks: " << _number_of_tracked_landmarks << ")" << std::endl)
   LOG_DEBUG(std::cerr << "StereoFramePointGenerator::track|lost points: " << number_of_points_lost
                       << "/" << framepoints_previous.size() << std::endl)
 }
 
-void StereoFramePointGenerator::recoverPoints(Frame* current_frame_, const FramePointPointerVector& lost_points_) const {
+void StereoFramePointGenerator::recoverPoints(Frame* current_frame_, const FramePointPointerVector& lost_points_) {
 
   //ds precompute transforms
   const TransformMatrix3D world_to_camera_left  = current_frame_->worldToCameraLeft();
@@ -526,7 +634,8 @@ void StereoFramePointGenerator::recoverPoints(Frame* current_frame_, const Frame
     keypoint_buffer_left[0].pt += corner_left;
 
     //ds if descriptor distance is to high
-    if (cv::norm(point_previous->descriptorLeft(), descriptor_left, SRRG_PROSLAM_DESCRIPTOR_NORM) > _maximum_descriptor_distance_tracking) {
+    const BinaryDescriptor binary_descriptor_left(descriptor_left);
+    if (_descriptor_distance_kernel(point_previous->binaryDescriptorLeft(), binary_descriptor_left) > _maximum_descriptor_distance_tracking) {
       continue;
     }
 
@@ -555,30 +664,28 @@ void StereoFramePointGenerator::recoverPoints(Frame* current_frame_, const Frame
     }
 
     //ds if descriptor distance is to high
-    if (cv::norm(point_previous->descriptorRight(), descriptor_right, SRRG_PROSLAM_DESCRIPTOR_NORM) > _maximum_descriptor_distance_tracking) {
+    const BinaryDescriptor binary_descriptor_right(descriptor_right);
+    if (_descriptor_distance_kernel(point_previous->binaryDescriptorRight(), binary_descriptor_right) > _maximum_descriptor_distance_tracking) {
       continue;
     }
 
     //ds check stereo triangulation distance
-    const real descriptor_distance_triangulation = cv::norm(descriptor_left, descriptor_right, SRRG_PROSLAM_DESCRIPTOR_NORM);
+    const real descriptor_distance_triangulation = _descriptor_distance_kernel(binary_descriptor_left, binary_descriptor_right);
     if (descriptor_distance_triangulation > _current_maximum_descriptor_distance_triangulation) {
       continue;
     }
 
-    //ds instantiate features (will be owned by the framepoint)
-    IntensityFeature* feature_left  = new IntensityFeature(keypoint_buffer_left[0], descriptor_left, 0);
-    IntensityFeature* feature_right = new IntensityFeature(keypoint_buffer_right[0], descriptor_right, 0);
+    //ds instantiate features (copied by the framepoint)
+    const IntensityFeature feature_left(keypoint_buffer_left[0], binary_descriptor_left, 0);
+    const IntensityFeature feature_right(keypoint_buffer_right[0], binary_descriptor_right, 0);
 
     //ds allocate a new point connected to the previous one
-    FramePoint* current_point = current_frame_->createFramepoint(feature_left,
-                                                                 feature_right,
+    FramePoint* current_point = current_frame_->createFramepoint(&feature_left,
+                                                                 &feature_right,
                                                                  descriptor_distance_triangulation,
                                                                  getPointInLeftCamera(keypoint_buffer_left[0].pt, keypoint_buffer_right[0].pt),
                                                                  point_previous);
 
-    delete feature_left;
-    delete feature_right;
-
     //ds set the point to the control structure
     current_frame_->points()[index_lost_point_recovered] = current_point;
     ++index_lost_point_recovered;
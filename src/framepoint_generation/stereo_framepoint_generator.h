@@ -33,11 +33,21 @@ public:
 
   //! @brief attempts to recover framepoints in the current image using the more precise pose estimate, retrieved after pose optimization
   //! @brief param[in] current_frame_ the affected frame carrying points to be recovered
-  virtual void recoverPoints(Frame* current_frame_, const FramePointPointerVector& lost_points_) const override;
+  virtual void recoverPoints(Frame* current_frame_, const FramePointPointerVector& lost_points_) override;
 
   //ds computes 3D position of a stereo keypoint pair in the keft camera frame
   const PointCoordinates getPointInLeftCamera(const cv::Point2f& image_coordinates_left_, const cv::Point2f& image_coordinates_right_) const;
 
+//ds helpers
+protected:
+
+  //! @brief exhaustive stereo matching over all epipolar offsets for a fixed descriptor size (dispatched once per compute call)
+  //! @param[in,out] frame_ frame for which the new framepoints are created
+  //! @param[out] framepoints_new_ buffer for the new framepoints (sized for all detected keypoints)
+  //! @return number of new framepoints
+  template<uint32_t NUMBER_OF_BITS>
+  const Count _triangulate(Frame* frame_, FramePointPointerVector& framepoints_new_);
+
 //ds setters/getters
 public:
 
@@ -62,8 +72,12 @@ protected:
   //! @brief current epipolar search range
 //  int32_t _maximum_epipolar_search_offset_pixels = 0;
 
-  //! @brief current triangulation distance
-  real _current_maximum_descriptor_distance_triangulation = 0.1*SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS;
+  //! @brief current triangulation distance and its lower bound (10% of the active descriptor size, set in configure)
+  real _current_maximum_descriptor_distance_triangulation = 0;
+  real _minimum_maximum_descriptor_distance_triangulation = 0;
+
+  //! @brief upper bound of the triangulation distance of the parameters, scaled to the active descriptor size in configure
+  real _maximum_matching_distance_triangulation = 0;
 
   //! @brief information only: average triangulation success ratio
   real _mean_triangulation_success_ratio = 1;
@@ -75,6 +89,12 @@ protected:
   //! @brief feature matching class (maintains features in a 2D lattice corresponding to the image and a vector)
   IntensityFeatureMatcher _feature_matcher_right;
 
+  //! @brief dedicated descriptor extractor for the right image (only allocated for enable_parallel_feature_extraction)
+  cv::Ptr<cv::DescriptorExtractor> _descriptor_extractor_right;
+
+  //! @brief persistent two-thread pool processing left and right image in parallel (only allocated for enable_parallel_feature_extraction)
+  ThreadPoolPtr _thread_pool_stereo = nullptr;
+
 private:
 
   //ds informative only
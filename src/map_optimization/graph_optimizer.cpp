@@ -1,4 +1,7 @@
 #include "graph_optimizer.h"
+#include <limits>
+#include <set>
+#include <algorithm>
 #include "g2o/core/robust_kernel_impl.h"
 
 //ds backwards compatibility with g2o
@@ -8,19 +11,33 @@
   linear_solver->setBlockOrdering(true); \
   std::unique_ptr<BLOCK_TYPE_> block_solver = g2o::make_unique<BLOCK_TYPE_>(std::move(linear_solver)); \
   solver = new OPTIMIZATION_ALGORITHM_(std::move(block_solver));
+#define ALLOCATE_SOLVER_CACHED_ORDERING(OPTIMIZATION_ALGORITHM_, SOLVER_TYPE_, BLOCK_TYPE_) \
+  std::unique_ptr<SOLVER_TYPE_> linear_solver = g2o::make_unique<SOLVER_TYPE_>(); \
+  linear_solver->setMaximumRelativeFillIncrease(_parameters->maximum_relative_fill_increase); \
+  _linear_solver_statistics = &linear_solver->statistics(); \
+  std::unique_ptr<BLOCK_TYPE_> block_solver = g2o::make_unique<BLOCK_TYPE_>(std::move(linear_solver)); \
+  solver = new OPTIMIZATION_ALGORITHM_(std::move(block_solver));
 #else
 #define ALLOCATE_SOLVER(OPTIMIZATION_ALGORITHM_, SOLVER_TYPE_, BLOCK_TYPE_) \
   SOLVER_TYPE_* linear_solver = new SOLVER_TYPE_(); \
   linear_solver->setBlockOrdering(true); \
   BLOCK_TYPE_* block_solver = new BLOCK_TYPE_(linear_solver); \
   solver = new OPTIMIZATION_ALGORITHM_(block_solver);
+#define ALLOCATE_SOLVER_CACHED_ORDERING(OPTIMIZATION_ALGORITHM_, SOLVER_TYPE_, BLOCK_TYPE_) \
+  SOLVER_TYPE_* linear_solver = new SOLVER_TYPE_(); \
+  linear_solver->setMaximumRelativeFillIncrease(_parameters->maximum_relative_fill_increase); \
+  _linear_solver_statistics = &linear_solver->statistics(); \
+  BLOCK_TYPE_* block_solver = new BLOCK_TYPE_(linear_solver); \
+  solver = new OPTIMIZATION_ALGORITHM_(block_solver);
 #endif
 
 namespace proslam {
 
 GraphOptimizer::GraphOptimizer(GraphOptimizerParameters* parameters_): _parameters(parameters_),
                                                                        _optimizer(nullptr),
-                                                                       _vertex_local_map_last_added(nullptr) {
+                                                                       _optimizer_coarse(nullptr),
+                                                                       _vertex_local_map_last_added(nullptr),
+                                                                       _identifier_oldest_pending_reference(std::numeric_limits<Identifier>::max()) {
   LOG_INFO(std::cerr << "GraphOptimizer::GraphOptimizer|constructed" << std::endl)
 }
 
@@ -29,6 +46,7 @@ void GraphOptimizer::configure() {
 
   //ds solver setup
   g2o::OptimizationAlgorithm* solver = nullptr;
+  _linear_solver_statistics          = nullptr;
 
   //ds allocate an optimizable graph - depending on chosen parameters
   if (_parameters->optimization_algorithm == "GAUSS_NEWTON" &&
@@ -41,6 +59,11 @@ void GraphOptimizer::configure() {
       !_parameters->enable_full_bundle_adjustment) {
     ALLOCATE_SOLVER(OptimizerGaussNewton, LinearSolverCSparse6x3, BlockSolver6x3)
   }
+  else if (_parameters->optimization_algorithm == "GAUSS_NEWTON" &&
+      _parameters->linear_solver_type == "CACHED_ORDERING" &&
+      !_parameters->enable_full_bundle_adjustment) {
+    ALLOCATE_SOLVER_CACHED_ORDERING(OptimizerGaussNewton, LinearSolverCachedOrdering6x3, BlockSolver6x3)
+  }
 
   else if (_parameters->optimization_algorithm == "GAUSS_NEWTON" &&
       _parameters->linear_solver_type == "CHOLMOD" &&
@@ -52,6 +75,11 @@ void GraphOptimizer::configure() {
       _parameters->enable_full_bundle_adjustment) {
     ALLOCATE_SOLVER(OptimizerGaussNewton, LinearSolverCSparseVariable, BlockSolverVariable)
   }
+  else if (_parameters->optimization_algorithm == "GAUSS_NEWTON" &&
+      _parameters->linear_solver_type == "CACHED_ORDERING" &&
+      _parameters->enable_full_bundle_adjustment) {
+    ALLOCATE_SOLVER_CACHED_ORDERING(OptimizerGaussNewton, LinearSolverCachedOrderingVariable, BlockSolverVariable)
+  }
 
   else if (_parameters->optimization_algorithm == "LEVENBERG" &&
       _parameters->linear_solver_type == "CHOLMOD" &&
@@ -63,6 +91,11 @@ void GraphOptimizer::configure() {
       !_parameters->enable_full_bundle_adjustment) {
     ALLOCATE_SOLVER(OptimizerLevenberg, LinearSolverCSparse6x3, BlockSolver6x3)
   }
+  else if (_parameters->optimization_algorithm == "LEVENBERG" &&
+      _parameters->linear_solver_type == "CACHED_ORDERING" &&
+      !_parameters->enable_full_bundle_adjustment) {
+    ALLOCATE_SOLVER_CACHED_ORDERING(OptimizerLevenberg, LinearSolverCachedOrdering6x3, BlockSolver6x3)
+  }
 
   else if (_parameters->optimization_algorithm == "LEVENBERG" &&
       _parameters->linear_solver_type == "CHOLMOD" &&
@@ -74,6 +107,11 @@ void GraphOptimizer::configure() {
       _parameters->enable_full_bundle_adjustment) {
     ALLOCATE_SOLVER(OptimizerLevenberg, LinearSolverCSparseVariable, BlockSolverVariable)
   }
+  else if (_parameters->optimization_algorithm == "LEVENBERG" &&
+      _parameters->linear_solver_type == "CACHED_ORDERING" &&
+      _parameters->enable_full_bundle_adjustment) {
+    ALLOCATE_SOLVER_CACHED_ORDERING(OptimizerLevenberg, LinearSolverCachedOrderingVariable, BlockSolverVariable)
+  }
 
   //ds if we couldn't allocate a solver
   if (!solver) {
@@ -89,11 +127,31 @@ void GraphOptimizer::configure() {
   //ds set the solver
   _optimizer->setAlgorithm(solver);
 
+  //ds allocate the graph of segments for hierarchical pose graph optimization (deleting a previous one)
+  if (_optimizer_coarse) {delete _optimizer_coarse;}
+  _optimizer_coarse = nullptr;
+  if (_parameters->number_of_local_maps_per_segment > 0 && !_parameters->enable_full_bundle_adjustment) {
+    g2o::OptimizationAlgorithm* solver = nullptr;
+    ALLOCATE_SOLVER(OptimizerGaussNewton, LinearSolverCSparse6x3, BlockSolver6x3)
+    _optimizer_coarse = new g2o::SparseOptimizer();
+    _optimizer_coarse->setAlgorithm(solver);
+    _optimizer_coarse->setVerbose(false);
+  }
+
   //ds clean bookkeeping
   _vertex_local_map_last_added = 0;
   _frames_in_pose_graph.clear();
+  _frames_in_window.clear();
   _local_maps_in_graph.clear();
   _landmarks_in_pose_graph.clear();
+  _identifier_oldest_pending_reference = std::numeric_limits<Identifier>::max();
+  _identifier_begin_optimized_region   = 0;
+  _is_structure_reusable               = false;
+  _vertices_pending.clear();
+  _edges_pending.clear();
+  _closures_pending.clear();
+  _is_flat_solution_outdated           = false;
+  _moved_local_maps.clear();
 
   //ds clean pose graph
   _optimizer->clear();
@@ -112,11 +170,21 @@ GraphOptimizer::~GraphOptimizer(){
   LOG_INFO(std::cerr << "GraphOptimizer::~GraphOptimizer|destroying" << std::endl)
   _frames_in_pose_graph.clear();
   _landmarks_in_pose_graph.clear();
+  if (_linear_solver_statistics) {
+    LOG_INFO(std::cerr << "GraphOptimizer::~GraphOptimizer|linear solver analyses (full/reused ordering/reused pattern): "
+                       << _linear_solver_statistics->number_of_full_analyses << "/"
+                       << _linear_solver_statistics->number_of_reused_orderings << "/"
+                       << _linear_solver_statistics->number_of_reused_analyses << std::endl)
+  }
   if (_optimizer) {
     _optimizer->clear();
     _optimizer->clearParameters();
     delete _optimizer;
   }
+  if (_optimizer_coarse) {
+    _optimizer_coarse->clear();
+    delete _optimizer_coarse;
+  }
   LOG_INFO(std::cerr << "GraphOptimizer::~GraphOptimizer|destroyed" << std::endl)
 }
 
@@ -228,6 +296,7 @@ void GraphOptimizer::addPose(LocalMap* local_map_) {
   vertex_current->setId(local_map_->identifier());
   vertex_current->setEstimate(local_map_->robotToWorld().cast<double>());
   _optimizer->addVertex(vertex_current);
+  _vertices_pending.insert(vertex_current);
 
   //ds if its the first frame to be added (start or recently cleared pose graph)
   if (!_vertex_local_map_last_added) {
@@ -241,11 +310,11 @@ void GraphOptimizer::addPose(LocalMap* local_map_) {
     real information_factor = _parameters->base_information_frame;
 
     //ds we can connect it to the preceeding frame by adding the odometry measurement
-    _setPoseEdge(_optimizer,
-                vertex_current,
-                _vertex_local_map_last_added,
-                world_to_local_map_previous*local_map_->robotToWorld(),
-                information_factor);
+    _edges_pending.insert(_setPoseEdge(_optimizer,
+                                       vertex_current,
+                                       _vertex_local_map_last_added,
+                                       world_to_local_map_previous*local_map_->robotToWorld(),
+                                       information_factor));
   }
 
   //ds if the local map has not been checked in a previous frame
@@ -255,24 +324,24 @@ void GraphOptimizer::addPose(LocalMap* local_map_) {
   _local_maps_in_graph.insert(std::make_pair(local_map_->identifier(), local_map_));
 
   //ds for all loop closures on this local map
-  for (const Closure::ClosureConstraint& closure: local_map_->closures()) {
-
-    //ds compute information value (closure edges weight much more than pose edges to be able to deform the graph properly)
-    const real information_factor = _parameters->base_information_frame*closure.omega*10;
-
-    //ds retrieve reference frame (must be present)
-    g2o::VertexSE3* vertex_reference = dynamic_cast<g2o::VertexSE3*>(_optimizer->vertex(closure.local_map->identifier()));
-    assert(vertex_reference);
-
-    //ds introduce loop closure constraint between the two local maps
-    _setPoseEdge(_optimizer, vertex_current, vertex_reference, closure.relation, information_factor);
-  }
+  _addLoopClosureEdges(vertex_current, local_map_);
 
   //ds bookkeep the added frame
   _vertex_local_map_last_added = vertex_current;
   CHRONOMETER_STOP(addition)
 }
 
+void GraphOptimizer::addLoopClosures(LocalMap* local_map_) {
+  CHRONOMETER_START(addition)
+  assert(_local_maps_in_graph.find(local_map_->identifier()) != _local_maps_in_graph.end());
+
+  //ds retrieve query vertex (must be present)
+  g2o::VertexSE3* vertex_query = dynamic_cast<g2o::VertexSE3*>(_optimizer->vertex(local_map_->identifier()));
+  assert(vertex_query);
+  _addLoopClosureEdges(vertex_query, local_map_);
+  CHRONOMETER_STOP(addition)
+}
+
 void GraphOptimizer::addPoseWithFactors(Frame* frame_) {
   CHRONOMETER_START(addition)
 
@@ -281,6 +350,7 @@ void GraphOptimizer::addPoseWithFactors(Frame* frame_) {
   vertex_frame_current->setId(frame_->identifier());
   vertex_frame_current->setEstimate(frame_->robotToWorld().cast<double>());
   _optimizer->addVertex(vertex_frame_current);
+  _vertices_pending.insert(vertex_frame_current);
 
   //ds if its the first frame to be added (start or recently cleared pose graph)
   if (!_vertex_local_map_last_added) {
@@ -294,24 +364,25 @@ void GraphOptimizer::addPoseWithFactors(Frame* frame_) {
         g2o::VertexPointXYZ* vertex_landmark = 0;
 
         //ds check if the landmark not yet present in the graph
-        if (_landmarks_in_pose_graph.find(landmark) == _landmarks_in_pose_graph.end()) {
+        if (_landmarks_in_pose_graph.find(landmark->identifier()) == _landmarks_in_pose_graph.end()) {
 
           //ds allocate a new point vertex and add it to the graph
           vertex_landmark = new g2o::VertexPointXYZ( );
           vertex_landmark->setEstimate(landmark->coordinates().cast<double>());
           vertex_landmark->setId(landmark->identifier()+_parameters->identifier_space);
           _optimizer->addVertex(vertex_landmark);
+          _vertices_pending.insert(vertex_landmark);
 
           //ds bookkeep the landmark
-          _landmarks_in_pose_graph.insert(std::make_pair(landmark, vertex_landmark));
+          _landmarks_in_pose_graph.insert(std::make_pair(landmark->identifier(), vertex_landmark));
         } else {
 
           //ds retrieve existing vertex using our bookkeeping container
-          vertex_landmark = _landmarks_in_pose_graph[landmark];
+          vertex_landmark = _landmarks_in_pose_graph[landmark->identifier()];
         }
 
         //ds add framepoint position as measurement for the landmark - porting weight from previous optimization
-        _setPointEdge(_optimizer, vertex_frame_current, vertex_landmark, framepoint->robotCoordinates(), landmark->numberOfUpdates()/framepoint->depthMeters());
+        _edges_pending.insert(_setPointEdge(_optimizer, vertex_frame_current, vertex_landmark, framepoint->robotCoordinates(), landmark->numberOfUpdates()/framepoint->depthMeters()));
       }
     }
 
@@ -328,57 +399,150 @@ void GraphOptimizer::addPoseWithFactors(Frame* frame_) {
         g2o::VertexPointXYZ* vertex_landmark = 0;
 
         //ds check if the landmark not yet present in the graph
-        if (_landmarks_in_pose_graph.find(landmark) == _landmarks_in_pose_graph.end()) {
+        if (_landmarks_in_pose_graph.find(landmark->identifier()) == _landmarks_in_pose_graph.end()) {
 
           //ds allocate a new point vertex and add it to the graph
           vertex_landmark = new g2o::VertexPointXYZ( );
           vertex_landmark->setEstimate(landmark->coordinates().cast<double>());
           vertex_landmark->setId(landmark->identifier()+_parameters->identifier_space);
           _optimizer->addVertex(vertex_landmark);
+          _vertices_pending.insert(vertex_landmark);
 
           //ds bookkeep the landmark
-          _landmarks_in_pose_graph.insert(std::make_pair(landmark, vertex_landmark));
+          _landmarks_in_pose_graph.insert(std::make_pair(landmark->identifier(), vertex_landmark));
         } else {
 
           //ds retrieve existing vertex using our bookkeeping container
-          vertex_landmark = _landmarks_in_pose_graph[landmark];
+          vertex_landmark = _landmarks_in_pose_graph[landmark->identifier()];
         }
 
         //ds add framepoint position as measurement for the landmark
-        _setPointEdge(_optimizer, vertex_frame_current, vertex_landmark, framepoint->robotCoordinates(), 1/framepoint->depthMeters());
+        _edges_pending.insert(_setPointEdge(_optimizer, vertex_frame_current, vertex_landmark, framepoint->robotCoordinates(), 1/framepoint->depthMeters()));
       }
     }
 
     //ds we can connect it to the preceeding frame by adding the odometry measurement
-    _setPoseEdge(_optimizer,
-                vertex_frame_current,
-                _vertex_local_map_last_added,
-                frame_->previous()->worldToRobot()*frame_->robotToWorld(),
-                _parameters->base_information_frame);
+    _edges_pending.insert(_setPoseEdge(_optimizer,
+                                       vertex_frame_current,
+                                       _vertex_local_map_last_added,
+                                       frame_->previous()->worldToRobot()*frame_->robotToWorld(),
+                                       _parameters->base_information_frame));
   }
 
   //ds bookkeep the added frame
   _vertex_local_map_last_added = vertex_frame_current;
   _frames_in_pose_graph.insert(std::make_pair(frame_, vertex_frame_current));
+  _frames_in_window.push_back(std::make_pair(frame_, vertex_frame_current));
   CHRONOMETER_STOP(addition)
 }
 
-void GraphOptimizer::optimizePoseGraph(WorldMap* world_map_) {
+void GraphOptimizer::optimizePoseGraph(WorldMap* world_map_, const bool& flat_) {
+  solvePoseGraph(flat_);
+  updatePoseGraph(world_map_);
+}
+
+void GraphOptimizer::solvePoseGraph(const bool& flat_) {
   CHRONOMETER_START(optimization)
 
 //  //ds save current graph to file
 //  const std::string file_name = "pose_graph_"+std::to_string(world_map_->currentFrame()->identifier())+".g2o";
 //  _optimizer->save(file_name.c_str());
 
+  //ds hierarchical optimization for new closures
+  if (!flat_ && _optimizer_coarse && !_closures_pending.empty()) {
+    _solvePoseGraphHierarchical();
+    _identifier_oldest_pending_reference = std::numeric_limits<Identifier>::max();
+    _vertices_pending.clear();
+    _edges_pending.clear();
+    CHRONOMETER_STOP(optimization)
+    return;
+  }
+  _closures_pending.clear();
+  _is_flat_solution_outdated = false;
+
+  //ds determine the region affected by the closures added since the last optimization (incremental mode only)
+  _identifier_begin_optimized_region = 0;
+  if (!flat_ && _parameters->enable_incremental_optimization && _identifier_oldest_pending_reference != std::numeric_limits<Identifier>::max()) {
+    _identifier_begin_optimized_region = _identifier_oldest_pending_reference;
+
+    //ds expand the region until no closure of a contained local map references a local map in front of it
+    for (std::map<const Identifier, LocalMap*>::const_reverse_iterator iterator = _local_maps_in_graph.rbegin();
+         iterator != _local_maps_in_graph.rend() && iterator->first >= _identifier_begin_optimized_region; ++iterator) {
+      for (const Closure::ClosureConstraint& closure: iterator->second->closures()) {
+        _identifier_begin_optimized_region = std::min(_identifier_begin_optimized_region, closure.local_map->identifier());
+      }
+    }
+
+    //ds the complete graph is affected if the region reaches the origin
+    if (_local_maps_in_graph.empty() || _identifier_begin_optimized_region <= _local_maps_in_graph.begin()->first) {
+      _identifier_begin_optimized_region = 0;
+    }
+  }
+  _identifier_oldest_pending_reference = std::numeric_limits<Identifier>::max();
+  g2o::HyperGraph::VertexSet vertices_pending;
+  g2o::HyperGraph::EdgeSet edges_pending;
+  _vertices_pending.swap(vertices_pending);
+  _edges_pending.swap(edges_pending);
+
   //ds optimize graph
-  _optimizer->initializeOptimization();
-  _optimizer->optimize(_parameters->maximum_number_of_iterations);
+  if (_identifier_begin_optimized_region == 0) {
+
+    //ds with a cached ordering we extend the previous structure by the added vertices and edges (the solver decides on a full analysis)
+    if (_is_structure_reusable && _parameters->linear_solver_type == "CACHED_ORDERING") {
+      _optimizer->updateInitialization(vertices_pending, edges_pending);
+      _optimizer->optimize(_parameters->maximum_number_of_iterations, true);
+    } else {
+      _optimizer->initializeOptimization();
+      _optimizer->optimize(_parameters->maximum_number_of_iterations);
+    }
+    _is_structure_reusable = true;
+  } else {
+
+    //ds collect all measurements of the local maps in the region
+    g2o::HyperGraph::EdgeSet edges_in_region;
+    for (std::map<const Identifier, LocalMap*>::const_iterator iterator = _local_maps_in_graph.lower_bound(_identifier_begin_optimized_region);
+         iterator != _local_maps_in_graph.end(); ++iterator) {
+      const g2o::HyperGraph::EdgeSet& edges = _optimizer->vertex(iterator->first)->edges();
+      edges_in_region.insert(edges.begin(), edges.end());
+    }
+
+    //ds local maps outside of the region that are connected to it (by construction only the predecessor) anchor the solution
+    std::vector<g2o::OptimizableGraph::Vertex*> vertices_anchor;
+    for (g2o::HyperGraph::Edge* edge: edges_in_region) {
+      for (g2o::HyperGraph::Vertex* vertex: edge->vertices()) {
+        g2o::OptimizableGraph::Vertex* vertex_optimizable = static_cast<g2o::OptimizableGraph::Vertex*>(vertex);
+        if (static_cast<Identifier>(vertex->id()) < _identifier_begin_optimized_region && !vertex_optimizable->fixed()) {
+          vertex_optimizable->setFixed(true);
+          vertices_anchor.push_back(vertex_optimizable);
+        }
+      }
+    }
+
+    //ds optimize the region only (the structure of the complete graph has to be rebuilt for the next full optimization)
+    _optimizer->initializeOptimization(edges_in_region);
+    _is_structure_reusable = false;
+    _optimizer->optimize(_parameters->maximum_number_of_iterations);
+    for (g2o::OptimizableGraph::Vertex* vertex: vertices_anchor) {
+      vertex->setFixed(false);
+    }
+    LOG_INFO(std::cerr << "GraphOptimizer::solvePoseGraph|optimized region: [" << _identifier_begin_optimized_region << ", "
+                       << _local_maps_in_graph.rbegin()->first << "] (edges: " << edges_in_region.size() << ")" << std::endl)
+  }
+  CHRONOMETER_STOP(optimization)
+}
 
-  //ds directly backpropagate solution to frames and landmarks of local maps
+void GraphOptimizer::updatePoseGraph(WorldMap* world_map_) {
+  CHRONOMETER_START(optimization)
+
+  //ds directly backpropagate solution to frames and landmarks of local maps (of the optimized region)
   Count number_of_negligible_updates = 0;
-  for (const std::pair<const Identifier, LocalMap*>& local_map_entry: _local_maps_in_graph) {
-    LocalMap* local_map                = local_map_entry.second;
-    g2o::VertexSE3* local_map_in_graph = dynamic_cast<g2o::VertexSE3*>(_optimizer->vertex(local_map_entry.first));
+  Count number_of_considered_updates = 0;
+  _moved_local_maps.clear();
+  for (std::map<const Identifier, LocalMap*>::const_iterator iterator = _local_maps_in_graph.lower_bound(_identifier_begin_optimized_region);
+       iterator != _local_maps_in_graph.end(); ++iterator) {
+    ++number_of_considered_updates;
+    LocalMap* local_map                = iterator->second;
+    g2o::VertexSE3* local_map_in_graph = dynamic_cast<g2o::VertexSE3*>(_optimizer->vertex(iterator->first));
     assert(local_map && local_map_in_graph);
     const TransformMatrix3D robot_to_world_optimized = local_map_in_graph->estimate().cast<real>();
 
@@ -390,15 +554,16 @@ void GraphOptimizer::optimizePoseGraph(WorldMap* world_map_) {
       continue;
     }
 
-    //ds update local map pose with optimized estimate (will automatically update contained frames and landmarks)
-    local_map->setRobotToWorld(robot_to_world_optimized, true);
+    //ds update local map pose with optimized estimate (will automatically update contained frames, landmarks are updated by the world map)
+    local_map->setRobotToWorld(robot_to_world_optimized);
+    _moved_local_maps.push_back(local_map);
 
     //ds unlock the vertex for the next optimization
     local_map_in_graph->setFixed(false);
   }
   LOG_INFO(std::cerr << "GraphOptimizer::optimizePoseGraph|negligible pose backpropagations: "
-                     << number_of_negligible_updates << "/" << _local_maps_in_graph.size()
-                     << " (" << static_cast<real>(number_of_negligible_updates)/_local_maps_in_graph.size() << ")" << std::endl)
+                     << number_of_negligible_updates << "/" << number_of_considered_updates
+                     << " (moved local maps: " << _moved_local_maps.size() << "/" << _local_maps_in_graph.size() << ")" << std::endl)
 
   //ds keep map origin locked (by construction the first frame added to the bookkeeping)
   _optimizer->vertex(0)->setFixed(true);
@@ -416,6 +581,33 @@ void GraphOptimizer::optimizeFactorGraph(WorldMap* world_map_) {
 //  const std::string file_name = "pose_graph_"+std::to_string(world_map_->currentFrame()->identifier())+".g2o";
 //  _optimizer->save(file_name.c_str());
 
+  //ds landmarks freed by the world map since their addition (merged or archived) are removed together with their measurements
+  const LandmarkPointerMap& landmarks = world_map_->landmarks();
+  std::map<Identifier, g2o::VertexPointXYZ*>::iterator iterator = _landmarks_in_pose_graph.begin();
+  while (iterator != _landmarks_in_pose_graph.end()) {
+    if (landmarks.find(iterator->first) == landmarks.end()) {
+      _optimizer->removeVertex(iterator->second);
+      iterator = _landmarks_in_pose_graph.erase(iterator);
+    } else {
+      ++iterator;
+    }
+  }
+
+  //ds with a sliding window: keyframes in front of the window are kept fixed as anchors, starting from the current map estimates
+  //ds the oldest keyframe is always fixed to constrain the gauge (also without anchors)
+  const bool is_windowed = (_parameters->number_of_keyframes_in_window > 0);
+  if (is_windowed) {
+    for (Index u = 0; u < _frames_in_window.size(); ++u) {
+      _frames_in_window[u].second->setEstimate(_frames_in_window[u].first->robotToWorld().cast<double>());
+      if (u == 0 || u+_parameters->number_of_keyframes_in_window < _frames_in_window.size()) {
+        _frames_in_window[u].second->setFixed(true);
+      }
+    }
+    for(std::pair<const Identifier, g2o::VertexPointXYZ*>& landmark_in_pose_graph: _landmarks_in_pose_graph) {
+      landmark_in_pose_graph.second->setEstimate(landmarks.at(landmark_in_pose_graph.first)->coordinates().cast<double>());
+    }
+  }
+
   //ds optimize graph
   _optimizer->initializeOptimization();
   _optimizer->optimize(_parameters->maximum_number_of_iterations);
@@ -424,25 +616,192 @@ void GraphOptimizer::optimizeFactorGraph(WorldMap* world_map_) {
   for(std::pair<Frame*, g2o::VertexSE3*> frame_in_pose_graph: _frames_in_pose_graph) {
     frame_in_pose_graph.first->setRobotToWorld(frame_in_pose_graph.second->estimate().cast<real>());
   }
-  for(std::pair<Landmark*, g2o::VertexPointXYZ*> landmark_in_pose_graph: _landmarks_in_pose_graph) {
-    landmark_in_pose_graph.first->setCoordinates(landmark_in_pose_graph.second->estimate().cast<real>());
+  for(std::pair<const Identifier, g2o::VertexPointXYZ*>& landmark_in_pose_graph: _landmarks_in_pose_graph) {
+    landmarks.at(landmark_in_pose_graph.first)->setCoordinates(landmark_in_pose_graph.second->estimate().cast<real>());
   }
   world_map_->setRobotToWorld(world_map_->currentFrame()->robotToWorld());
   ++_number_of_optimizations;
 
-  //ds reset graph for next optimization
-  _optimizer->clear();
-  _vertex_local_map_last_added = 0;
-  _frames_in_pose_graph.clear();
-  _landmarks_in_pose_graph.clear();
+  //ds remove the states that left the window and its anchors (the graph is kept for the next optimization)
+  if (is_windowed) {
+    while (_frames_in_window.size() > _parameters->number_of_keyframes_in_window+_parameters->number_of_anchor_keyframes) {
+      _frames_in_pose_graph.erase(_frames_in_window.front().first);
+      _optimizer->removeVertex(_frames_in_window.front().second);
+      _frames_in_window.pop_front();
+    }
+
+    //ds landmarks without remaining measurements are removed as well
+    iterator = _landmarks_in_pose_graph.begin();
+    while (iterator != _landmarks_in_pose_graph.end()) {
+      if (iterator->second->edges().empty()) {
+        _optimizer->removeVertex(iterator->second);
+        iterator = _landmarks_in_pose_graph.erase(iterator);
+      } else {
+        ++iterator;
+      }
+    }
+  } else {
+
+    //ds reset graph for next optimization
+    _optimizer->clear();
+    _vertex_local_map_last_added = 0;
+    _frames_in_pose_graph.clear();
+    _frames_in_window.clear();
+    _landmarks_in_pose_graph.clear();
+  }
+
+  //ds the graph structure was rebuilt (and vertices removed or cleared) - the next pose graph optimization has to start from scratch
+  _is_structure_reusable = false;
+  _vertices_pending.clear();
+  _edges_pending.clear();
   CHRONOMETER_STOP(optimization)
 }
 
-void GraphOptimizer::_setPoseEdge(g2o::OptimizableGraph* optimizer_,
-                                  g2o::VertexSE3* vertex_from_,
-                                  g2o::VertexSE3* vertex_to_,
-                                  const TransformMatrix3D& transform_from_to_,
-                                  const real& information_factor_) const {
+const bool GraphOptimizer::isFactorGraphOptimizationDue(const Frame* keyframe_) const {
+
+  //ds with a sliding window we optimize at every keyframe (at constant cost), otherwise periodically (frame identifiers start at 0)
+  return (_parameters->number_of_keyframes_in_window > 0 ||
+          (keyframe_->identifier()+1) % _parameters->number_of_frames_per_bundle_adjustment == 0);
+}
+
+void GraphOptimizer::_solvePoseGraphHierarchical() {
+
+  //ds local maps in order of addition - segment k holds the local maps [k*size, (k+1)*size), its first local map is the anchor
+  const Count number_of_local_maps_per_segment = _parameters->number_of_local_maps_per_segment;
+  std::vector<Identifier> identifiers;
+  std::vector<g2o::VertexSE3*> vertices;
+  identifiers.reserve(_local_maps_in_graph.size());
+  vertices.reserve(_local_maps_in_graph.size());
+  for (const std::pair<const Identifier, LocalMap*>& local_map: _local_maps_in_graph) {
+    identifiers.push_back(local_map.first);
+    vertices.push_back(static_cast<g2o::VertexSE3*>(_optimizer->vertex(local_map.first)));
+  }
+  const Count number_of_segments = (vertices.size()+number_of_local_maps_per_segment-1)/number_of_local_maps_per_segment;
+  auto getPosition = [&identifiers](const Identifier& identifier_) -> Index {
+    return std::lower_bound(identifiers.begin(), identifiers.end(), identifier_)-identifiers.begin();
+  };
+
+  //ds build the graph of segments: consecutive segments are connected by their current relative pose (summary of the local maps in between)
+  _optimizer_coarse->clear();
+  std::vector<TransformMatrix3D, Eigen::aligned_allocator<TransformMatrix3D>> anchors_to_world(number_of_segments);
+  for (Index k = 0; k < number_of_segments; ++k) {
+    anchors_to_world[k] = vertices[k*number_of_local_maps_per_segment]->estimate().cast<real>();
+    g2o::VertexSE3* vertex_segment = new g2o::VertexSE3();
+    vertex_segment->setId(k);
+    vertex_segment->setEstimate(anchors_to_world[k].cast<double>());
+    vertex_segment->setFixed(k == 0);
+    _optimizer_coarse->addVertex(vertex_segment);
+    if (k > 0) {
+      _setPoseEdge(_optimizer_coarse,
+                   vertex_segment,
+                   static_cast<g2o::VertexSE3*>(_optimizer_coarse->vertex(k-1)),
+                   anchors_to_world[k-1].inverse()*anchors_to_world[k],
+                   _parameters->base_information_frame/number_of_local_maps_per_segment);
+    }
+  }
+
+  //ds closures between segments are expressed relative to the segment anchors (closures within a segment are covered by the refinement)
+  for (Index position_query = 0; position_query < identifiers.size(); ++position_query) {
+    const Index segment_query = position_query/number_of_local_maps_per_segment;
+    for (const Closure::ClosureConstraint& closure: _local_maps_in_graph.at(identifiers[position_query])->closures()) {
+      const Index position_reference = getPosition(closure.local_map->identifier());
+      const Index segment_reference  = position_reference/number_of_local_maps_per_segment;
+      if (segment_reference == segment_query) {
+        continue;
+      }
+      const TransformMatrix3D query_to_anchor     = anchors_to_world[segment_query].inverse()*vertices[position_query]->estimate().cast<real>();
+      const TransformMatrix3D reference_to_anchor = anchors_to_world[segment_reference].inverse()*vertices[position_reference]->estimate().cast<real>();
+      _setPoseEdge(_optimizer_coarse,
+                   static_cast<g2o::VertexSE3*>(_optimizer_coarse->vertex(segment_query)),
+                   static_cast<g2o::VertexSE3*>(_optimizer_coarse->vertex(segment_reference)),
+                   reference_to_anchor*closure.relation*query_to_anchor.inverse(),
+                   _parameters->base_information_frame*closure.omega*10);
+    }
+  }
+  _optimizer_coarse->initializeOptimization();
+  _optimizer_coarse->optimize(_parameters->maximum_number_of_iterations);
+
+  //ds move the local maps of each corrected segment rigidly with its anchor
+  Index position_begin = vertices.size();
+  for (Index k = 0; k < number_of_segments; ++k) {
+    const TransformMatrix3D anchor_to_world_optimized = static_cast<g2o::VertexSE3*>(_optimizer_coarse->vertex(k))->estimate().cast<real>();
+    if ((anchor_to_world_optimized.matrix()-anchors_to_world[k].matrix()).norm() < _parameters->minimum_estimation_delta_for_update_meters) {
+      continue;
+    }
+    const TransformMatrix3D correction = anchor_to_world_optimized*anchors_to_world[k].inverse();
+    for (Index position = k*number_of_local_maps_per_segment; position < std::min((k+1)*number_of_local_maps_per_segment, static_cast<Index>(vertices.size())); ++position) {
+      vertices[position]->setEstimate((correction*vertices[position]->estimate().cast<real>()).cast<double>());
+    }
+    position_begin = std::min(position_begin, k*number_of_local_maps_per_segment);
+  }
+
+  //ds refine the segments containing the pending closures on the graph of local maps (their neighbors anchor the solution)
+  std::set<Index> segments_to_refine;
+  for (const std::pair<Identifier, Identifier>& closure: _closures_pending) {
+    segments_to_refine.insert(getPosition(closure.first)/number_of_local_maps_per_segment);
+    segments_to_refine.insert(getPosition(closure.second)/number_of_local_maps_per_segment);
+  }
+  std::set<g2o::OptimizableGraph::Vertex*> vertices_to_refine;
+  g2o::HyperGraph::EdgeSet edges_to_refine;
+  for (const Index& k: segments_to_refine) {
+    for (Index position = k*number_of_local_maps_per_segment; position < std::min((k+1)*number_of_local_maps_per_segment, static_cast<Index>(vertices.size())); ++position) {
+      vertices_to_refine.insert(vertices[position]);
+      edges_to_refine.insert(vertices[position]->edges().begin(), vertices[position]->edges().end());
+    }
+    position_begin = std::min(position_begin, k*number_of_local_maps_per_segment);
+  }
+  std::vector<g2o::OptimizableGraph::Vertex*> vertices_anchor;
+  for (g2o::HyperGraph::Edge* edge: edges_to_refine) {
+    for (g2o::HyperGraph::Vertex* vertex: edge->vertices()) {
+      g2o::OptimizableGraph::Vertex* vertex_optimizable = static_cast<g2o::OptimizableGraph::Vertex*>(vertex);
+      if (vertices_to_refine.count(vertex_optimizable) == 0 && !vertex_optimizable->fixed()) {
+        vertex_optimizable->setFixed(true);
+        vertices_anchor.push_back(vertex_optimizable);
+      }
+    }
+  }
+  _optimizer->initializeOptimization(edges_to_refine);
+  _optimizer->optimize(_parameters->maximum_number_of_iterations);
+  for (g2o::OptimizableGraph::Vertex* vertex: vertices_anchor) {
+    vertex->setFixed(false);
+  }
+
+  //ds report the changed part of the graph for updatePoseGraph (the structure of the complete graph has to be rebuilt for the next full optimization)
+  _identifier_begin_optimized_region = (position_begin > 0) ? identifiers[position_begin] : 0;
+  _is_structure_reusable             = false;
+  _is_flat_solution_outdated         = true;
+  LOG_INFO(std::cerr << "GraphOptimizer::_solvePoseGraphHierarchical|closures: " << _closures_pending.size()
+                     << " segments: " << number_of_segments << " refined segments: " << segments_to_refine.size()
+                     << " (local maps: " << vertices_to_refine.size() << "/" << vertices.size() << ")" << std::endl)
+  _closures_pending.clear();
+}
+
+void GraphOptimizer::_addLoopClosureEdges(g2o::VertexSE3* vertex_query_, const LocalMap* local_map_) {
+  for (const Closure::ClosureConstraint& closure: local_map_->closures()) {
+
+    //ds bookkeep the oldest reference for the next (incremental) optimization and the closure for the next hierarchical optimization
+    _identifier_oldest_pending_reference = std::min(_identifier_oldest_pending_reference, closure.local_map->identifier());
+    if (_optimizer_coarse) {
+      _closures_pending.push_back(std::make_pair(local_map_->identifier(), closure.local_map->identifier()));
+    }
+
+    //ds compute information value (closure edges weight much more than pose edges to be able to deform the graph properly)
+    const real information_factor = _parameters->base_information_frame*closure.omega*10;
+
+    //ds retrieve reference frame (must be present)
+    g2o::VertexSE3* vertex_reference = dynamic_cast<g2o::VertexSE3*>(_optimizer->vertex(closure.local_map->identifier()));
+    assert(vertex_reference);
+
+    //ds introduce loop closure constraint between the two local maps
+    _edges_pending.insert(_setPoseEdge(_optimizer, vertex_query_, vertex_reference, closure.relation, information_factor));
+  }
+}
+
+g2o::EdgeSE3* GraphOptimizer::_setPoseEdge(g2o::OptimizableGraph* optimizer_,
+                                           g2o::VertexSE3* vertex_from_,
+                                           g2o::VertexSE3* vertex_to_,
+                                           const TransformMatrix3D& transform_from_to_,
+                                           const real& information_factor_) const {
   g2o::EdgeSE3* edge_pose = new g2o::EdgeSE3();
   edge_pose->setVertex(1, vertex_from_);
   edge_pose->setVertex(0, vertex_to_);
@@ -456,13 +815,14 @@ void GraphOptimizer::_setPoseEdge(g2o::OptimizableGraph* optimizer_,
   edge_pose->setInformation(information.cast<double>());
   if (_parameters->enable_robust_kernel_for_poses) {edge_pose->setRobustKernel(new g2o::RobustKernelCauchy());}
   optimizer_->addEdge(edge_pose);
+  return edge_pose;
 }
 
-void GraphOptimizer::_setPointEdge(g2o::OptimizableGraph* optimizer_,
-                                   g2o::VertexSE3* vertex_frame_,
-                                   g2o::VertexPointXYZ* vertex_landmark_,
-                                   const PointCoordinates& framepoint_robot_coordinates,
-                                   const real& information_factor_) const {
+g2o::EdgeSE3PointXYZ* GraphOptimizer::_setPointEdge(g2o::OptimizableGraph* optimizer_,
+                                                    g2o::VertexSE3* vertex_frame_,
+                                                    g2o::VertexPointXYZ* vertex_landmark_,
+                                                    const PointCoordinates& framepoint_robot_coordinates,
+                                                    const real& information_factor_) const {
   g2o::EdgeSE3PointXYZ* landmark_edge = new g2o::EdgeSE3PointXYZ();
 
   //ds set 3d point measurement
@@ -474,5 +834,6 @@ void GraphOptimizer::_setPointEdge(g2o::OptimizableGraph* optimizer_,
   landmark_edge->setParameterId(0, G2oParameter::WORLD_OFFSET);
   if (_parameters->enable_robust_kernel_for_landmarks) {landmark_edge->setRobustKernel(new g2o::RobustKernelCauchy());}
   optimizer_->addEdge(landmark_edge);
+  return landmark_edge;
 }
 }
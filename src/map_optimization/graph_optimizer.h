@@ -8,10 +8,13 @@
 #include "g2o/core/optimization_algorithm_factory.h"
 #include "g2o/solvers/csparse/linear_solver_csparse.h"
 #include "g2o/solvers/cholmod/linear_solver_cholmod.h"
+#include "linear_solver_cached_ordering.h"
 #include "g2o/types/slam3d/types_slam3d.h"
 #include "g2o/core/optimization_algorithm_gauss_newton.h"
 #include "g2o/core/optimization_algorithm_levenberg.h"
 
+#include <deque>
+
 //ds proslam
 #include "types/world_map.h"
 #include "relocalization/closure.h"
@@ -33,6 +36,8 @@ public:
   typedef g2o::LinearSolverCholmod<BlockSolverVariable::PoseMatrixType> LinearSolverCholmodVariable;
   typedef g2o::LinearSolverCSparse<BlockSolver6x3::PoseMatrixType> LinearSolverCSparse6x3;
   typedef g2o::LinearSolverCholmod<BlockSolver6x3::PoseMatrixType> LinearSolverCholmod6x3;
+  typedef LinearSolverCachedOrdering<BlockSolverVariable::PoseMatrixType> LinearSolverCachedOrderingVariable;
+  typedef LinearSolverCachedOrdering<BlockSolver6x3::PoseMatrixType> LinearSolverCachedOrdering6x3;
 
   //ds available optimization algorithm
   typedef g2o::OptimizationAlgorithmGaussNewton OptimizerGaussNewton;
@@ -61,37 +66,73 @@ public:
   //! @param[in] frame_ the local map to add to the graph
   void addPose(LocalMap* frame_);
 
+  //! @brief adds the loop closure constraints of a local map that is already part of the pose graph
+  //! @param[in] local_map_ the local map (query) for which closures have been found after its addition
+  void addLoopClosures(LocalMap* local_map_);
+
   //! @brief adds a new frame to the factor graph with all connected landmarks
   //! @param[in] frame_ the frame to add including its captured landmarks
   void addPoseWithFactors(Frame* frame_);
 
-  //! @brief triggers an adjustment of poses only
+  //! @brief triggers an adjustment of poses only (equivalent to solvePoseGraph followed by updatePoseGraph)
+  //! @param[in] world_map_ map in which the optimization takes place
+  //! @param[in] flat_ optimize the complete graph of local maps, regardless of incremental or hierarchical optimization
+  void optimizePoseGraph(WorldMap* world_map_, const bool& flat_ = false);
+
+  //! @brief optimizes the current pose graph without modifying any map element
+  //! @brief the map can be accessed concurrently, as long as no poses are added to the graph
+  //! @brief with incremental optimization only the region affected by the closures added since the last call is optimized
+  //! @brief with hierarchical optimization the closures are solved on the graph of segments first, followed by a refinement of the closure segments
+  //! @param[in] flat_ optimize the complete graph of local maps, regardless of incremental or hierarchical optimization
+  void solvePoseGraph(const bool& flat_ = false);
+
+  //! @brief backpropagates the last pose graph solution to the local maps (including their frames)
+  //! @brief only local maps of the optimized region are considered, the ones that moved are reported by movedLocalMaps
+  //! @brief the landmarks of the moved local maps are not updated (see WorldMap::stageLandmarkCoordinates)
   //! @param[in] world_map_ map in which the optimization takes place
-  void optimizePoseGraph(WorldMap* world_map_);
+  void updatePoseGraph(WorldMap* world_map_);
 
   //! @brief triggers a full bundle adjustment optimization of the current factor graph
+  //! @brief with a sliding window only the most recent keyframes are optimized and older states are removed from the graph
   //! @param[in] world_map_ map in which the optimization takes place
   void optimizeFactorGraph(WorldMap* world_map_);
 
+  //! @brief checks whether the factor graph is to be optimized after adding the provided keyframe
+  //! @param[in] keyframe_ the last keyframe added with addPoseWithFactors
+  const bool isFactorGraphOptimizationDue(const Frame* keyframe_) const;
+
 //ds getters/setters
 public:
 
   const Count numberOfOptimizations() const {return _number_of_optimizations;}
 
+  //! @brief set if the last pose graph optimization was hierarchical, i.e. the poses within segments are not optimal (flat optimization required)
+  const bool isFlatSolutionOutdated() const {return _is_flat_solution_outdated;}
+
+  //! @brief local maps whose pose has been changed by the last updatePoseGraph call
+  const LocalMapPointerVector& movedLocalMaps() const {return _moved_local_maps;}
+
 //ds g2o wrapper functions
 protected:
 
-  void _setPoseEdge(g2o::OptimizableGraph* optimizer_,
-                    g2o::VertexSE3* vertex_from_,
-                    g2o::VertexSE3* vertex_to_,
-                    const TransformMatrix3D& transform_from_to_,
-                    const real& information_factor_) const;
+  //! @brief hierarchical optimization: solves the graph of segments (consecutive local maps condensed into super-nodes) for the pending closures,
+  //! @brief moves the segments rigidly to the solution and refines the segments containing the pending closures on the graph of local maps
+  void _solvePoseGraphHierarchical();
+
+  //! @brief connects the query vertex to the vertices of all local maps that are referenced by the closures of the local map
+  void _addLoopClosureEdges(g2o::VertexSE3* vertex_query_, const LocalMap* local_map_);
 
-  void _setPointEdge(g2o::OptimizableGraph* optimizer_,
-                     g2o::VertexSE3* vertex_frame_,
-                     g2o::VertexPointXYZ* vertex_landmark_,
-                     const PointCoordinates& framepoint_robot_coordinates,
-                     const real& information_factor_) const;
+  g2o::EdgeSE3* _setPoseEdge(g2o::OptimizableGraph* optimizer_,
+                             g2o::VertexSE3* vertex_from_,
+                             g2o::VertexSE3* vertex_to_,
+                             const TransformMatrix3D& transform_from_to_,
+                             const real& information_factor_) const;
+
+  g2o::EdgeSE3PointXYZ* _setPointEdge(g2o::OptimizableGraph* optimizer_,
+                                      g2o::VertexSE3* vertex_frame_,
+                                      g2o::VertexPointXYZ* vertex_landmark_,
+                                      const PointCoordinates& framepoint_robot_coordinates,
+                                      const real& information_factor_) const;
 
 //ds attributes
 protected:
@@ -99,17 +140,48 @@ protected:
   //! @brief g2o optimizer (holding the pose graph)
   g2o::SparseOptimizer* _optimizer;
 
+  //! @brief g2o optimizer holding the graph of segments (hierarchical optimization only)
+  g2o::SparseOptimizer* _optimizer_coarse;
+
+  //! @brief statistics of the linear solver owned by _optimizer (CACHED_ORDERING only, informative)
+  const LinearSolverCachedOrderingStatistics* _linear_solver_statistics = nullptr;
+
   //! @brief last frame vertex added (to be locked for optimization)
   g2o::VertexSE3* _vertex_local_map_last_added;
 
   //! @brief bookkeeping: added frames
   std::map<Frame*, g2o::VertexSE3*> _frames_in_pose_graph;
 
+  //! @brief bookkeeping: added frames in order of addition (sliding window bundle adjustment)
+  std::deque<std::pair<Frame*, g2o::VertexSE3*>> _frames_in_window;
+
   //! @brief bookkeeping: added local maps
   std::map<const Identifier, LocalMap*> _local_maps_in_graph;
 
-  //! @brief bookkeeping: added landmarks
-  std::map<Landmark*, g2o::VertexPointXYZ*> _landmarks_in_pose_graph;
+  //! @brief bookkeeping: added landmarks (by identifier, the world map might free landmarks while they are in the graph)
+  std::map<Identifier, g2o::VertexPointXYZ*> _landmarks_in_pose_graph;
+
+  //! @brief oldest local map referenced by a closure that has not been optimized yet (incremental optimization)
+  Identifier _identifier_oldest_pending_reference;
+
+  //! @brief first local map of the region optimized by the last solvePoseGraph call (0: complete graph)
+  Identifier _identifier_begin_optimized_region = 0;
+
+  //! @brief set if the last pose graph optimization was initialized on the complete graph (its structure can be extended)
+  bool _is_structure_reusable = false;
+
+  //! @brief vertices and edges added to the pose graph since the last optimization (structure update)
+  g2o::HyperGraph::VertexSet _vertices_pending;
+  g2o::HyperGraph::EdgeSet _edges_pending;
+
+  //! @brief closures (query, reference local map) added to the pose graph since the last optimization (hierarchical optimization)
+  std::vector<std::pair<Identifier, Identifier>> _closures_pending;
+
+  //! @brief set if the last pose graph optimization was hierarchical
+  bool _is_flat_solution_outdated = false;
+
+  //! @brief local maps moved by the last updatePoseGraph call
+  LocalMapPointerVector _moved_local_maps;
 
   //ds informative only
   CREATE_CHRONOMETER(addition)
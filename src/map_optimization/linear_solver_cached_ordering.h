@@ -0,0 +1,203 @@
+#pragma once
+#include <vector>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+#include <Eigen/OrderingMethods>
+#include "g2o/core/linear_solver.h"
+
+namespace proslam {
+
+//! @struct usage statistics of a cached ordering solver, independent of the block type (informative only)
+struct LinearSolverCachedOrderingStatistics {
+  uint64_t number_of_full_analyses    = 0; //ds AMD ordering and symbolic factorization
+  uint64_t number_of_reused_orderings = 0; //ds extended ordering and symbolic factorization (system grew)
+  uint64_t number_of_reused_analyses  = 0; //ds numeric factorization only (unchanged pattern)
+};
+
+//! @class sparse LDLT linear solver for g2o that keeps its fill-reducing (AMD) ordering across solves
+//! @brief if the system only grew by appending rows and columns since the last solve (e.g. pose graph with new local maps and closures),
+//! @brief the cached ordering is extended by the new indices instead of recomputing it - a full analysis is triggered once the fill
+//! @brief (non-zeros of the factor per row) exceeds the fill of the last full analysis by more than the configured ratio
+//! @brief if the pattern did not change at all (e.g. iterations of one optimization) only the numeric factorization is computed
+template<typename MatrixType_>
+class LinearSolverCachedOrdering: public g2o::LinearSolver<MatrixType_> {
+
+//ds exported types
+public:
+
+  typedef Eigen::SparseMatrix<double, Eigen::ColMajor> SparseMatrix;
+  typedef Eigen::SimplicialLDLT<SparseMatrix, Eigen::Upper, Eigen::NaturalOrdering<int>> CholeskyDecomposition;
+  typedef Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, int> Permutation;
+
+//ds object handling
+public:
+
+  LinearSolverCachedOrdering(): g2o::LinearSolver<MatrixType_>() {}
+  virtual ~LinearSolverCachedOrdering() {}
+
+//ds g2o interface
+public:
+
+  //! @brief called by g2o for every (re-)initialization of the optimization - the cached ordering is validated in solve
+  virtual bool init() {
+    return true;
+  }
+
+  //! @brief solves A*x = b, with A given by its upper triangle blocks
+  virtual bool solve(const g2o::SparseBlockMatrix<MatrixType_>& A_, double* x_, double* b_) {
+    _fillUpperTriangle(A_);
+    return solve(_matrix, x_, b_);
+  }
+
+  //! @brief the ordering is computed on the scalar pattern, block ordering is not used (interface compatibility)
+  void setBlockOrdering(bool /*block_ordering_*/) {}
+
+//ds functionality
+public:
+
+  //! @brief solves A*x = b for a symmetric matrix A given by its upper triangle
+  bool solve(const SparseMatrix& matrix_upper_, double* x_, double* b_) {
+    const int dimension = matrix_upper_.cols();
+
+    //ds keep the symbolic factorization if the pattern is unchanged, reuse the cached ordering if the previous pattern
+    //ds is the leading block of the current one, otherwise compute AMD
+    const bool is_pattern_extension = _is_ordering_valid && _isPatternExtension(matrix_upper_);
+    const bool is_pattern_unchanged = is_pattern_extension &&
+                                      dimension == _permutation.size() &&
+                                      matrix_upper_.nonZeros() == static_cast<int>(_inner_indices.size());
+    if (is_pattern_unchanged) {
+      ++_statistics.number_of_reused_analyses;
+    } else if (is_pattern_extension) {
+      Permutation permutation_inverse(dimension);
+      for (int index = 0; index < dimension; ++index) {
+        permutation_inverse.indices()(index) = (index < _permutation_inverse.size()) ? _permutation_inverse.indices()(index) : index;
+      }
+      _permutation_inverse = permutation_inverse;
+      _permutation         = _permutation_inverse.inverse();
+      ++_statistics.number_of_reused_orderings;
+    } else {
+      Eigen::AMDOrdering<int> ordering;
+      ordering(matrix_upper_.template selfadjointView<Eigen::Upper>(), _permutation_inverse);
+      _permutation          = _permutation_inverse.inverse();
+      _fill_ratio_reference = 0;
+      ++_statistics.number_of_full_analyses;
+    }
+
+    //ds permute the system (same pattern as before if unchanged)
+    _matrix_permuted.resize(dimension, dimension);
+    _matrix_permuted.template selfadjointView<Eigen::Upper>() = matrix_upper_.template selfadjointView<Eigen::Upper>().twistedBy(_permutation);
+
+    //ds symbolic factorization (elimination tree, O(non-zeros)) only for a new pattern, numeric factorization always
+    if (!is_pattern_unchanged) {
+      _cacheSparsityPattern(matrix_upper_);
+      _cholesky.analyzePattern(_matrix_permuted);
+    }
+    _cholesky.factorize(_matrix_permuted);
+    if (_cholesky.info() != Eigen::Success) {
+      _is_ordering_valid = false;
+      return false;
+    }
+
+    //ds track the fill of the factor: a large increase invalidates the ordering for the next solve
+    const double fill_ratio = static_cast<double>(_cholesky.matrixL().nestedExpression().nonZeros())/dimension;
+    if (_fill_ratio_reference == 0) {
+      _fill_ratio_reference = fill_ratio;
+    }
+    _is_ordering_valid = (fill_ratio <= (1+_maximum_relative_fill_increase)*_fill_ratio_reference);
+
+    //ds solve in the permuted space
+    Eigen::Map<const Eigen::VectorXd> b(b_, dimension);
+    Eigen::Map<Eigen::VectorXd> x(x_, dimension);
+    x = _permutation_inverse*_cholesky.solve(_permutation*b);
+    return true;
+  }
+
+//ds getters/setters
+public:
+
+  void setMaximumRelativeFillIncrease(const double& maximum_relative_fill_increase_) {_maximum_relative_fill_increase = maximum_relative_fill_increase_;}
+  const LinearSolverCachedOrderingStatistics& statistics() const {return _statistics;}
+
+//ds helpers
+protected:
+
+  //! @brief converts the upper triangle of the block matrix into a scalar sparse matrix
+  void _fillUpperTriangle(const g2o::SparseBlockMatrix<MatrixType_>& A_) {
+    _triplets.clear();
+    for (size_t block_col = 0; block_col < A_.blockCols().size(); ++block_col) {
+      const int col_base = A_.colBaseOfBlock(block_col);
+      for (const auto& block: A_.blockCols()[block_col]) {
+        const int row_base      = A_.rowBaseOfBlock(block.first);
+        const MatrixType_& data = *(block.second);
+        for (int col = 0; col < data.cols(); ++col) {
+          for (int row = 0; row < data.rows() && row_base+row <= col_base+col; ++row) {
+            _triplets.push_back(Eigen::Triplet<double>(row_base+row, col_base+col, data(row, col)));
+          }
+        }
+      }
+    }
+    _matrix.resize(A_.rows(), A_.cols());
+    _matrix.setFromTriplets(_triplets.begin(), _triplets.end());
+  }
+
+  //! @brief checks if the cached pattern is identical to the leading block of the provided one (with no new entries in its columns)
+  const bool _isPatternExtension(const SparseMatrix& matrix_upper_) const {
+    const int dimension_cached = _outer_indices.empty() ? 0 : _outer_indices.size()-1;
+    if (dimension_cached == 0 || matrix_upper_.cols() < dimension_cached || !matrix_upper_.isCompressed()) {
+      return false;
+    }
+
+    //ds in the upper triangle the leading columns only contain leading rows - they have to match exactly
+    const int* outer_indices = matrix_upper_.outerIndexPtr();
+    const int* inner_indices = matrix_upper_.innerIndexPtr();
+    for (int col = 0; col <= dimension_cached; ++col) {
+      if (outer_indices[col] != _outer_indices[col]) {
+        return false;
+      }
+    }
+    for (int index = 0; index < _outer_indices[dimension_cached]; ++index) {
+      if (inner_indices[index] != _inner_indices[index]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  //! @brief stores the pattern of the provided matrix for the next pattern check
+  void _cacheSparsityPattern(const SparseMatrix& matrix_upper_) {
+    _outer_indices.assign(matrix_upper_.outerIndexPtr(), matrix_upper_.outerIndexPtr()+matrix_upper_.cols()+1);
+    _inner_indices.assign(matrix_upper_.innerIndexPtr(), matrix_upper_.innerIndexPtr()+matrix_upper_.nonZeros());
+  }
+
+//ds attributes
+protected:
+
+  //! @brief current system (upper triangle) and its permuted version
+  SparseMatrix _matrix;
+  SparseMatrix _matrix_permuted;
+  std::vector<Eigen::Triplet<double>> _triplets;
+
+  //! @brief fill-reducing ordering: permuted index = _permutation(index)
+  Permutation _permutation;
+  Permutation _permutation_inverse;
+
+  //! @brief pattern of the last solved system (compressed column storage)
+  std::vector<int> _outer_indices;
+  std::vector<int> _inner_indices;
+
+  //! @brief factorization of the permuted system
+  CholeskyDecomposition _cholesky;
+
+  //! @brief set if the cached ordering can be extended for the next solve
+  bool _is_ordering_valid = false;
+
+  //! @brief factor non-zeros per row after the last full analysis
+  double _fill_ratio_reference = 0;
+
+  //! @brief maximum relative increase of the fill before a full analysis is triggered
+  double _maximum_relative_fill_increase = 0.5;
+
+  //ds informative only
+  LinearSolverCachedOrderingStatistics _statistics;
+};
+}
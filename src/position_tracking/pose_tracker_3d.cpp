@@ -1,10 +1,167 @@
 #include "pose_tracker_3d.h"
+
+#include <numeric>
 #include "aligners/stereouv_aligner.h"
 
 namespace proslam {
 using namespace srrg_core;
 
-PoseTracker3D::PoseTracker3D(PoseTracker3DParameters* parameters_): _parameters(parameters_) {
+namespace {
+
+//ds real roots of the quartic sum_i coefficients_[i]*x^i (Ferrari's method with Newton refinement), returns the number of roots
+Count solveQuartic(const real* coefficients_, real* roots_) {
+
+  //ds normalize and reduce to depressed quartic y^4+p*y^2+q*y+r (x = y-a/4)
+  const real a = coefficients_[3]/coefficients_[4];
+  const real b = coefficients_[2]/coefficients_[4];
+  const real c = coefficients_[1]/coefficients_[4];
+  const real d = coefficients_[0]/coefficients_[4];
+  const real a_squared = a*a;
+  const real p = b-3*a_squared/8;
+  const real q = c-a*b/2+a_squared*a/8;
+  const real r = d-a*c/4+a_squared*b/16-3*a_squared*a_squared/256;
+
+  //ds collect the roots of the two quadratic factors
+  real roots[4];
+  Count number_of_roots = 0;
+  auto addQuadraticRoots = [&](const real& linear_, const real& constant_) {
+    real discriminant = linear_*linear_-4*constant_;
+    if (discriminant < -1e-12) {
+      return;
+    }
+    discriminant = std::sqrt(std::max(discriminant, 0.0));
+    roots[number_of_roots++] = (-linear_+discriminant)/2;
+    roots[number_of_roots++] = (-linear_-discriminant)/2;
+  };
+  if (std::fabs(q) < 1e-12) {
+
+    //ds biquadratic: solve for y^2
+    real discriminant = p*p-4*r;
+    if (discriminant >= 0) {
+      discriminant = std::sqrt(discriminant);
+      for (const real y_squared: {(-p+discriminant)/2, (-p-discriminant)/2}) {
+        if (y_squared >= 0) {
+          roots[number_of_roots++] = std::sqrt(y_squared);
+          roots[number_of_roots++] = -std::sqrt(y_squared);
+        }
+      }
+    }
+  } else {
+
+    //ds largest (positive) root m of the resolvent cubic m^3+p*m^2+(p^2/4-r)*m-q^2/8
+    const real A = p;
+    const real B = p*p/4-r;
+    const real C = -q*q/8;
+    const real P = B-A*A/3;
+    const real Q = 2*A*A*A/27-A*B/3+C;
+    const real discriminant = Q*Q/4+P*P*P/27;
+    real m = 0;
+    if (discriminant > 0) {
+      const real root_discriminant = std::sqrt(discriminant);
+      m = std::cbrt(-Q/2+root_discriminant)+std::cbrt(-Q/2-root_discriminant)-A/3;
+    } else if (std::fabs(P) < 1e-12) {
+
+      //ds degenerate (P = Q = 0): triple root of the depressed cubic t^3+Q
+      m = std::cbrt(-Q)-A/3;
+    } else {
+      const real argument = std::min(std::max(3*Q/(2*P)*std::sqrt(-3/P), -1.0), 1.0);
+      m = 2*std::sqrt(-P/3)*std::cos(std::acos(argument)/3)-A/3;
+    }
+    if (m <= 0) {
+      return 0;
+    }
+
+    //ds factorize into two quadratics
+    const real s = std::sqrt(2*m);
+    addQuadraticRoots(-s, p/2+m+q/(2*s));
+    addQuadraticRoots(s, p/2+m-q/(2*s));
+  }
+
+  //ds undo the substitution and refine
+  for (Index u = 0; u < number_of_roots; ++u) {
+    real x = roots[u]-a/4;
+    for (Count iteration = 0; iteration < 2; ++iteration) {
+      const real value      = (((x+a)*x+b)*x+c)*x+d;
+      const real derivative = ((4*x+3*a)*x+2*b)*x+c;
+      if (std::fabs(derivative) > 1e-12) {
+        x -= value/derivative;
+      }
+    }
+    roots_[u] = x;
+  }
+  return number_of_roots;
+}
+
+//ds P3P solver (Grunert's quartic, see Haralick et al. 1994): computes up to 4 transforms mapping points_ onto the rays of bearings_ (unit vectors)
+Count solveP3P(const Vector3* bearings_, const PointCoordinates* points_, TransformMatrix3D* solutions_) {
+
+  //ds squared side lengths of the triangle and cosines of the angles between the rays
+  const real a_squared = (points_[1]-points_[2]).squaredNorm();
+  const real b_squared = (points_[0]-points_[2]).squaredNorm();
+  const real c_squared = (points_[0]-points_[1]).squaredNorm();
+  if (a_squared < 1e-6 || b_squared < 1e-6 || c_squared < 1e-6) {
+    return 0;
+  }
+  const real cos_alpha = bearings_[1].dot(bearings_[2]);
+  const real cos_beta  = bearings_[0].dot(bearings_[2]);
+  const real cos_gamma = bearings_[0].dot(bearings_[1]);
+  const real cos_alpha_squared = cos_alpha*cos_alpha;
+  const real cos_beta_squared  = cos_beta*cos_beta;
+  const real cos_gamma_squared = cos_gamma*cos_gamma;
+
+  //ds quartic coefficients in v = s3/s1
+  const real p = (a_squared-c_squared)/b_squared;
+  const real q = (a_squared+c_squared)/b_squared;
+  const real coefficients[5] = {(1+p)*(1+p)-4*a_squared/b_squared*cos_gamma_squared,
+                                4*(-p*(1+p)*cos_beta+2*a_squared/b_squared*cos_gamma_squared*cos_beta-(1-q)*cos_alpha*cos_gamma),
+                                2*(p*p-1+2*p*p*cos_beta_squared+2*(b_squared-c_squared)/b_squared*cos_alpha_squared
+                                   -4*q*cos_alpha*cos_beta*cos_gamma+2*(b_squared-a_squared)/b_squared*cos_gamma_squared),
+                                4*(p*(1-p)*cos_beta-(1-q)*cos_alpha*cos_gamma+2*c_squared/b_squared*cos_alpha_squared*cos_beta),
+                                (p-1)*(p-1)-4*c_squared/b_squared*cos_alpha_squared};
+  if (std::fabs(coefficients[4]) < 1e-12) {
+    return 0;
+  }
+
+  //ds real roots of the quartic
+  real roots[4];
+  const Count number_of_roots = solveQuartic(coefficients, roots);
+  Count number_of_solutions = 0;
+  for (Index u = 0; u < number_of_roots; ++u) {
+    const real v = roots[u];
+    if (v <= 0) {
+      continue;
+    }
+
+    //ds recover the distances along the rays
+    const real denominator = 2*(cos_gamma-v*cos_alpha);
+    if (std::fabs(denominator) < 1e-12) {
+      continue;
+    }
+    const real u_ratio = ((p-1)*v*v-2*p*cos_beta*v+1+p)/denominator;
+    const real divisor = 1+u_ratio*u_ratio-2*u_ratio*cos_gamma;
+    if (u_ratio <= 0 || divisor <= 0) {
+      continue;
+    }
+    const real s1 = std::sqrt(c_squared/divisor);
+
+    //ds absolute orientation from the three point pairs
+    Matrix3 points_source;
+    Matrix3 points_target;
+    for (Index i = 0; i < 3; ++i) {
+      points_source.col(i) = points_[i];
+    }
+    points_target.col(0) = s1*bearings_[0];
+    points_target.col(1) = u_ratio*s1*bearings_[1];
+    points_target.col(2) = v*s1*bearings_[2];
+    solutions_[number_of_solutions].matrix() = Eigen::umeyama(points_source, points_target, false);
+    ++number_of_solutions;
+  }
+  return number_of_solutions;
+}
+}
+
+PoseTracker3D::PoseTracker3D(PoseTracker3DParameters* parameters_): _parameters(parameters_),
+                                                                     _random_number_generator(0) {
   LOG_INFO(std::cerr << "PoseTracker3D::PoseTracker3D|constructed" << std::endl)
 }
 
@@ -16,7 +173,7 @@ void PoseTracker3D::configure() {
 
   //ds initial setup: maximal tracking window with minimal descriptor distance tolerance
   _projection_tracking_distance_pixels  = _framepoint_generator->parameters()->maximum_projection_tracking_distance_pixels;
-  _current_descriptor_distance_tracking = _framepoint_generator->parameters()->minimum_descriptor_distance_tracking;
+  _current_descriptor_distance_tracking = _framepoint_generator->minimumDescriptorDistanceTracking();
   LOG_INFO(std::cerr << "PoseTracker3D::configure|configured" << std::endl)
 }
 
@@ -259,18 +416,18 @@ void PoseTracker3D::_track(Frame* previous_frame_,
       (landmark_per_point < 0.5 && tracking_success_ratio < 0.25)) {
 
     //ds be less restrictive in tracking
-    _current_descriptor_distance_tracking += 5;
-    if (_current_descriptor_distance_tracking > _framepoint_generator->parameters()->maximum_descriptor_distance_tracking) {
-      _current_descriptor_distance_tracking = _framepoint_generator->parameters()->maximum_descriptor_distance_tracking;
+    _current_descriptor_distance_tracking += getScaledDescriptorDistance(5);
+    if (_current_descriptor_distance_tracking > _framepoint_generator->maximumDescriptorDistanceTracking()) {
+      _current_descriptor_distance_tracking = _framepoint_generator->maximumDescriptorDistanceTracking();
     }
 
   //ds if we have a sufficiently high tracking ratio
   } else {
 
     //ds be more restrictive in tracking
-    _current_descriptor_distance_tracking -= 5;
-    if (_current_descriptor_distance_tracking < _framepoint_generator->parameters()->minimum_descriptor_distance_tracking) {
-      _current_descriptor_distance_tracking = _framepoint_generator->parameters()->minimum_descriptor_distance_tracking;
+    _current_descriptor_distance_tracking -= getScaledDescriptorDistance(5);
+    if (_current_descriptor_distance_tracking < _framepoint_generator->minimumDescriptorDistanceTracking()) {
+      _current_descriptor_distance_tracking = _framepoint_generator->minimumDescriptorDistanceTracking();
     }
   }
 
@@ -293,40 +450,50 @@ void PoseTracker3D::_registerRecursive(Frame* previous_frame_,
   real relative_number_of_tracked_landmarks_to_previous = static_cast<real>(_number_of_tracked_landmarks)/_number_of_tracked_landmarks_previous;
 
   //ds if we got not enough tracks to evaluate for position tracking: robustness
+  bool is_ransac_initialized = false;
   if (_number_of_tracked_landmarks == 0 || relative_number_of_tracked_landmarks_to_previous < 0.1) {
-    ++_number_of_recursive_registrations;
 
-    //ds if we have recursions left (currently only two)
-    if (recursion_ < 2) {
+    //ds the remaining tracks might still suffice for a minimal solver hypothesis - attempt it before relaxing the tracking
+    TransformMatrix3D previous_to_current_hypothesis(TransformMatrix3D::Identity());
+    if (_parameters->enable_ransac_initialization && _estimateMotionRansac(current_frame_, previous_to_current_hypothesis)) {
+      ++_number_of_ransac_initializations;
+      _previous_to_current_camera = previous_to_current_hypothesis;
+      is_ransac_initialized       = true;
+    } else {
+      ++_number_of_recursive_registrations;
 
-      //ds fallback to no motion model if no external info is available
-      if (_parameters->motion_model != Parameters::MotionModel::CAMERA_ODOMETRY) {
-        _previous_to_current_camera.setIdentity();
+      //ds if we have recursions left (currently only two)
+      if (recursion_ < 2) {
 
-        //ds attempt tracking by appearance (maximum window size)
-        _framepoint_generator->initialize(current_frame_, false);
-        _track(previous_frame_, current_frame_, true);
-        _registerRecursive(previous_frame_, current_frame_, recursion_+1);
-      } else {
-
-        //ds stick to odometry guess
-        const TransformMatrix3D camera_left_to_world = previous_frame_->cameraLeftToWorld()*_previous_to_current_camera.inverse();
-        current_frame_->setRobotToWorld(camera_left_to_world*_camera_left->robotToCamera());
-      }
-      return;
-    } else {
+        //ds fallback to no motion model if no external info is available
+        if (_parameters->motion_model != Parameters::MotionModel::CAMERA_ODOMETRY) {
+          _previous_to_current_camera.setIdentity();
 
-      //ds if we have some information about the camera pose (e.g. odometry)
-      if (_parameters->motion_model == Parameters::MotionModel::CAMERA_ODOMETRY) {
+          //ds attempt tracking by appearance (maximum window size)
+          _framepoint_generator->initialize(current_frame_, false);
+          _track(previous_frame_, current_frame_, true);
+          _registerRecursive(previous_frame_, current_frame_, recursion_+1);
+        } else {
 
-        //ds use fallback estimate
-        _fallbackEstimate(current_frame_, previous_frame_);
+          //ds stick to odometry guess
+          const TransformMatrix3D camera_left_to_world = previous_frame_->cameraLeftToWorld()*_previous_to_current_camera.inverse();
+          current_frame_->setRobotToWorld(camera_left_to_world*_camera_left->robotToCamera());
+        }
+        return;
       } else {
 
-        //ds failed
-        breakTrack(current_frame_);
+        //ds if we have some information about the camera pose (e.g. odometry)
+        if (_parameters->motion_model == Parameters::MotionModel::CAMERA_ODOMETRY) {
+
+          //ds use fallback estimate
+          _fallbackEstimate(current_frame_, previous_frame_);
+        } else {
+
+          //ds failed
+          breakTrack(current_frame_);
+        }
+        return;
       }
-      return;
     }
   }
 
@@ -344,6 +511,18 @@ void PoseTracker3D::_registerRecursive(Frame* previous_frame_,
   _pose_optimizer->converge();
   CHRONOMETER_STOP(pose_optimization)
 
+  //ds if the motion guess did not lead to an acceptable solution - attempt to seed the aligner with a minimal solver hypothesis
+  if (_parameters->enable_ransac_initialization && !is_ransac_initialized && _pose_optimizer->numberOfInliers() <= _parameters->minimum_number_of_landmarks_to_track) {
+    TransformMatrix3D previous_to_current_hypothesis(TransformMatrix3D::Identity());
+    if (_estimateMotionRansac(current_frame_, previous_to_current_hypothesis)) {
+      ++_number_of_ransac_initializations;
+      CHRONOMETER_START(pose_optimization)
+      _pose_optimizer->initialize(previous_frame_, current_frame_, previous_to_current_hypothesis);
+      _pose_optimizer->converge();
+      CHRONOMETER_STOP(pose_optimization)
+    }
+  }
+
   //ds solver deltas
   const Count number_of_inliers = _pose_optimizer->numberOfInliers();
 
@@ -405,6 +584,102 @@ void PoseTracker3D::_registerRecursive(Frame* previous_frame_,
   }
 }
 
+bool PoseTracker3D::_estimateMotionRansac(const Frame* current_frame_, TransformMatrix3D& previous_to_current_) {
+  CHRONOMETER_START(pose_initialization)
+
+  //ds collect correspondences: 3D coordinates in the previous camera frame to 2D keypoints in the current image
+  const Matrix3& camera_matrix        = _camera_left->cameraMatrix();
+  const Matrix3 inverse_camera_matrix = camera_matrix.inverse();
+  const Count number_of_correspondences = current_frame_->points().size();
+  _ransac_points_previous.resize(number_of_correspondences);
+  _ransac_bearings.resize(number_of_correspondences);
+  _ransac_image_coordinates.resize(number_of_correspondences);
+  _ransac_order.resize(number_of_correspondences);
+  for (Index u = 0; u < number_of_correspondences; ++u) {
+    const FramePoint* frame_point = current_frame_->points()[u];
+    const FramePoint* previous    = frame_point->previous();
+    assert(previous);
+
+    //ds prefer the landmark estimate if available (as in the aligner)
+    _ransac_points_previous[u]   = (previous->landmark()) ? previous->cameraCoordinatesLeftLandmark() : previous->cameraCoordinatesLeft();
+    _ransac_image_coordinates[u] = ImageCoordinates(frame_point->keypointLeft().pt.x, frame_point->keypointLeft().pt.y, 1);
+    _ransac_bearings[u]          = (inverse_camera_matrix*_ransac_image_coordinates[u]).normalized();
+    _ransac_order[u]             = u;
+  }
+  if (number_of_correspondences <= std::max(_parameters->minimum_number_of_landmarks_to_track, Count(3))) {
+    CHRONOMETER_STOP(pose_initialization)
+    return false;
+  }
+
+  //ds generate hypotheses from random minimal samples (each sample yields up to 4 solutions)
+  _ransac_hypotheses.clear();
+  std::uniform_int_distribution<Index> sampler(0, number_of_correspondences-1);
+  for (Count number_of_samples = 0; number_of_samples < _parameters->number_of_ransac_samples; ++number_of_samples) {
+    Index indices[3] = {sampler(_random_number_generator), sampler(_random_number_generator), sampler(_random_number_generator)};
+    if (indices[0] == indices[1] || indices[0] == indices[2] || indices[1] == indices[2]) {
+      continue;
+    }
+    const PointCoordinates points[3] = {_ransac_points_previous[indices[0]], _ransac_points_previous[indices[1]], _ransac_points_previous[indices[2]]};
+    const Vector3 bearings[3]        = {_ransac_bearings[indices[0]], _ransac_bearings[indices[1]], _ransac_bearings[indices[2]]};
+    TransformMatrix3D solutions[4];
+    const Count number_of_solutions = solveP3P(bearings, points, solutions);
+    _ransac_hypotheses.insert(_ransac_hypotheses.end(), solutions, solutions+number_of_solutions);
+  }
+  if (_ransac_hypotheses.empty()) {
+    CHRONOMETER_STOP(pose_initialization)
+    return false;
+  }
+
+  //ds inlier check for a hypothesis and a correspondence (reprojection error in the left image)
+  const real maximum_error_squared = _parameters->maximum_ransac_reprojection_error_pixels*_parameters->maximum_ransac_reprojection_error_pixels;
+  auto isInlier = [&](const TransformMatrix3D& hypothesis_, const Index& index_) -> bool {
+    const PointCoordinates point_in_camera = hypothesis_*_ransac_points_previous[index_];
+    if (point_in_camera.z() <= 0) {
+      return false;
+    }
+    const PointCoordinates point_in_image = camera_matrix*point_in_camera/point_in_camera.z();
+    return (point_in_image-_ransac_image_coordinates[index_]).squaredNorm() < maximum_error_squared;
+  };
+
+  //ds preemptive scoring: evaluate all surviving hypotheses on the next block of (shuffled) correspondences and keep the better half
+  std::shuffle(_ransac_order.begin(), _ransac_order.end(), _random_number_generator);
+  _ransac_scores.assign(_ransac_hypotheses.size(), 0);
+  std::vector<Index> active_hypotheses(_ransac_hypotheses.size());
+  std::iota(active_hypotheses.begin(), active_hypotheses.end(), 0);
+  const Count block_size = std::max(_parameters->ransac_preemption_block_size, Count(1));
+  Index index_correspondence = 0;
+  while (active_hypotheses.size() > 1 && index_correspondence < number_of_correspondences) {
+    const Index index_end = std::min(index_correspondence+block_size, number_of_correspondences);
+    for (const Index& index_hypothesis: active_hypotheses) {
+      for (Index index = index_correspondence; index < index_end; ++index) {
+        _ransac_scores[index_hypothesis] += isInlier(_ransac_hypotheses[index_hypothesis], _ransac_order[index]);
+      }
+    }
+    index_correspondence = index_end;
+
+    //ds rank by score (ties broken by generation order for determinism)
+    std::sort(active_hypotheses.begin(), active_hypotheses.end(), [&](const Index& a_, const Index& b_) -> bool {
+      return (_ransac_scores[a_] > _ransac_scores[b_]) || (_ransac_scores[a_] == _ransac_scores[b_] && a_ < b_);
+    });
+    active_hypotheses.resize(active_hypotheses.size()/2);
+  }
+  const TransformMatrix3D& best_hypothesis = _ransac_hypotheses[active_hypotheses.front()];
+
+  //ds full evaluation of the best hypothesis
+  Count number_of_inliers = 0;
+  for (Index u = 0; u < number_of_correspondences; ++u) {
+    number_of_inliers += isInlier(best_hypothesis, u);
+  }
+  CHRONOMETER_STOP(pose_initialization)
+  LOG_DEBUG(std::cerr << current_frame_->identifier() << "|PoseTracker3D::_estimateMotionRansac|hypotheses: " << _ransac_hypotheses.size()
+                      << " inliers: " << number_of_inliers << "/" << number_of_correspondences << std::endl)
+  if (number_of_inliers <= _parameters->minimum_number_of_landmarks_to_track) {
+    return false;
+  }
+  previous_to_current_ = best_hypothesis;
+  return true;
+}
+
 //! @breaks the track at the current frame
 void PoseTracker3D::breakTrack(Frame* frame_) {
 
@@ -1,4 +1,5 @@
 #pragma once
+#include <random>
 #include "framepoint_generation/base_framepoint_generator.h"
 #include "aligners/base_frame_aligner.h"
 #include "types/world_map.h"
@@ -25,6 +26,7 @@ public:
 public:
 
   const Count& numberOfRecursiveRegistrations() const {return _number_of_recursive_registrations;}
+  const Count& numberOfRansacInitializations() const {return _number_of_ransac_initializations;}
   void setCameraLeft(const Camera* camera_) {_camera_left = camera_;}
   void setCameraLeftInWorldGuess(const TransformMatrix3D& camera_left_in_world_guess_) {_camera_left_in_world_guess = camera_left_in_world_guess_; _has_guess = true;}
   void setCameraSecondary(const Camera* camera_) {_camera_secondary = camera_;}
@@ -63,6 +65,13 @@ protected:
   //ds updates existing or creates new landmarks for framepoints of the provided frame
   void _updatePoints(WorldMap* context_, Frame* frame_);
 
+  //! @brief estimates the camera motion with a preemptive RANSAC over P3P hypotheses, computed from the current tracks
+  //! @brief (previous camera coordinates or landmark estimate to current left keypoint), used to seed the aligner
+  //! @param[in] current_frame_ the current frame with tracked points
+  //! @param[out] previous_to_current_ best hypothesis (only set on success)
+  //! @return true if the best hypothesis has more than minimum_number_of_landmarks_to_track inliers
+  bool _estimateMotionRansac(const Frame* current_frame_, TransformMatrix3D& previous_to_current_);
+
   //! @brief resets the pose estimate to a fallback estimate
   //! depending on the selected motion model and/or additinal sensors (e.g. odometry)
   void _fallbackEstimate(Frame* current_frame_,
@@ -108,8 +117,18 @@ protected:
   //ds track recovery
   FramePointPointerVector _lost_points;
 
+  //ds pose initialization buffers (RANSAC)
+  PointCoordinatesVector _ransac_points_previous;
+  PointCoordinatesVector _ransac_bearings;
+  ImageCoordinatesVector _ransac_image_coordinates;
+  std::vector<Index> _ransac_order;
+  std::vector<TransformMatrix3D, Eigen::aligned_allocator<TransformMatrix3D> > _ransac_hypotheses;
+  std::vector<Count> _ransac_scores;
+  std::mt19937 _random_number_generator;
+
   //ds stats only
   Count _number_of_recursive_registrations = 0;
+  Count _number_of_ransac_initializations = 0;
   real _mean_number_of_framepoints = 0;
 
 private:
@@ -118,6 +137,7 @@ private:
   CREATE_CHRONOMETER(tracking)
   CREATE_CHRONOMETER(track_creation)
   CREATE_CHRONOMETER(pose_optimization)
+  CREATE_CHRONOMETER(pose_initialization)
   CREATE_CHRONOMETER(landmark_optimization)
   CREATE_CHRONOMETER(point_recovery)
   Count _total_number_of_tracked_points = 0;
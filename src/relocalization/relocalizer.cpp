@@ -13,14 +13,34 @@ void Relocalizer::configure() {
   _added_local_maps.clear();
   clear();
 
-  //ds allocate and configure aligner unit
+  //ds the matching distance is configured for the storage size - adapt it to the active size (set by the framepoint generator)
+  _maximum_descriptor_distance = getScaledDescriptorDistance(_parameters->maximum_descriptor_distance);
+
+  //ds allocate and configure aligner units (one workspace per verification thread)
   _aligner = XYZAlignerPtr(new XYZAligner(_parameters->aligner));
   _aligner->configure();
+  _aligners.assign(1, _aligner);
+  for (Count u = 1; u < _parameters->number_of_verification_threads; ++u) {
+    _aligners.push_back(XYZAlignerPtr(new XYZAligner(_parameters->aligner)));
+    _aligners.back()->configure();
+  }
+  if (_parameters->number_of_verification_threads > 1) {
+    _thread_pool = std::make_shared<ThreadPool>(_parameters->number_of_verification_threads);
+  }
   LOG_INFO(std::cerr << "Relocalizer::configure|configured" << std::endl)
 }
 
 Relocalizer::~Relocalizer() {
   LOG_INFO(std::cerr << "Relocalizer::~Relocalizer|destroying" << std::endl)
+  stop();
+
+  //ds free closure candidates that have not been fetched
+  for (Query& query: _completed_queries) {
+    for (const Closure* closure: query.closures) {
+      delete closure;
+    }
+  }
+  _completed_queries.clear();
   _added_local_maps.clear();
   clear();
   LOG_INFO(std::cerr << "Relocalizer::~Relocalizer|destroyed" << std::endl)
@@ -32,6 +52,127 @@ void Relocalizer::detectClosures(LocalMap* local_map_query_) {
   if (!local_map_query_) {
     return;
   }
+  _matchAndAdd(local_map_query_, _closures);
+
+#ifdef SRRG_MERGE_DESCRIPTORS
+  //ds always check for absorbed matchables (we need to update our bookkeeping) of the last add call (this local map)
+  _mergeAppearances(_place_database.getMerges());
+#endif
+  CHRONOMETER_STOP(overall)
+}
+
+void Relocalizer::start() {
+  if (_worker) {
+    return;
+  }
+  _is_worker_termination_requested = false;
+  _worker = std::make_shared<std::thread>([=] {_processQueries();});
+  LOG_INFO(std::cerr << "Relocalizer::start|launched relocalization worker" << std::endl)
+}
+
+void Relocalizer::stop() {
+  if (!_worker) {
+    return;
+  }
+
+  //ds the worker terminates as soon as all submitted local maps are processed
+  {
+    std::lock_guard<std::mutex> lock_queries(_mutex_queries);
+    _is_worker_termination_requested = true;
+  }
+  _queries_changed.notify_all();
+  _worker->join();
+  _worker = nullptr;
+  LOG_INFO(std::cerr << "Relocalizer::stop|relocalization worker terminated" << std::endl)
+}
+
+void Relocalizer::submit(LocalMap* local_map_query_) {
+  if (!local_map_query_) {
+    return;
+  }
+
+  //ds without worker we process the local map right away
+  if (!_worker) {
+    detectClosures(local_map_query_);
+    std::lock_guard<std::mutex> lock_queries(_mutex_queries);
+    _completed_queries.push_back(Query());
+    _completed_queries.back().local_map = local_map_query_;
+    _completed_queries.back().closures.swap(_closures);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock_queries(_mutex_queries);
+    _pending_queries.push_back(local_map_query_);
+  }
+  _queries_changed.notify_all();
+}
+
+LocalMap* Relocalizer::fetch(const bool& wait_) {
+  std::unique_lock<std::mutex> lock_queries(_mutex_queries);
+  if (wait_) {
+    _queries_changed.wait(lock_queries, [&] {return !_completed_queries.empty() || (_pending_queries.empty() && !_is_worker_busy);});
+  }
+  if (_completed_queries.empty()) {
+    return nullptr;
+  }
+  CHRONOMETER_START(overall)
+  Query query(std::move(_completed_queries.front()));
+  _completed_queries.pop_front();
+  lock_queries.unlock();
+
+  //ds move the candidates into the closure buffer (which is expected to be cleared)
+  _closures.insert(_closures.end(), query.closures.begin(), query.closures.end());
+
+#ifdef SRRG_MERGE_DESCRIPTORS
+  //ds landmark bookkeeping is updated on the calling thread, which owns the landmarks
+  _mergeAppearances(query.merges);
+#endif
+  CHRONOMETER_STOP(overall)
+  return query.local_map;
+}
+
+const bool Relocalizer::isIdle() {
+  std::lock_guard<std::mutex> lock_queries(_mutex_queries);
+  return _pending_queries.empty() && !_is_worker_busy && _completed_queries.empty();
+}
+
+void Relocalizer::_processQueries() {
+  while (true) {
+
+    //ds wait for the next local map (or termination)
+    Query query;
+    {
+      std::unique_lock<std::mutex> lock_queries(_mutex_queries);
+      _queries_changed.wait(lock_queries, [&] {return !_pending_queries.empty() || _is_worker_termination_requested;});
+
+      //ds terminate only if all local maps have been processed
+      if (_pending_queries.empty()) {
+        break;
+      }
+      query.local_map = _pending_queries.front();
+      _pending_queries.pop_front();
+      _is_worker_busy = true;
+    }
+
+    //ds place recognition operates on the appearances of the local map and the place database only
+    CHRONOMETER_START(worker)
+    _matchAndAdd(query.local_map, query.closures);
+#ifdef SRRG_MERGE_DESCRIPTORS
+    query.merges = _place_database.getMerges();
+#endif
+    CHRONOMETER_STOP(worker)
+
+    //ds publish the result
+    {
+      std::lock_guard<std::mutex> lock_queries(_mutex_queries);
+      _completed_queries.push_back(std::move(query));
+      _is_worker_busy = false;
+    }
+    _queries_changed.notify_all();
+  }
+}
+
+void Relocalizer::_matchAndAdd(LocalMap* local_map_query_, ClosurePointerVector& closures_) {
 
   //ds always add the entry (only matching is optional)
   _added_local_maps.push_back(local_map_query_);
@@ -52,7 +193,7 @@ void Relocalizer::detectClosures(LocalMap* local_map_query_) {
     HBSTTree::MatchVectorMap matches_per_reference_image;
 
     //ds query database for current matchables and integrate current image simultaneously
-    _place_database.matchAndAdd(local_map_query_->appearances(), matches_per_reference_image, _parameters->maximum_descriptor_distance);
+    _place_database.matchAndAdd(local_map_query_->appearances(), matches_per_reference_image, _maximum_descriptor_distance);
     local_map_query_->appearances().clear();
 
     //ds evaluate matches for each reference image in the range
@@ -128,7 +269,7 @@ void Relocalizer::detectClosures(LocalMap* local_map_query_) {
       }
 
       //ds add to closure buffer
-      _closures.push_back(new Closure(local_map_query_,
+      closures_.push_back(new Closure(local_map_query_,
                                       _added_local_maps[index_reference_local_map],
                                       multiple_matches_per_landmark.size(),
                                       relative_number_of_matches,
@@ -136,13 +277,14 @@ void Relocalizer::detectClosures(LocalMap* local_map_query_) {
     }
   }
 
+}
+
 #ifdef SRRG_MERGE_DESCRIPTORS
-  //ds always check for absorbed matchables (we need to update our bookkeeping) of the last add call (this local map)
-  HBSTTree::MatchableMergeVector merges = _place_database.getMerges();
-  if (!merges.empty()) {
+void Relocalizer::_mergeAppearances(const HBSTTree::MatchableMergeVector& merges_) {
+  if (!merges_.empty()) {
 
     //ds evaluate each merge
-    for (HBSTTree::MatchableMerge& merge: merges) {
+    for (const HBSTTree::MatchableMerge& merge: merges_) {
 
       //ds the absorbed landmark must be contained in the merged objects for this local map ID by design
       //ds recall that merge.query is already freed
@@ -151,23 +293,89 @@ void Relocalizer::detectClosures(LocalMap* local_map_query_) {
       //ds replace the matchable in the landmark list, note that the memory for query is already freed
       landmark->replace(merge.query, merge.reference);
     }
-    LOG_DEBUG(std::cerr << "Relocalizer::detectClosures|merged appearances: " << merges.size()
-                        << " (" << static_cast<real>(merges.size())/number_of_query_matchables << ")" << std::endl)
+    LOG_DEBUG(std::cerr << "Relocalizer::_mergeAppearances|merged appearances: " << merges_.size() << std::endl)
   }
-#endif
-  CHRONOMETER_STOP(overall)
 }
+#endif
 
 //ds geometric verification and determination of spatial relation between a set of closures
 void Relocalizer::registerClosures() {
   CHRONOMETER_START(overall)
-  for(Closure* closure: _closures) {
-    _aligner->initialize(closure);
-    _aligner->converge();
+  const Count number_of_closures = _closures.size();
+
+  //ds with early termination the candidates are verified in order of decreasing matching ratio:
+  //ds the first accepted closure cannot be replaced by any of the remaining candidates in prune
+  if (_parameters->enable_early_termination) {
+    std::stable_sort(_closures.begin(), _closures.end(), [](const Closure* a_, const Closure* b_) {
+      return a_->relative_number_of_matches > b_->relative_number_of_matches;
+    });
+  }
+
+  //ds candidates are handed out in order, each lane verifies with its own aligner workspace
+  std::atomic<Index> index_next_closure(0);
+  std::atomic<Index> index_first_accepted_closure(number_of_closures);
+  const std::function<void(const Index&)> verify = [&](const Index& lane_) {
+    XYZAligner* aligner = _aligners[lane_].get();
+    for (Index index_closure = index_next_closure++; index_closure < number_of_closures; index_closure = index_next_closure++) {
+
+      //ds skip candidates that are dominated by an already accepted closure (remain invalid)
+      if (index_closure > index_first_accepted_closure) {
+        continue;
+      }
+      Closure* closure = _closures[index_closure];
+      _verifyClosure(aligner, closure, index_closure);
+
+      //ds update the first accepted closure
+      if (closure->is_valid && _parameters->enable_early_termination) {
+        Index index_first_accepted_closure_current = index_first_accepted_closure;
+        while (index_closure < index_first_accepted_closure_current &&
+               !index_first_accepted_closure.compare_exchange_weak(index_first_accepted_closure_current, index_closure)) {}
+      }
+    }
+  };
+  const Count number_of_lanes = std::min(static_cast<Count>(_aligners.size()), number_of_closures);
+  if (_thread_pool && number_of_lanes > 1) {
+    _thread_pool->execute(number_of_lanes, verify);
+  } else {
+    verify(0);
+  }
+
+  //ds keep only the accepted closure (all candidates in front of it have been rejected)
+  if (index_first_accepted_closure < number_of_closures) {
+    Closure* closure_accepted = _closures[index_first_accepted_closure];
+    for (Closure* closure: _closures) {
+      if (closure != closure_accepted) {
+        closure->is_valid = false;
+        delete closure;
+      }
+    }
+    _closures.assign(1, closure_accepted);
   }
   CHRONOMETER_STOP(overall)
 }
 
+void Relocalizer::_verifyClosure(XYZAligner* aligner_, Closure* closure_, const Index& index_closure_) {
+
+  //ds the registration requires more inliers than the minimum - candidates with insufficient correspondences are rejected right away
+  if (closure_->correspondences.size() <= _parameters->aligner->minimum_number_of_inliers) {
+    closure_->is_valid = false;
+    return;
+  }
+  aligner_->initialize(closure_);
+
+  //ds reject candidates without sufficient consensus before running ICP, the best hypothesis serves as initial guess
+  if (_parameters->number_of_ransac_iterations > 0) {
+
+    //ds seeded with the candidate position: the result does not depend on the verifying thread
+    std::mt19937 random_number_generator(index_closure_);
+    if (aligner_->sampleConsensus(_parameters->number_of_ransac_iterations, random_number_generator) <= _parameters->aligner->minimum_number_of_inliers) {
+      closure_->is_valid = false;
+      return;
+    }
+  }
+  aligner_->converge();
+}
+
 void Relocalizer::prune() {
   CHRONOMETER_START(overall)
   Closure* closure_best = nullptr;
@@ -206,7 +414,6 @@ void Relocalizer::clear() {
     delete closure;
   }
   _closures.clear();
-  _mask_id_references_for_correspondences.clear();
   CHRONOMETER_STOP(overall)
 }
 
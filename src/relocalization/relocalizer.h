@@ -1,5 +1,11 @@
 #pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
 #include "aligners/xyz_aligner.h"
+#include "types/thread_pool.h"
 #include "closure.h"
 
 namespace proslam {
@@ -17,6 +23,7 @@ public:
   void detectClosures(LocalMap* local_map_query_);
 
   //ds geometric verification and determination of spatial relation between closure set
+  //ds candidates are verified concurrently with number_of_verification_threads (one aligner workspace per thread)
   void registerClosures();
 
   //ds clear currently available closure buffer
@@ -25,11 +32,31 @@ public:
   //! @brief keeps only a single closure, based on the maximum relative number of correspodences TODO add proper constraints
   void prune();
 
+  //! @brief launches the relocalization worker: place database queries (and insertions) of submitted local maps are processed asynchronously
+  void start();
+
+  //! @brief processes all remaining submitted local maps and joins the worker (no effect without worker)
+  void stop();
+
+  //! @brief hands a local map over to the worker and returns immediately (equivalent to detectClosures without worker)
+  //! @param[in] local_map_query_ the local map to match and add to the place database, its appearances are consumed by the worker
+  void submit(LocalMap* local_map_query_);
+
+  //! @brief moves the closure candidates of the oldest completed query into the closure buffer, to be processed as after detectClosures
+  //! @param[in] wait_ block until the next query is completed, if there are any pending queries
+  //! @return the query local map of the retrieved closure candidates, nullptr if no completed query is available
+  LocalMap* fetch(const bool& wait_ = false);
+
 //ds getters/setters
 public:
 
   inline const ClosurePointerVector& closures() const {return _closures;}
   XYZAlignerPtr aligner() {return _aligner;}
+  const bool isAsynchronous() const {return _worker != nullptr;}
+
+  //! @brief true if no submitted local map is pending, being processed or waiting to be fetched (always true without worker)
+  //! @brief only then the place database and the closure candidates hold no landmark references that a landmark merge could invalidate
+  const bool isIdle();
 
 //ds helpers
 protected:
@@ -37,6 +64,34 @@ protected:
   //ds retrieve correspondences from matches
   inline Closure::Correspondence* _getCorrespondenceNN(const Closure::CandidateVector& matches_);
 
+  //! @brief geometric verification of a single closure candidate: correspondence count and sample consensus checks, followed by ICP
+  //! @param[in] aligner_ aligner workspace to use (exclusive to the calling thread)
+  //! @param[in,out] closure_ the candidate, is_valid is set if the registration is accepted
+  //! @param[in] index_closure_ position of the candidate in the closure buffer (seeds the sampling)
+  void _verifyClosure(XYZAligner* aligner_, Closure* closure_, const Index& index_closure_);
+
+  //! @brief matches the local map against the place database and adds it, closure candidates are appended to the provided buffer
+  //! @param[in] local_map_query_ the local map to match and add, its appearances are consumed
+  //! @param[in,out] closures_ closure candidate buffer
+  void _matchAndAdd(LocalMap* local_map_query_, ClosurePointerVector& closures_);
+
+#ifdef SRRG_MERGE_DESCRIPTORS
+  //! @brief updates the landmark bookkeeping for appearances absorbed by the place database
+  void _mergeAppearances(const HBSTTree::MatchableMergeVector& merges_);
+#endif
+
+  //! @brief worker loop: processes submitted local maps until termination is requested
+  void _processQueries();
+
+  //! @brief a local map processed by the worker, with its closure candidates
+  struct Query {
+    LocalMap* local_map;
+    ClosurePointerVector closures;
+#ifdef SRRG_MERGE_DESCRIPTORS
+    HBSTTree::MatchableMergeVector merges;
+#endif
+  };
+
 protected:
 
   //ds buffer of found closures (last compute call)
@@ -45,18 +100,50 @@ protected:
   //ds local map to local map alignment
   XYZAlignerPtr _aligner = nullptr;
 
+  //! @brief aligner workspaces, one per verification thread (the first one is _aligner)
+  std::vector<XYZAlignerPtr> _aligners;
+
+  //! @brief closure verification threads (only allocated for more than one verification thread)
+  ThreadPoolPtr _thread_pool = nullptr;
+
   //ds database of visited places (= local maps), storing a descriptor vector for each place
   HBSTTree _place_database;
 
+  //! @brief maximum descriptor distance for place matching, scaled to the active descriptor size
+  real _maximum_descriptor_distance = 0;
+
   //ds local maps that have been added to the place database (in order of calls)
   LocalMapPointerVector _added_local_maps;
 
   //ds correspondence retrieval buffer
   std::set<Identifier> _mask_id_references_for_correspondences;
 
+//ds asynchronous processing (only active after start)
+protected:
+
+  //! @brief worker thread, owning the place database while active
+  std::shared_ptr<std::thread> _worker = nullptr;
+
+  //! @brief submitted local maps, waiting to be matched and added to the place database
+  std::deque<LocalMap*> _pending_queries;
+
+  //! @brief processed local maps with their closure candidates, waiting to be fetched
+  std::deque<Query> _completed_queries;
+
+  //! @brief query queue access and notification
+  std::mutex _mutex_queries;
+  std::condition_variable _queries_changed;
+
+  //! @brief set while the worker is processing a local map (guarded by _mutex_queries)
+  bool _is_worker_busy = false;
+
+  //! @brief set to terminate the worker once all submitted local maps have been processed (guarded by _mutex_queries)
+  bool _is_worker_termination_requested = false;
+
 private:
 
   CREATE_CHRONOMETER(overall)
+  CREATE_CHRONOMETER(worker)
 
 };
 }
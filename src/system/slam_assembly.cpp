@@ -20,7 +20,19 @@ SLAMAssembly::SLAMAssembly(ParameterCollection* parameters_): _parameters(parame
                                                               _minimap_viewer(0),
 //                                                              _new_image_available(false),
                                                               _is_termination_requested(false),
-                                                              _is_viewer_open(false) {
+                                                              _is_viewer_open(false),
+                                                              _latency_profiler({"frame",
+                                                                                 "keypoint_detection",
+                                                                                 "descriptor_extraction",
+                                                                                 "triangulation",
+                                                                                 "tracking",
+                                                                                 "pose_optimization",
+                                                                                 "landmark_optimization",
+                                                                                 "point_recovery",
+                                                                                 "local_map_creation",
+                                                                                 "relocalization",
+                                                                                 "optimization"}),
+                                                              _is_latency_profile_export_requested(false) {
   _synchronizer.reset();
   _processing_times_seconds.clear();
   _tracker->setWorldMap(_world_map);
@@ -35,6 +47,7 @@ SLAMAssembly::SLAMAssembly(ParameterCollection* parameters_): _parameters(parame
 
 SLAMAssembly::~SLAMAssembly() {
   LOG_INFO(std::cerr << "SLAMAssembly::~SLAMAssembly|destroying assembly" << std::endl)
+  _stopBackend();
   delete _tracker;
   delete _graph_optimizer;
   delete _relocalizer;
@@ -237,6 +250,16 @@ void SLAMAssembly::loadCameras(Camera* camera_left_, Camera* camera_right_) {
   //ds configure remaining components
   _graph_optimizer->configure();
   _relocalizer->configure();
+
+  //ds launch backend worker if desired (relocalization and pose graph optimization are decoupled from tracking)
+  if (_parameters->command_line_parameters->option_use_backend_thread && !_parameters->command_line_parameters->option_disable_relocalization) {
+    _startBackend();
+  }
+
+  //ds otherwise launch the relocalization worker if desired (place database queries are decoupled from tracking)
+  else if (_parameters->relocalizer_parameters->enable_asynchronous_processing && !_parameters->command_line_parameters->option_disable_relocalization) {
+    _relocalizer->start();
+  }
 }
 
 void SLAMAssembly::initializeGUI(std::shared_ptr<QApplication> ui_server_) {
@@ -478,6 +501,11 @@ void SLAMAssembly::playbackMessageFile() {
       image_message_right->release();
       _synchronizer.reset();
 
+      //ds export latency profile if requested
+      if (_is_latency_profile_export_requested.exchange(false)) {
+        writeLatencyProfile();
+      }
+
       //ds update gui (no effect if no GUI is active)
       updateGUI();
 
@@ -487,6 +515,9 @@ void SLAMAssembly::playbackMessageFile() {
     }
   }
   _message_reader.close();
+
+  //ds wait for pending map corrections before reporting
+  flushBackend();
   LOG_INFO(std::cerr << "SLAMAssembly::playbackMessageFile|dataset completed" << std::endl)
 }
 
@@ -496,6 +527,21 @@ void SLAMAssembly::process(const cv::Mat& intensity_image_left_,
                            const bool& use_guess_,
                            const TransformMatrix3D& camera_left_in_world_guess_) {
 
+  //ds per-frame stage latencies are derived from the chronometer increments over this call (backend stages only without backend thread)
+  const double time_start_seconds = srrg_core::getTime();
+  const Index stage_end           = (_backend_thread) ? RELOCALIZATION : NUMBER_OF_LATENCY_STAGES;
+  std::vector<double> time_consumption_seconds_previous(NUMBER_OF_LATENCY_STAGES, 0);
+  for (Index stage = KEYPOINT_DETECTION; stage < stage_end; ++stage) {
+    time_consumption_seconds_previous[stage] = _getTimeConsumptionSeconds(static_cast<LatencyStage>(stage));
+  }
+  LocalMap* created_local_map = nullptr;
+
+  //ds with an active backend the map is locked for the complete frontend step - the backend modifies the map only in between frames
+  std::unique_lock<std::mutex> lock_world_map(_mutex_world_map, std::defer_lock);
+  if (_backend_thread) {
+    lock_world_map.lock();
+  }
+
   //ds provide tracker with data
   _tracker->setIntensityImageLeft(intensity_image_left_);
   _tracker->setImageSecondary(intensity_image_right_);
@@ -519,39 +565,44 @@ void SLAMAssembly::process(const cv::Mat& intensity_image_left_,
 
       //ds local map generation - regardless of tracker state
       if (_map_viewer) {_map_viewer->lock();}
-      LocalMap* created_local_map = _world_map->createLocalMap(_parameters->command_line_parameters->option_drop_framepoints);
+      created_local_map = _world_map->createLocalMap(_parameters->command_line_parameters->option_drop_framepoints);
       if (_map_viewer) {_map_viewer->unlock();}
 
+      //ds if we successfully created a local map and have a backend running - hand the local map over
+      if (created_local_map && _backend_thread) {
+
+        //ds release the map before waiting on the queue, since the backend requires it to make progress
+        lock_world_map.unlock();
+
+        //ds wait until there is space in the queue (this throttles the frontend if the backend falls behind)
+        std::unique_lock<std::mutex> lock_queue(_mutex_backend_queue);
+        const Count maximum_number_of_queued_local_maps = std::max(_parameters->command_line_parameters->maximum_number_of_queued_local_maps, Count(1));
+        _backend_queue_changed.wait(lock_queue, [&] {return _backend_queue.size() < maximum_number_of_queued_local_maps;});
+        _backend_queue.push_back(created_local_map);
+        lock_queue.unlock();
+        _backend_queue_changed.notify_all();
+      }
+
       //ds if we successfully created a local map
-      if (created_local_map) {
-
-        //ds localize in database (not yet optimizing the graph)
-        _relocalizer->detectClosures(created_local_map);
-        _relocalizer->registerClosures();
-
-        //ds check the closures
-        if (_map_viewer) {_map_viewer->lock();}
-        for(Closure* closure: _relocalizer->closures()) {
-          if (closure->is_valid) {
-            assert(created_local_map == closure->local_map_query);
-
-            //ds add loop closure constraint (merging corresponding landmarks)
-            _world_map->addLoopClosure(created_local_map,
-                                       closure->local_map_reference,
-                                       closure->query_to_reference,
-                                       closure->correspondences,
-                                       closure->icp_inlier_ratio);
-            if (_parameters->command_line_parameters->option_use_gui) {
-              for (const Closure::Correspondence* match: closure->correspondences) {
-                _world_map->landmarks().at(match->query->identifier())->setIsInLoopClosureQuery(true);
-                _world_map->landmarks().at(match->reference->identifier())->setIsInLoopClosureReference(true);
-              }
-            }
-          }
-        }
+      else if (created_local_map) {
+
+        //ds with an asynchronous relocalizer the local map is only handed over, its closures are integrated once available
+        if (_relocalizer->isAsynchronous()) {
+          _relocalizer->submit(created_local_map);
+          if (_map_viewer) {_map_viewer->lock();}
+        } else {
 
-        //ds clear buffer (automatically purges invalidated closures)
-        _relocalizer->clear();
+          //ds localize in database (not yet optimizing the graph)
+          _relocalizer->detectClosures(created_local_map);
+          _relocalizer->registerClosures();
+
+          //ds check the closures
+          if (_map_viewer) {_map_viewer->lock();}
+          _addLoopClosures(created_local_map);
+
+          //ds clear buffer (automatically purges invalidated closures)
+          _relocalizer->clear();
+        }
 
         //ds if bundle-adjustment is desired
         if (!_parameters->command_line_parameters->option_disable_bundle_adjustment) {
@@ -559,8 +610,8 @@ void SLAMAssembly::process(const cv::Mat& intensity_image_left_,
           //ds add frame and its landmarks to the pose graph
           _graph_optimizer->addPoseWithFactors(_world_map->currentFrame());
 
-          //ds check if a periodic bundle adjustment is required
-          if (_world_map->frames().size() % _parameters->graph_optimizer_parameters->number_of_frames_per_bundle_adjustment == 0) {
+          //ds check if a bundle adjustment is required (periodic or sliding window)
+          if (_graph_optimizer->isFactorGraphOptimizationDue(_world_map->currentFrame())) {
 
             //ds optimize graph
             _graph_optimizer->optimizeFactorGraph(_world_map);
@@ -576,11 +627,15 @@ void SLAMAssembly::process(const cv::Mat& intensity_image_left_,
 
           //ds perform a lightweight pose graph optimization with the loop closure constraints
           _graph_optimizer->optimizePoseGraph(_world_map);
+          _updateLandmarkCoordinates();
 
           //ds merge landmarks for the current local map and its closures
           _world_map->mergeLandmarks(created_local_map->closures());
         }
 
+        //ds enforce the memory budget on the processed part of the map (no effect if unbounded)
+        _world_map->compactFrames(created_local_map);
+
         //ds update viewer
         if (_map_viewer) {
           _map_viewer->update(_world_map->currentlyTrackedLandmarks());
@@ -616,6 +671,20 @@ void SLAMAssembly::process(const cv::Mat& intensity_image_left_,
       }
     }
   }
+
+  //ds integrate closures that have been found by the asynchronous relocalizer in the meantime
+  if (_relocalizer->isAsynchronous()) {
+    _integrateClosures();
+  }
+
+  //ds record stage latencies: frontend stages for every frame, local map stages only if a local map was created (and processed)
+  for (Index stage = KEYPOINT_DETECTION; stage < stage_end; ++stage) {
+    const double time_consumption_seconds = _getTimeConsumptionSeconds(static_cast<LatencyStage>(stage))-time_consumption_seconds_previous[stage];
+    if (stage < LOCAL_MAP_CREATION || (created_local_map && (stage != OPTIMIZATION || time_consumption_seconds > 0))) {
+      _latency_profiler.record(stage, time_consumption_seconds);
+    }
+  }
+  _latency_profiler.record(FRAME, srrg_core::getTime()-time_start_seconds);
 }
 
 void SLAMAssembly::printReport() const {
@@ -666,6 +735,21 @@ void SLAMAssembly::printReport() const {
   std::cerr << "         number of merged landmarks: " << _world_map->numberOfMergedLandmarks()
             << " (of total landmarks: " << static_cast<real>(_world_map->numberOfMergedLandmarks())/_world_map->landmarks().size() <<  ")" << std::endl;
   std::cerr << "  number of recursive registrations: " << _tracker->numberOfRecursiveRegistrations() << std::endl;
+  if (_tracker->parameters()->enable_ransac_initialization) {
+  std::cerr << "   number of RANSAC initializations: " << _tracker->numberOfRansacInitializations() << std::endl;
+  }
+  std::cerr << "         number of compacted frames: " << _world_map->numberOfCompactedFrames()
+            << " (archived landmarks: " << _world_map->numberOfArchivedLandmarks() << ", estimated memory (MB): " << _world_map->memoryBytesEstimate()/1e6 << ")" << std::endl;
+  std::cerr << "  frame pool (active/created/allocs): " << _world_map->framePool().numberOfActiveObjects() << "/" << _world_map->framePool().numberOfCreatedObjects()
+            << "/" << _world_map->framePool().numberOfChunkAllocations() << " (MB: " << _world_map->framePool().sizeBytes()/1e6 << ")" << std::endl;
+  std::cerr << "  point pool (active/created/allocs): " << _world_map->framepointPool().numberOfActiveObjects() << "/" << _world_map->framepointPool().numberOfCreatedObjects()
+            << "/" << _world_map->framepointPool().numberOfChunkAllocations() << " (MB: " << _world_map->framepointPool().sizeBytes()/1e6 << ")" << std::endl;
+  std::cerr << "landmark pool (active/created/allocs): " << _world_map->landmarkPool().numberOfActiveObjects() << "/" << _world_map->landmarkPool().numberOfCreatedObjects()
+            << "/" << _world_map->landmarkPool().numberOfChunkAllocations() << " (MB: " << _world_map->landmarkPool().sizeBytes()/1e6 << ")" << std::endl;
+  std::cerr << "   object buffer allocations (frames): " << Frame::numberOfBufferAllocations()
+            << " (per frame: " << static_cast<real>(Frame::numberOfBufferAllocations())/_number_of_processed_frames << ")" << std::endl;
+  std::cerr << "object buffer allocations (landmarks): " << Landmark::numberOfBufferAllocations()
+            << " (per frame: " << static_cast<real>(Landmark::numberOfBufferAllocations())/_number_of_processed_frames << ")" << std::endl;
 
   {
     std::string timings_filename = "timing_proslam.txt";
@@ -702,6 +786,10 @@ void SLAMAssembly::printReport() const {
                                                          _tracker->framepointGenerator()->getTimeConsumptionSeconds_keypoint_detection());
   std::printf("  descriptor extraction | %f | %f\n", _tracker->framepointGenerator()->getTimeConsumptionSeconds_descriptor_extraction()/_processing_time_total_seconds,
                                                          _tracker->framepointGenerator()->getTimeConsumptionSeconds_descriptor_extraction());
+  if (_tracker->framepointGenerator()->parameters()->enable_coarse_to_fine_tracking) {
+  std::printf("        coarse tracking | %f | %f\n", _tracker->framepointGenerator()->getTimeConsumptionSeconds_coarse_tracking()/_processing_time_total_seconds,
+                                                         _tracker->framepointGenerator()->getTimeConsumptionSeconds_coarse_tracking());
+  }
 
   //ds display further information depending on tracking mode
   switch (_parameters->command_line_parameters->tracker_mode){
@@ -726,18 +814,377 @@ void SLAMAssembly::printReport() const {
 
   std::printf("               tracking | %f | %f\n", _tracker->getTimeConsumptionSeconds_tracking()/_processing_time_total_seconds, _tracker->getTimeConsumptionSeconds_tracking());
   std::printf("      pose optimization | %f | %f\n", _tracker->getTimeConsumptionSeconds_pose_optimization()/_processing_time_total_seconds, _tracker->getTimeConsumptionSeconds_pose_optimization());
+  if (_tracker->parameters()->enable_ransac_initialization) {
+  std::printf("    pose initialization | %f | %f\n", _tracker->getTimeConsumptionSeconds_pose_initialization()/_processing_time_total_seconds, _tracker->getTimeConsumptionSeconds_pose_initialization());
+  }
   std::printf("  landmark optimization | %f | %f\n", _tracker->getTimeConsumptionSeconds_landmark_optimization()/_processing_time_total_seconds, _tracker->getTimeConsumptionSeconds_landmark_optimization());
   std::printf("         point recovery | %f | %f\n", _tracker->getTimeConsumptionSeconds_point_recovery()/_processing_time_total_seconds, _tracker->getTimeConsumptionSeconds_point_recovery());
+  std::printf("     local map creation | %f | %f\n", _world_map->getTimeConsumptionSeconds_local_map_creation()/_processing_time_total_seconds, _world_map->getTimeConsumptionSeconds_local_map_creation());
   std::printf("         relocalization | %f | %f\n", _relocalizer->getTimeConsumptionSeconds_overall()/_processing_time_total_seconds, _relocalizer->getTimeConsumptionSeconds_overall());
+  if (_relocalizer->parameters()->enable_asynchronous_processing) {
+  std::printf("  relocalization worker | %f | %f\n", _relocalizer->getTimeConsumptionSeconds_worker()/_processing_time_total_seconds, _relocalizer->getTimeConsumptionSeconds_worker());
+  }
   std::printf("    pose graph addition | %f | %f\n", _graph_optimizer->getTimeConsumptionSeconds_addition()/_processing_time_total_seconds, _graph_optimizer->getTimeConsumptionSeconds_addition());
   std::printf("pose graph optimization | %f | %f\n", _graph_optimizer->getTimeConsumptionSeconds_optimization()/_processing_time_total_seconds, _graph_optimizer->getTimeConsumptionSeconds_optimization());
   std::printf("       landmark merging | %f | %f\n", _world_map->getTimeConsumptionSeconds_landmark_merging()/_processing_time_total_seconds, _world_map->getTimeConsumptionSeconds_landmark_merging());
+  std::printf("       frame compaction | %f | %f\n", _world_map->getTimeConsumptionSeconds_frame_compaction()/_processing_time_total_seconds, _world_map->getTimeConsumptionSeconds_frame_compaction());
+  std::printf("        landmark update | %f | %f\n", _world_map->getTimeConsumptionSeconds_landmark_update()/_processing_time_total_seconds, _world_map->getTimeConsumptionSeconds_landmark_update());
+  std::cerr << BAR << std::endl;
+
+  //ds latency distributions
+  std::cerr << std::endl;
+  std::cerr << "latency overview - processing stages" << std::endl;
+  std::cerr << BAR << std::endl;
+  std::fflush(stdout);
+  _latency_profiler.print(std::cerr);
   std::cerr << DOUBLE_BAR << std::endl;
 }
 
+void SLAMAssembly::writeLatencyProfile() const {
+  if (!_parameters->command_line_parameters->latency_profile_json_file_name.empty()) {
+    _latency_profiler.writeJSON(_parameters->command_line_parameters->latency_profile_json_file_name);
+  }
+  if (!_parameters->command_line_parameters->latency_profile_csv_file_name.empty()) {
+    _latency_profiler.writeCSV(_parameters->command_line_parameters->latency_profile_csv_file_name);
+  }
+}
+
 void SLAMAssembly::reset() {
+  flushBackend();
+  _local_maps_pending_merge.clear();
   _synchronizer.reset();
   _processing_times_seconds.clear();
+  _latency_profiler.clear();
   _world_map->clear();
 }
+
+void SLAMAssembly::flushBackend() {
+
+  //ds integrate the closures of all local maps submitted to the asynchronous relocalizer
+  if (_relocalizer->isAsynchronous()) {
+    _integrateClosures(true);
+  }
+  if (_backend_thread) {
+    std::unique_lock<std::mutex> lock_queue(_mutex_backend_queue);
+    _backend_queue_changed.wait(lock_queue, [&] {return _backend_queue.empty() && !_is_backend_busy;});
+  }
+
+  //ds a hierarchical pose graph optimization only refines the segments of the closures - compute the flat solution (e.g. for export)
+  if (_graph_optimizer->isFlatSolutionOutdated()) {
+    std::lock_guard<std::mutex> lock_world_map(_mutex_world_map);
+
+    //ds nothing to correct before the first local map has been created
+    if (!_world_map->currentLocalMap()) {
+      return;
+    }
+    if (_map_viewer) {_map_viewer->lock();}
+    Frame* keyframe = _world_map->currentLocalMap()->keyframe();
+    const TransformMatrix3D keyframe_to_world_previous(keyframe->robotToWorld());
+    _graph_optimizer->optimizePoseGraph(_world_map, true);
+    _applyPoseCorrection(keyframe, keyframe->robotToWorld()*keyframe_to_world_previous.inverse());
+    _updateLandmarkCoordinates();
+    if (_map_viewer) {
+      _map_viewer->update(_world_map->currentlyTrackedLandmarks());
+      _map_viewer->unlock();
+    }
+  }
+}
+
+void SLAMAssembly::_startBackend() {
+  if (_backend_thread) {
+    return;
+  }
+  _is_backend_termination_requested = false;
+  _backend_thread = std::make_shared<std::thread>([=] {_processBackend();});
+  LOG_INFO(std::cerr << "SLAMAssembly::_startBackend|launched backend with queue size: "
+                     << _parameters->command_line_parameters->maximum_number_of_queued_local_maps << std::endl)
+}
+
+void SLAMAssembly::_stopBackend() {
+  if (!_backend_thread) {
+    return;
+  }
+
+  //ds the backend terminates as soon as its queue is empty
+  {
+    std::lock_guard<std::mutex> lock_queue(_mutex_backend_queue);
+    _is_backend_termination_requested = true;
+  }
+  _backend_queue_changed.notify_all();
+  _backend_thread->join();
+  _backend_thread = nullptr;
+  LOG_INFO(std::cerr << "SLAMAssembly::_stopBackend|backend terminated" << std::endl)
+}
+
+void SLAMAssembly::_processBackend() {
+  while (true) {
+
+    //ds wait for the next local map (or termination)
+    LocalMap* local_map = nullptr;
+    {
+      std::unique_lock<std::mutex> lock_queue(_mutex_backend_queue);
+      _backend_queue_changed.wait(lock_queue, [&] {return !_backend_queue.empty() || _is_backend_termination_requested;});
+
+      //ds terminate only if all local maps have been processed
+      if (_backend_queue.empty()) {
+        break;
+      }
+      local_map = _backend_queue.front();
+      _backend_queue.pop_front();
+      _is_backend_busy = true;
+    }
+
+    //ds the frontend might be waiting for space in the queue
+    _backend_queue_changed.notify_all();
+    _processLocalMapInBackend(local_map);
+
+    //ds signal completion (flushBackend)
+    {
+      std::lock_guard<std::mutex> lock_queue(_mutex_backend_queue);
+      _is_backend_busy = false;
+    }
+    _backend_queue_changed.notify_all();
+  }
+}
+
+void SLAMAssembly::_processLocalMapInBackend(LocalMap* local_map_) {
+  Frame* keyframe = local_map_->keyframe();
+  const double time_consumption_seconds_relocalization_previous = _getTimeConsumptionSeconds(RELOCALIZATION);
+  const double time_consumption_seconds_optimization_previous   = _getTimeConsumptionSeconds(OPTIMIZATION);
+
+  //ds place recognition operates on the appearances of the local map only - no map access required
+  _relocalizer->detectClosures(local_map_);
+
+  //ds geometric verification reads current landmark estimates and the graph is extended by the local map
+  bool has_closures = false;
+  {
+    std::lock_guard<std::mutex> lock_world_map(_mutex_world_map);
+    if (_map_viewer) {_map_viewer->lock();}
+    _relocalizer->registerClosures();
+
+    //ds check the closures
+    has_closures = (_addLoopClosures(local_map_) > 0);
+
+    //ds clear buffer (automatically purges invalidated closures)
+    _relocalizer->clear();
+
+    //ds if bundle-adjustment is desired
+    if (!_parameters->command_line_parameters->option_disable_bundle_adjustment) {
+
+      //ds add keyframe and its landmarks to the pose graph
+      _graph_optimizer->addPoseWithFactors(keyframe);
+
+      //ds check if a bundle adjustment is required (periodic or sliding window)
+      if (_graph_optimizer->isFactorGraphOptimizationDue(keyframe)) {
+
+        //ds optimize graph and carry the keyframe correction over to the frames tracked in the meantime
+        const TransformMatrix3D keyframe_to_world_previous(keyframe->robotToWorld());
+        _graph_optimizer->optimizeFactorGraph(_world_map);
+        _applyPoseCorrection(keyframe, keyframe->robotToWorld()*keyframe_to_world_previous.inverse());
+      }
+    } else {
+
+      //ds just add the local map to the pose graph
+      _graph_optimizer->addPose(local_map_);
+    }
+    if (_map_viewer) {_map_viewer->unlock();}
+  }
+
+  //ds if we closed the local map
+  if (has_closures) {
+
+    //ds solve the pose graph while the frontend keeps tracking
+    _graph_optimizer->solvePoseGraph();
+
+    //ds integrate the solution at a safe point (between two frontend frames)
+    std::lock_guard<std::mutex> lock_world_map(_mutex_world_map);
+    if (_map_viewer) {_map_viewer->lock();}
+    const TransformMatrix3D keyframe_to_world_previous(keyframe->robotToWorld());
+    _graph_optimizer->updatePoseGraph(_world_map);
+    _applyPoseCorrection(keyframe, keyframe->robotToWorld()*keyframe_to_world_previous.inverse());
+    _updateLandmarkCoordinates();
+
+    //ds merge landmarks for the current local map and its closures
+    _world_map->mergeLandmarks(local_map_->closures());
+
+    //ds update viewer
+    if (_map_viewer) {
+      _map_viewer->update(_world_map->currentlyTrackedLandmarks());
+      _map_viewer->unlock();
+    }
+  }
+
+  //ds enforce the memory budget on the processed part of the map (no effect if unbounded)
+  std::lock_guard<std::mutex> lock_world_map(_mutex_world_map);
+  if (_map_viewer) {_map_viewer->lock();}
+  _world_map->compactFrames(local_map_);
+  if (_map_viewer) {_map_viewer->unlock();}
+
+  //ds record backend stage latencies for this local map
+  _latency_profiler.record(RELOCALIZATION, _getTimeConsumptionSeconds(RELOCALIZATION)-time_consumption_seconds_relocalization_previous);
+  const double time_consumption_seconds_optimization = _getTimeConsumptionSeconds(OPTIMIZATION)-time_consumption_seconds_optimization_previous;
+  if (time_consumption_seconds_optimization > 0) {
+    _latency_profiler.record(OPTIMIZATION, time_consumption_seconds_optimization);
+  }
+}
+
+const Count SLAMAssembly::_addLoopClosures(LocalMap* local_map_query_) {
+  Count number_of_added_closures = 0;
+  for(Closure* closure: _relocalizer->closures()) {
+    if (closure->is_valid) {
+      assert(local_map_query_ == closure->local_map_query);
+
+      //ds add loop closure constraint (merging corresponding landmarks)
+      _world_map->addLoopClosure(local_map_query_,
+                                 closure->local_map_reference,
+                                 closure->query_to_reference,
+                                 closure->correspondences,
+                                 closure->icp_inlier_ratio);
+      if (_parameters->command_line_parameters->option_use_gui) {
+        for (const Closure::Correspondence* match: closure->correspondences) {
+          _world_map->landmarks().at(match->query->identifier())->setIsInLoopClosureQuery(true);
+          _world_map->landmarks().at(match->reference->identifier())->setIsInLoopClosureReference(true);
+        }
+      }
+      ++number_of_added_closures;
+    }
+  }
+  return number_of_added_closures;
+}
+
+void SLAMAssembly::_integrateClosures(const bool& wait_) {
+  if (_map_viewer) {_map_viewer->lock();}
+
+  //ds geometric verification of all completed queries (against the current landmark estimates)
+  LocalMapPointerVector closed_local_maps;
+  while (LocalMap* local_map_query = _relocalizer->fetch(wait_)) {
+    _relocalizer->registerClosures();
+    if (_addLoopClosures(local_map_query) > 0) {
+      closed_local_maps.push_back(local_map_query);
+
+      //ds the query local map is already part of the pose graph - only the closure constraints are missing
+      if (_parameters->command_line_parameters->option_disable_bundle_adjustment) {
+        _graph_optimizer->addLoopClosures(local_map_query);
+      }
+    }
+
+    //ds clear buffer (automatically purges invalidated closures)
+    _relocalizer->clear();
+  }
+
+  //ds a single optimization for all closed local maps
+  if (!closed_local_maps.empty()) {
+
+    //ds frames tracked after the most recent local map are not part of the pose graph and are moved along with its keyframe
+    Frame* keyframe = _world_map->currentLocalMap()->keyframe();
+    const TransformMatrix3D keyframe_to_world_previous(keyframe->robotToWorld());
+    _graph_optimizer->optimizePoseGraph(_world_map);
+    _applyPoseCorrection(keyframe, keyframe->robotToWorld()*keyframe_to_world_previous.inverse());
+    _updateLandmarkCoordinates();
+    _local_maps_pending_merge.insert(_local_maps_pending_merge.end(), closed_local_maps.begin(), closed_local_maps.end());
+  }
+
+  //ds merge landmarks for the closed local maps and their closures once no landmark reference is held by the relocalizer
+  //ds (local maps are only submitted by this thread, hence the relocalizer stays idle during the merge)
+  const bool is_merge_due = (!_local_maps_pending_merge.empty() && _relocalizer->isIdle());
+  if (is_merge_due) {
+    for (LocalMap* local_map: _local_maps_pending_merge) {
+      _world_map->mergeLandmarks(local_map->closures());
+    }
+    _local_maps_pending_merge.clear();
+  }
+
+  //ds update viewer
+  if ((!closed_local_maps.empty() || is_merge_due) && _map_viewer) {_map_viewer->update(_world_map->currentlyTrackedLandmarks());}
+  if (_map_viewer) {_map_viewer->unlock();}
+}
+
+void SLAMAssembly::_applyPoseCorrection(Frame* keyframe_, const TransformMatrix3D& correction_) {
+  assert(keyframe_->localMap());
+
+  //ds move all frames that have been tracked after the keyframe (not yet contained in the pose graph)
+  Frame* frame = keyframe_->next();
+  while (frame) {
+    frame->setRobotToWorld(correction_*frame->robotToWorld());
+    frame = frame->next();
+  }
+
+  //ds move tracked landmarks that are only present in local maps not yet contained in the pose graph
+  const Identifier& identifier_local_map = keyframe_->localMap()->identifier();
+  for (Landmark* landmark: _world_map->currentlyTrackedLandmarks()) {
+    bool is_in_pose_graph = false;
+    for (const LocalMap* local_map: landmark->localMaps()) {
+      if (local_map->identifier() <= identifier_local_map) {
+        is_in_pose_graph = true;
+        break;
+      }
+    }
+    if (!is_in_pose_graph) {
+      landmark->setCoordinates(correction_*landmark->coordinates());
+    }
+  }
+
+  //ds move current head to the corrected position
+  if (_world_map->currentFrame()) {
+    _world_map->setRobotToWorld(_world_map->currentFrame()->robotToWorld());
+  }
+}
+
+void SLAMAssembly::_updateLandmarkCoordinates() {
+
+  //ds the landmark coordinates of the moved local maps are computed without blocking the viewer (the map is not modified)
+  if (_map_viewer) {_map_viewer->unlock();}
+  _world_map->stageLandmarkCoordinates(_graph_optimizer->movedLocalMaps());
+  if (_map_viewer) {_map_viewer->lock();}
+  _world_map->commitLandmarkCoordinates();
+}
+
+const double SLAMAssembly::_getTimeConsumptionSeconds(const LatencyStage& stage_) const {
+  switch (stage_) {
+    case KEYPOINT_DETECTION: {
+      return _tracker->framepointGenerator()->getTimeConsumptionSeconds_keypoint_detection();
+    }
+    case DESCRIPTOR_EXTRACTION: {
+      return _tracker->framepointGenerator()->getTimeConsumptionSeconds_descriptor_extraction();
+    }
+    case TRIANGULATION: {
+      switch (_parameters->command_line_parameters->tracker_mode) {
+        case CommandLineParameters::TrackerMode::RGB_STEREO: {
+          return static_cast<const StereoFramePointGenerator*>(_tracker->framepointGenerator())->getTimeConsumptionSeconds_point_triangulation();
+        }
+        case CommandLineParameters::TrackerMode::RGB_DEPTH: {
+          const DepthFramePointGenerator* depth_framepoint_generator = static_cast<const DepthFramePointGenerator*>(_tracker->framepointGenerator());
+          return depth_framepoint_generator->getTimeConsumptionSeconds_depth_map_generation()+depth_framepoint_generator->getTimeConsumptionSeconds_depth_assignment();
+        }
+        default: {
+          return 0;
+        }
+      }
+    }
+    case TRACKING: {
+      return _tracker->getTimeConsumptionSeconds_tracking();
+    }
+    case POSE_OPTIMIZATION: {
+      return _tracker->getTimeConsumptionSeconds_pose_optimization();
+    }
+    case LANDMARK_OPTIMIZATION: {
+      return _tracker->getTimeConsumptionSeconds_landmark_optimization();
+    }
+    case POINT_RECOVERY: {
+      return _tracker->getTimeConsumptionSeconds_point_recovery();
+    }
+    case LOCAL_MAP_CREATION: {
+      return _world_map->getTimeConsumptionSeconds_local_map_creation();
+    }
+    case RELOCALIZATION: {
+      return _relocalizer->getTimeConsumptionSeconds_overall();
+    }
+    case OPTIMIZATION: {
+      return _graph_optimizer->getTimeConsumptionSeconds_optimization();
+    }
+    default: {
+      return 0;
+    }
+  }
+}
 }
@@ -1,6 +1,9 @@
 #include "qapplication.h"
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 
 #include "srrg_messages/message_reader.h"
 #include "srrg_messages/message_timestamp_synchronizer.h"
@@ -11,12 +14,31 @@
 #include "visualization/image_viewer.h"
 #include "visualization/map_viewer.h"
 #include "framepoint_generation/stereo_framepoint_generator.h"
+#include "types/latency_profiler.h"
 
 namespace proslam {
 
 //ds simple assembly of the different SLAM modules provided by ProSLAM
 class SLAMAssembly {
 
+//ds exported types
+public:
+
+  //! @brief processing stages with latency histograms (defines the order in the latency profile)
+  //! @brief frontend stages are sampled per frame, local map stages per created local map and optimization only if it was triggered
+  enum LatencyStage {FRAME,
+                     KEYPOINT_DETECTION,
+                     DESCRIPTOR_EXTRACTION,
+                     TRIANGULATION,
+                     TRACKING,
+                     POSE_OPTIMIZATION,
+                     LANDMARK_OPTIMIZATION,
+                     POINT_RECOVERY,
+                     LOCAL_MAP_CREATION,
+                     RELOCALIZATION,
+                     OPTIMIZATION,
+                     NUMBER_OF_LATENCY_STAGES};
+
 //ds object management
 public: EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
@@ -66,6 +88,10 @@ public:
   //ds prints extensive run summary
   void printReport() const;
 
+  //! @brief writes the per-stage latency profile to the configured JSON and CSV files (no effect for empty file names)
+  //! @brief can be called at any time, also while processing (recording is only blocked for the duration of the export)
+  void writeLatencyProfile() const;
+
   //! @brief dump trajectory to file (in KITTI benchmark format: 4x4 isometries per line)
   //! @param[in] file_name_ text file path in which the poses are saved to
   void writeTrajectoryKITTI(const std::string& file_name_ = "") const {if (_world_map) {_world_map->writeTrajectoryKITTI(file_name_);}}
@@ -87,11 +113,21 @@ public:
   //! @brief resets the complete pipeline, releasing memory
   void reset();
 
+  //! @brief blocks until all local maps queued for the backend or submitted to the asynchronous relocalizer have been processed
+  //! @brief no effect if neither the backend thread nor the asynchronous relocalizer is active
+  //! @brief after hierarchical pose graph optimizations the complete (flat) pose graph is optimized
+  void flushBackend();
+
 //ds getters/setters
 public:
 
   void requestTermination() {_is_termination_requested = true;}
+
+  //! @brief requests a latency profile export after the current frame during playback (safe to call from a signal handler)
+  void requestLatencyProfileExport() {_is_latency_profile_export_requested = true;}
+  const LatencyProfiler& latencyProfiler() const {return _latency_profiler;}
   const bool isViewerOpen() const {return _is_viewer_open;}
+  const WorldMap* worldMap() const {return _world_map;}
   const double currentFPS() const {return _current_fps;}
   const double averageNumberOfLandmarksPerFrame() const {return _tracker->totalNumberOfLandmarks()/_number_of_processed_frames;}
   const double averageNumberOfTracksPerFrame() const {return _tracker->totalNumberOfTrackedPoints()/_number_of_processed_frames;}
@@ -106,6 +142,43 @@ protected:
 
   void _createDepthTracker(Camera* camera_left_, Camera* camera_right_);
 
+  //! @brief launches the backend worker (relocalization and pose graph optimization)
+  void _startBackend();
+
+  //! @brief processes all remaining local maps in the backend queue and joins the backend worker
+  void _stopBackend();
+
+  //! @brief backend worker loop: consumes local maps from the backend queue until termination is requested
+  void _processBackend();
+
+  //! @brief relocalization and pose graph optimization for a single local map (backend)
+  //! @param[in] local_map_ the local map to close, created by the frontend
+  void _processLocalMapInBackend(LocalMap* local_map_);
+
+  //! @brief adds the valid closures in the relocalizer buffer as loop closure constraints to the world map
+  //! @param[in] local_map_query_ the local map for which the closures have been detected
+  //! @return number of added closures
+  const Count _addLoopClosures(LocalMap* local_map_query_);
+
+  //! @brief verifies and integrates the closures of completed asynchronous relocalizer queries, followed by a single pose graph optimization
+  //! @brief landmark merges of the closed local maps are held back until the relocalizer is idle: the worker reads the place database
+  //! @brief (whose matchables reference landmarks) and completed queries hold landmark pointers, both invalidated by a merge
+  //! @param[in] wait_ block until all local maps submitted to the relocalizer have been processed
+  void _integrateClosures(const bool& wait_ = false);
+
+  //! @brief rigidly moves all frames tracked after the provided keyframe, as well as tracked landmarks that are not yet part of the pose graph
+  //! @param[in] keyframe_ the keyframe that was corrected by the backend
+  //! @param[in] correction_ world correction of the keyframe (new pose times inverse old pose)
+  void _applyPoseCorrection(Frame* keyframe_, const TransformMatrix3D& correction_);
+
+  //! @brief propagates the last pose graph solution to the landmarks of the moved local maps (viewer locked by the caller)
+  //! @brief the viewer is only locked for the assignment of the computed coordinates
+  void _updateLandmarkCoordinates();
+
+  //! @brief accumulated processing time of a stage, as measured by the chronometers of the responsible modules
+  //! @param[in] stage_ the stage (FRAME is not covered by a chronometer and returns 0)
+  const double _getTimeConsumptionSeconds(const LatencyStage& stage_) const;
+
 //ds SLAM modules
 protected:
 
@@ -130,6 +203,9 @@ protected:
 
   Identifier _last_freed_landmark_identifier = 0;
 
+  //! @brief closed local maps whose landmarks have not been merged yet (asynchronous relocalization, see _integrateClosures)
+  LocalMapPointerVector _local_maps_pending_merge;
+
 //ds visualization only
 protected:
 
@@ -160,6 +236,28 @@ protected:
   //! @brief flag that is checked if an OpenGL or OpenCV window is currently active
   std::atomic<bool> _is_viewer_open;
 
+//ds backend processing (only active with option_use_backend_thread)
+protected:
+
+  //! @brief backend worker thread
+  std::shared_ptr<std::thread> _backend_thread = nullptr;
+
+  //! @brief local maps created by the frontend, waiting for relocalization and pose graph optimization
+  std::deque<LocalMap*> _backend_queue;
+
+  //! @brief backend queue access and notification
+  std::mutex _mutex_backend_queue;
+  std::condition_variable _backend_queue_changed;
+
+  //! @brief set while the backend is processing a local map (guarded by _mutex_backend_queue)
+  bool _is_backend_busy = false;
+
+  //! @brief set to terminate the backend worker once its queue is empty (guarded by _mutex_backend_queue)
+  bool _is_backend_termination_requested = false;
+
+  //! @brief world map access: held by the frontend for a complete process call and by the backend only while modifying the map
+  std::mutex _mutex_world_map;
+
 //ds informative only
 protected:
 
@@ -174,5 +272,11 @@ protected:
 
   //! @brief current average fps
   double _current_fps = 0;
+
+  //! @brief per-stage latency histograms (p50/p95/p99/max), fed by the frontend and the backend
+  LatencyProfiler _latency_profiler;
+
+  //! @brief set to export the latency profile after the current frame
+  std::atomic<bool> _is_latency_profile_export_requested;
 };
 }
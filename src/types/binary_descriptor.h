@@ -0,0 +1,136 @@
+#pragma once
+#include <cstring>
+#if defined(__AVX2__) || (defined(__POPCNT__) && defined(__x86_64__))
+  #include <immintrin.h>
+#endif
+#include "definitions.h"
+
+namespace proslam {
+
+//ds number of 64 bit blocks per binary descriptor
+#define SRRG_PROSLAM_DESCRIPTOR_SIZE_BLOCKS SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS/64
+
+//ds implementation details - not to be used outside of this header
+namespace detail {
+
+  //! @brief storage of the active descriptor bit size (function-local static, one instance for all translation units)
+  inline uint32_t& descriptorSizeBits() {
+    static uint32_t descriptor_size_bits = SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS;
+    return descriptor_size_bits;
+  }
+} //namespace detail
+
+//! @brief returns the active descriptor bit size (128, 256 or 512, at most SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS)
+//! @brief the active size is selected at runtime by the descriptor extractor, SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS is the storage size
+inline const uint32_t& getDescriptorSizeBits() {return detail::descriptorSizeBits();}
+
+//! @brief sets the active descriptor bit size, has to be called before any descriptor is created or compared (e.g. in configure)
+//! @param[in] descriptor_size_bits_ 128, 256 or 512 bits, throws if not supported by the compiled storage size
+inline void setDescriptorSizeBits(const uint32_t& descriptor_size_bits_) {
+  if ((descriptor_size_bits_ != 128 && descriptor_size_bits_ != 256 && descriptor_size_bits_ != 512) ||
+      descriptor_size_bits_ > SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS) {
+    throw std::runtime_error("setDescriptorSizeBits|unsupported descriptor size: " + std::to_string(descriptor_size_bits_) +
+                             " (supported: 128, 256, 512 bits up to SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS: " + std::to_string(SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS) + ")");
+  }
+  detail::descriptorSizeBits() = descriptor_size_bits_;
+}
+
+//! @brief converts a descriptor distance configured for the storage size (SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS) to the active size
+//! @param[in] descriptor_distance_ Hamming distance threshold in bits, given for descriptors of the storage size
+//! @return the threshold for descriptors of the active size (identical if the active size is the storage size)
+inline real getScaledDescriptorDistance(const real& descriptor_distance_) {
+  return descriptor_distance_*getDescriptorSizeBits()/SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS;
+}
+
+//! @brief maps a descriptor bit size to an instantiable one (sizes above the storage size are never active, see setDescriptorSizeBits)
+constexpr uint32_t getStorableDescriptorSizeBits(const uint32_t descriptor_size_bits_) {
+  return (descriptor_size_bits_ < SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS) ? descriptor_size_bits_ : SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS;
+}
+
+//! @struct binary descriptor stored in a fixed-size, aligned array of 64 bit blocks
+//! @brief used in all matching loops instead of cv::Mat rows (no header dispatch, no reference counting)
+//! @brief 16 byte alignment is the largest alignment C++11 operator new guarantees (heap allocated features and framepoints)
+//! @brief descriptors of an active size below the storage size are zero padded (padding does not contribute to Hamming distances)
+struct alignas(16) BinaryDescriptor {
+  static_assert(SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS%64 == 0, "SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS must be a multiple of 64");
+
+  BinaryDescriptor() {std::memset(blocks, 0, DESCRIPTOR_SIZE_BYTES);}
+
+  //! @brief copies the bytes of a single OpenCV descriptor row (CV_8U, active descriptor size columns)
+  explicit BinaryDescriptor(const cv::Mat& descriptor_) {
+    assert(descriptor_.rows == 1 && descriptor_.cols <= DESCRIPTOR_SIZE_BYTES && descriptor_.type() == CV_8U);
+    std::memset(blocks, 0, DESCRIPTOR_SIZE_BYTES);
+    std::memcpy(blocks, descriptor_.ptr<uchar>(0), descriptor_.cols);
+  }
+
+  //! @brief returns a newly allocated OpenCV descriptor row with the same bytes, including padding (storage size, e.g. for HBST)
+  //! @brief the zero padding does not change Hamming distances, hence thresholds for the active size apply to the storage size row
+  cv::Mat toMat() const {
+    cv::Mat descriptor(1, DESCRIPTOR_SIZE_BYTES, CV_8U);
+    std::memcpy(descriptor.ptr<uchar>(0), blocks, DESCRIPTOR_SIZE_BYTES);
+    return descriptor;
+  }
+
+  uint64_t blocks[SRRG_PROSLAM_DESCRIPTOR_SIZE_BLOCKS];
+};
+
+//! @brief number of set bits in a 64 bit block: hardware popcnt (SSE4.2) or portable SWAR fallback
+inline uint32_t getNumberOfSetBits(const uint64_t& block_) {
+#if defined(__POPCNT__) && defined(__x86_64__)
+  return _mm_popcnt_u64(block_);
+#else
+  uint64_t count = block_-((block_ >> 1) & 0x5555555555555555ULL);
+  count = (count & 0x3333333333333333ULL)+((count >> 2) & 0x3333333333333333ULL);
+  count = (count+(count >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return (count*0x0101010101010101ULL) >> 56;
+#endif
+}
+
+//! @class Hamming distance kernel, specialized at compile time on the descriptor bit size
+//! @brief the AVX2 variant processes 256 bit lanes with a nibble lookup popcount (Mula et al.), remaining blocks are processed with getNumberOfSetBits
+template<uint32_t NUMBER_OF_BITS>
+struct HammingDistance {
+  static inline uint32_t compute(const uint64_t* a_, const uint64_t* b_) {
+    uint32_t distance = 0;
+    uint32_t index_block = 0;
+#ifdef __AVX2__
+    //ds unaligned loads since descriptors are only 16 byte aligned (no penalty on AVX2 hardware)
+    const __m256i lookup   = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                              0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0F);
+    __m256i sums           = _mm256_setzero_si256();
+    for (; index_block+4 <= NUMBER_OF_BITS/64; index_block += 4) {
+      const __m256i x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a_+index_block)),
+                                         _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b_+index_block)));
+      const __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(x, low_mask)),
+                                             _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(x, 4), low_mask)));
+      sums = _mm256_add_epi64(sums, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+    }
+    distance = _mm256_extract_epi64(sums, 0)+_mm256_extract_epi64(sums, 1)+_mm256_extract_epi64(sums, 2)+_mm256_extract_epi64(sums, 3);
+#endif
+    for (; index_block < NUMBER_OF_BITS/64; ++index_block) {
+      distance += getNumberOfSetBits(a_[index_block]^b_[index_block]);
+    }
+    return distance;
+  }
+};
+
+//! @brief Hamming distance between two descriptors of a fixed size (fully unrolled, for loops that dispatch once on getDescriptorSizeBits)
+template<uint32_t NUMBER_OF_BITS>
+inline uint32_t getDescriptorDistance(const BinaryDescriptor& a_, const BinaryDescriptor& b_) {
+  return HammingDistance<getStorableDescriptorSizeBits(NUMBER_OF_BITS)>::compute(a_.blocks, b_.blocks);
+}
+
+//! @brief Hamming distance kernel for descriptors of a fixed size
+typedef uint32_t (*DescriptorDistanceKernel)(const BinaryDescriptor& a_, const BinaryDescriptor& b_);
+
+//! @brief returns the Hamming distance kernel of the active descriptor size (getDescriptorSizeBits)
+//! @brief to be retrieved once (e.g. in configure) instead of dispatching on the active size for every comparison
+inline DescriptorDistanceKernel getDescriptorDistanceKernel() {
+  switch (getDescriptorSizeBits()) {
+    case 128: {return &getDescriptorDistance<128>;}
+    case 512: {return &getDescriptorDistance<512>;}
+    default:  {return &getDescriptorDistance<256>;}
+  }
+}
+} //namespace proslam
@@ -40,7 +40,7 @@ namespace proslam {
       SUBCLASS_NAME(PARAMETERS_TYPE* parameters_); \
       virtual ~SUBCLASS_NAME();
 
-  //ds descriptor bit width
+  //ds descriptor storage bit width (maximum descriptor size selectable at runtime)
 #ifndef SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS
   #define SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS 256
 #endif
@@ -5,6 +5,7 @@
 namespace proslam {
 
 Count Frame::_instances = 0;
+Count Frame::_number_of_buffer_allocations = 0;
 
 Frame::Frame(const WorldMap* context_,
              Frame* previous_,
@@ -26,6 +27,9 @@ Frame::Frame(const WorldMap* context_,
 }
 
 Frame::~Frame() {
+  if (!_is_compacted) {
+    _countExternalBufferAllocations();
+  }
   clear();
 }
 
@@ -66,7 +70,8 @@ FramePoint* Frame::createFramepoint(const IntensityFeature* feature_left_,
   assert(_camera_left);
 
   //ds allocate a new point connected to the previous one
-  FramePoint* frame_point = new FramePoint(feature_left_, feature_right_, descriptor_distance_triangulation_, this);
+  FramePoint* frame_point = (_framepoint_pool)? _framepoint_pool->create(feature_left_, feature_right_, descriptor_distance_triangulation_, this)
+                                               : new FramePoint(feature_left_, feature_right_, descriptor_distance_triangulation_, this);
   frame_point->setCameraCoordinatesLeft(camera_coordinates_left_);
   frame_point->setRobotCoordinates(_camera_left->cameraToRobot()*camera_coordinates_left_);
   frame_point->setWorldCoordinates(_robot_to_world*frame_point->robotCoordinates());
@@ -79,7 +84,7 @@ FramePoint* Frame::createFramepoint(const IntensityFeature* feature_left_,
   }
 
   //ds bookkeep each generated point for resize immune memory management (TODO remove costly bookkeeping)
-  _created_points.push_back(frame_point);
+  countedPushBack(_created_points, frame_point, _number_of_buffer_allocations);
   return frame_point;
 }
 
@@ -89,7 +94,7 @@ FramePoint* Frame::createFramepoint(const IntensityFeature* feature_left_,
   assert(_camera_left);
 
   //ds allocate a new point connected to the previous one
-  FramePoint* frame_point = new FramePoint(feature_left_, this);
+  FramePoint* frame_point = (_framepoint_pool)? _framepoint_pool->create(feature_left_, this): new FramePoint(feature_left_, this);
   frame_point->setCameraCoordinatesLeft(camera_coordinates_left_);
   frame_point->setRobotCoordinates(_camera_left->cameraToRobot()*camera_coordinates_left_);
   frame_point->setWorldCoordinates(_robot_to_world*frame_point->robotCoordinates());
@@ -102,7 +107,7 @@ FramePoint* Frame::createFramepoint(const IntensityFeature* feature_left_,
   }
 
   //ds bookkeep each generated point for resize immune memory management (TODO remove costly bookkeeping)
-  _created_points.push_back(frame_point);
+  countedPushBack(_created_points, frame_point, _number_of_buffer_allocations);
   return frame_point;
 }
 
@@ -111,7 +116,7 @@ FramePoint* Frame::createFramepoint(const IntensityFeature* feature_left_,
   assert(_camera_left);
 
   //ds allocate a new point connected to the previous one
-  FramePoint* frame_point = new FramePoint(feature_left_, this);
+  FramePoint* frame_point = (_framepoint_pool)? _framepoint_pool->create(feature_left_, this): new FramePoint(feature_left_, this);
 
   //ds the point does not have a valid position yet
   frame_point->_has_unreliable_depth = true;
@@ -124,16 +129,24 @@ FramePoint* Frame::createFramepoint(const IntensityFeature* feature_left_,
   }
 
   //ds bookkeep each generated point for resize immune memory management (TODO remove costly bookkeeping)
-  _created_points.push_back(frame_point);
+  countedPushBack(_created_points, frame_point, _number_of_buffer_allocations);
 
   //ds this point enters in the temporary points buffer as it has unreliable depth
-  _temporary_points.push_back(frame_point);
+  countedPushBack(_temporary_points, frame_point, _number_of_buffer_allocations);
   return frame_point;
 }
 
 void Frame::clear() {
-  for (const FramePoint* frame_point: _created_points) {
-    delete frame_point;
+
+  //ds return all points to the world map pool if available (no heap deallocations)
+  if (_framepoint_pool) {
+    for (FramePoint* frame_point: _created_points) {
+      _framepoint_pool->destroy(frame_point);
+    }
+  } else {
+    for (const FramePoint* frame_point: _created_points) {
+      delete frame_point;
+    }
   }
   _created_points.clear();
   _active_points.clear();
@@ -142,6 +155,51 @@ void Frame::clear() {
   _keypoints_right.clear();
 }
 
+void Frame::compact() {
+  _countExternalBufferAllocations();
+  clear();
+
+  //ds release buffer memory as well
+  FramePointPointerVector().swap(_created_points);
+  FramePointPointerVector().swap(_active_points);
+  FramePointPointerVector().swap(_temporary_points);
+  std::vector<cv::KeyPoint>().swap(_keypoints_left);
+  std::vector<cv::KeyPoint>().swap(_keypoints_right);
+  _descriptors_left.release();
+  _descriptors_right.release();
+  releaseImages();
+  _is_compacted = true;
+}
+
+const size_t Frame::sizeBytes() const {
+  size_t size_bytes = _intensity_image_left.total()*_intensity_image_left.elemSize()
+                     +_intensity_image_right.total()*_intensity_image_right.elemSize()
+                     +(_keypoints_left.capacity()+_keypoints_right.capacity())*sizeof(cv::KeyPoint)
+                     +_descriptors_left.total()*_descriptors_left.elemSize()
+                     +_descriptors_right.total()*_descriptors_right.elemSize()
+                     +(_created_points.capacity()+_active_points.capacity()+_temporary_points.capacity())*sizeof(FramePoint*);
+  for (Index level = 1; level < _image_pyramid_left.size(); ++level) {
+    size_bytes += _image_pyramid_left[level].total()*_image_pyramid_left[level].elemSize();
+  }
+
+  //ds framepoints (descriptors are stored in place), and the landmark measurements they contributed
+  for (const FramePoint* frame_point: _created_points) {
+    size_bytes += sizeof(FramePoint);
+    if (frame_point->landmark()) {
+      size_bytes += sizeof(Landmark::Measurement);
+    }
+  }
+  return size_bytes;
+}
+
+void Frame::_countExternalBufferAllocations() const {
+
+  //ds buffers filled by the framepoint generators were allocated at least once if they hold memory
+  if (_active_points.capacity() > 0) {++_number_of_buffer_allocations;}
+  if (_keypoints_left.capacity() > 0) {++_number_of_buffer_allocations;}
+  if (_keypoints_right.capacity() > 0) {++_number_of_buffer_allocations;}
+}
+
 void Frame::updateActivePoints() {
   for (FramePoint* point: _active_points) {
     point->setWorldCoordinates(_robot_to_world*point->robotCoordinates());
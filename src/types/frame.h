@@ -2,6 +2,7 @@
 #include "parameters.h"
 #include "camera.h"
 #include "frame_point.h"
+#include "object_pool.h"
 
 namespace proslam {
   
@@ -117,7 +118,11 @@ public:
   inline const cv::Mat& intensityImageRight() const {return _intensity_image_right;}
   inline cv::Mat& intensityImageRight() {return _intensity_image_right;}
   void setIntensityImageRight(const cv::Mat intensity_image_)  {_intensity_image_right = intensity_image_;}
-  void releaseImages() {_intensity_image_left.release(); _intensity_image_right.release();}
+  void releaseImages() {_intensity_image_left.release(); _intensity_image_right.release(); _image_pyramid_left.clear();}
+
+  //! @brief left intensity image pyramid (level 0 is the full resolution image), built on demand for coarse-to-fine tracking
+  inline const std::vector<cv::Mat>& imagePyramidLeft() const {return _image_pyramid_left;}
+  void setImagePyramidLeft(const std::vector<cv::Mat>& image_pyramid_) {_image_pyramid_left = image_pyramid_;}
 
   inline const Status& status() const {return _status;}
   void setStatus(const Status& status_) {_status = status_;}
@@ -132,6 +137,13 @@ public:
   //ds free all point instances
   void clear();
 
+  //! @brief drops all point, feature and image data, keeping only pose, timestamp and links (frame leaves the sliding window)
+  void compact();
+  const bool& isCompacted() const {return _is_compacted;}
+
+  //! @brief estimated memory footprint of the point, feature and image data in bytes (excluding the instance itself)
+  const size_t sizeBytes() const;
+
   //ds update framepoint world coordinates
   void updateActivePoints();
 
@@ -142,7 +154,12 @@ public:
   const real& averageDescriptorDistanceTracking() const {return _average_descriptor_distance;}
 
   //ds reset allocated object counter
-  static void reset() {_instances = 0;}
+  static void reset() {_instances = 0; _number_of_buffer_allocations = 0;}
+
+  //! @brief number of heap allocations of framepoint bookkeeping buffers by all frames (not covered by the frame pool counters)
+  //! @brief buffers filled by the framepoint generators (active points, keypoints) count once per frame when it is compacted or destroyed,
+  //! @brief images and descriptor matrices are not counted
+  static const Count& numberOfBufferAllocations() {return _number_of_buffer_allocations;}
 
 //ds attributes
 protected:
@@ -205,11 +222,18 @@ protected:
   //ds to support arbitrary number of rgb/depth image combinations
   cv::Mat _intensity_image_left;
   cv::Mat _intensity_image_right;
+  std::vector<cv::Mat> _image_pyramid_left;
 
   //ds link to a local map if the frame is part of one
   LocalMap* _local_map;
   bool _is_keyframe  = false;
 
+  //! @brief set once the frame has been compacted (no points, features or images)
+  bool _is_compacted = false;
+
+  //! @brief framepoint memory provided by the world map (framepoints are heap allocated if not set, e.g. for standalone frames)
+  ObjectPool<FramePoint>* _framepoint_pool = nullptr;
+
   //ds access
   friend class WorldMap;
 
@@ -223,6 +247,12 @@ protected:
 
     //ds inner instance count - incremented upon constructor call (also unsuccessful calls)
     static Count _instances;
+
+    //! @brief informative only
+    static Count _number_of_buffer_allocations;
+
+    //! @brief counts the buffers filled by the framepoint generators (lower bound, reallocations are not visible to the frame)
+    void _countExternalBufferAllocations() const;
 };
 
 typedef std::vector<Frame*> FramePointerVector;
@@ -14,8 +14,8 @@ FramePoint::FramePoint(const IntensityFeature* feature_left_,
                                        _frame(frame_),
                                        _keypoint_left(feature_left_->keypoint),
                                        _keypoint_right(feature_right_->keypoint),
-                                       _descriptor_left(feature_left_->descriptor),
-                                       _descriptor_right(feature_right_->descriptor),
+                                       _binary_descriptor_left(feature_left_->descriptor),
+                                       _binary_descriptor_right(feature_right_->descriptor),
                                        _disparity_pixels(feature_left_->keypoint.pt.x-feature_right_->keypoint.pt.x),
                                        _descriptor_distance_triangulation(descriptor_distance_triangulation_),
                                        _image_coordinates_left(ImageCoordinates(feature_left_->keypoint.pt.x, feature_left_->keypoint.pt.y, 1)),
@@ -29,7 +29,7 @@ FramePoint::FramePoint(const IntensityFeature* feature_left_,
                                        _identifier(_instances),
                                        _frame(frame_),
                                        _keypoint_left(feature_left_->keypoint),
-                                       _descriptor_left(feature_left_->descriptor),
+                                       _binary_descriptor_left(feature_left_->descriptor),
                                        _disparity_pixels(0),
                                        _descriptor_distance_triangulation(0),
                                        _image_coordinates_left(ImageCoordinates(feature_left_->keypoint.pt.x, feature_left_->keypoint.pt.y, 1)) {
@@ -64,7 +64,11 @@ void FramePoint::clear() {
   if (_next) {
     _next->_previous = nullptr;
     if (_next->_origin == this) {
-      _next->_origin = _next;
+
+      //ds the next point becomes the track origin for the remaining track (e.g. when freeing the oldest frames)
+      for (FramePoint* point = _next; point; point = point->_next) {
+        point->_origin = _next;
+      }
     }
   }
   if (_landmark) {
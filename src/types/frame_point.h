@@ -1,5 +1,5 @@
 #pragma once
-#include "definitions.h"
+#include "binary_descriptor.h"
 #include "srrg_hbst/types/binary_tree.hpp"
 
 namespace proslam {
@@ -7,6 +7,7 @@ namespace proslam {
 //ds forward declarations
 class Landmark;
 class Frame;
+template<typename ObjectType> class ObjectPool;
 
 //ds HBST: readability
 typedef srrg_hbst::BinaryMatchable<Landmark*, SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS> HBSTMatchable;
@@ -14,28 +15,26 @@ typedef srrg_hbst::BinaryNode<HBSTMatchable, real> HBSTNode;
 typedef HBSTNode::MatchableVector AppearanceVector;
 typedef srrg_hbst::BinaryTree<HBSTNode> HBSTTree;
 
-//! @struct container holding spatial and appearance information (used in findStereoKeypoints)
+//! @struct container holding spatial and appearance information of a single feature (handed to framepoint construction)
 struct IntensityFeature {
 
   IntensityFeature(): row(0), col(0), index_in_vector(0) {}
 
   IntensityFeature(const cv::KeyPoint& keypoint_,
-                   const cv::Mat& descriptor_,
+                   const BinaryDescriptor& descriptor_,
                    const size_t& index_in_vector_): keypoint(keypoint_),
                                                     descriptor(descriptor_),
                                                     row(keypoint_.pt.y),
                                                     col(keypoint_.pt.x),
                                                     index_in_vector(index_in_vector_) {}
-  cv::KeyPoint keypoint;  //ds geometric: feature location in 2D
-  cv::Mat descriptor;     //ds appearance: feature descriptor
-  int32_t row;            //ds pixel column coordinate (v)
-  int32_t col;            //ds pixel row coordinate (u)
-  size_t index_in_vector; //ds inverted index for vector containing this
+  cv::KeyPoint keypoint;       //ds geometric: feature location in 2D
+  BinaryDescriptor descriptor; //ds appearance: feature descriptor (copied, independent of the source cv::Mat)
+  int32_t row;                 //ds pixel column coordinate (v)
+  int32_t col;                 //ds pixel row coordinate (u)
+  size_t index_in_vector;      //ds index in the feature store containing this
 
 };
 
-typedef std::vector<IntensityFeature*> IntensityFeaturePointerVector;
-
 //ds this class encapsulates the triangulation information of a salient point in the image and can be linked to a previous FramePoint instance and a Landmark
 class FramePoint {
 public: EIGEN_MAKE_ALIGNED_OPERATOR_NEW
@@ -116,8 +115,8 @@ public:
   //ds measured properties
   inline const cv::KeyPoint& keypointLeft() const {return _keypoint_left;}
   inline const cv::KeyPoint& keypointRight() const {return _keypoint_right;}
-  inline const cv::Mat& descriptorLeft() const {return _descriptor_left;}
-  inline const cv::Mat& descriptorRight() const {return _descriptor_right;}
+  inline const BinaryDescriptor& binaryDescriptorLeft() const {return _binary_descriptor_left;}
+  inline const BinaryDescriptor& binaryDescriptorRight() const {return _binary_descriptor_right;}
   inline const real& disparityPixels() const {return _disparity_pixels;}
 
   //ds reset allocated object counter
@@ -148,8 +147,8 @@ protected:
   //ds triangulation information (set by StereoFramePointGenerator)
   const cv::KeyPoint _keypoint_left;
   const cv::KeyPoint _keypoint_right;
-  const cv::Mat _descriptor_left;
-  const cv::Mat _descriptor_right;
+  const BinaryDescriptor _binary_descriptor_left;  //ds stored in place (no heap memory), converted only for HBST
+  const BinaryDescriptor _binary_descriptor_right;
   const real _disparity_pixels;
   real _descriptor_distance_triangulation;
   const ImageCoordinates _image_coordinates_left;
@@ -175,6 +174,7 @@ protected:
 
   //ds grant access to factory for constructor calls
   friend Frame;
+  friend ObjectPool<FramePoint>;
 
   //ds visualization only
   cv::Point2f _projection_estimate_left;
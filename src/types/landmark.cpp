@@ -4,6 +4,7 @@
 namespace proslam {
 
 Count Landmark::_instances = 0;
+Count Landmark::_number_of_buffer_allocations = 0;
 
 Landmark::Landmark(FramePoint* point_, const LandmarkParameters* parameters_): _identifier(_instances),
                                                                                 _parameters(parameters_) {
@@ -21,8 +22,8 @@ Landmark::Landmark(FramePoint* point_, const LandmarkParameters* parameters_): _
   while (framepoint) {
     assert(framepoint->landmark() == nullptr);
     framepoint->setLandmark(this);
-    _measurements.push_back(Measurement(framepoint));
-    _descriptors.push_back(framepoint->descriptorLeft());
+    countedPushBack(_measurements, Measurement(framepoint), _number_of_buffer_allocations);
+    countedPushBack(_descriptors, framepoint->binaryDescriptorLeft(), _number_of_buffer_allocations);
     _origin = framepoint;
     _world_coordinates += framepoint->worldCoordinates();
     framepoint = framepoint->previous();
@@ -75,8 +76,11 @@ void Landmark::update(FramePoint* point_) {
   _last_update->setLandmark(this);
 
   //ds update appearance history (left descriptors only)
-  _descriptors.push_back(_last_update->descriptorLeft());
-  _measurements.push_back(Measurement(_last_update));
+  countedPushBack(_descriptors, _last_update->binaryDescriptorLeft(), _number_of_buffer_allocations);
+  countedPushBack(_measurements, Measurement(_last_update), _number_of_buffer_allocations);
+
+  //ds keep the optimization window constant (each update is independent of the track length)
+  _marginalizeMeasurements();
 
   //ds trigger classic ICP in camera update of landmark coordinates - setup
   Vector3 world_coordinates(_world_coordinates);
@@ -94,7 +98,15 @@ void Landmark::update(FramePoint* point_) {
     real total_error_squared    = 0;
     uint32_t number_of_outliers = 0;
 
-    //ds for each measurement
+    //ds prior of the marginalized measurements (world coordinates, identity jacobian)
+    if (_prior_information > 0) {
+      const Vector3 error(world_coordinates-_prior_coordinates);
+      total_error_squared += _prior_information*error.squaredNorm();
+      H += _prior_information*Matrix3::Identity();
+      b += _prior_information*error;
+    }
+
+    //ds for each measurement in the window
     for (const Measurement& measurement: _measurements) {
       omega.setIdentity();
 
@@ -137,7 +149,10 @@ void Landmark::update(FramePoint* point_) {
 
     //ds check convergence
     if (std::fabs(total_error_squared-total_error_squared_previous) < 1e-5 || iteration == 999) {
-      const uint32_t number_of_inliers = _measurements.size()-number_of_outliers;
+
+      //ds inlier statistics over the complete track (marginalized measurements keep their classification)
+      number_of_outliers += _number_of_marginalized_outliers;
+      const uint32_t number_of_inliers = _measurements.size()+_number_of_marginalized_inliers+_number_of_marginalized_outliers-number_of_outliers;
 
       //ds if the number of inliers is higher than the best so far
       if (number_of_inliers > _number_of_updates) {
@@ -149,14 +164,20 @@ void Landmark::update(FramePoint* point_) {
       //ds if optimization failed and we have less inliers than outliers - reset initial guess
       } else if (number_of_inliers < number_of_outliers) {
 
-        //ds reset estimate based on overall average
+        //ds reset estimate based on overall average (the marginalized measurements are represented by the prior)
         PointCoordinates world_coordinates_accumulated(PointCoordinates::Zero());
         for (const Measurement& measurement: _measurements) {
           world_coordinates_accumulated += measurement.frame->cameraLeftToWorld()*measurement.camera_coordinates;
         }
+        Count number_of_measurements = _measurements.size();
+        if (_prior_information > 0) {
+          const Count number_of_marginalized_measurements = _number_of_marginalized_inliers+_number_of_marginalized_outliers;
+          world_coordinates_accumulated += static_cast<real>(number_of_marginalized_measurements)*_prior_coordinates;
+          number_of_measurements        += number_of_marginalized_measurements;
+        }
 
         //ds set landmark state without increasing update count
-        _world_coordinates = world_coordinates_accumulated/_measurements.size();
+        _world_coordinates = world_coordinates_accumulated/number_of_measurements;
       }
       break;
     }
@@ -173,8 +194,8 @@ void Landmark::merge(Landmark* landmark_) {
   }
   assert(landmark_);
   assert(_identifier < landmark_->_identifier);
-  assert(_origin != landmark_->_origin);
-  assert(_origin->identifier() < landmark_->_origin->identifier());
+  assert(_is_archived || landmark_->_is_archived || _origin != landmark_->_origin);
+  assert(_is_archived || landmark_->_is_archived || _origin->identifier() < landmark_->_origin->identifier());
 
   //ds merge landmark appearances (owned by HBST for relocalization)
   for (auto& appearance: landmark_->_appearance_map) {
@@ -191,6 +212,7 @@ void Landmark::merge(Landmark* landmark_) {
   landmark_->_local_maps.clear();
 
   //ds merge descriptors
+  if (_descriptors.size()+landmark_->_descriptors.size() > _descriptors.capacity()) {++_number_of_buffer_allocations;}
   _descriptors.insert(_descriptors.end(), landmark_->_descriptors.begin(), landmark_->_descriptors.end());
   landmark_->_descriptors.clear();
 
@@ -202,9 +224,36 @@ void Landmark::merge(Landmark* landmark_) {
   //ds update measurements
   _number_of_updates    += landmark_->_number_of_updates;
   _number_of_recoveries += landmark_->_number_of_recoveries;
+  if (_measurements.size()+landmark_->_measurements.size() > _measurements.capacity()) {++_number_of_buffer_allocations;}
   _measurements.insert(_measurements.end(), landmark_->_measurements.begin(), landmark_->_measurements.end());
   landmark_->_measurements.clear();
 
+  //ds fuse marginalized measurements (the window is restored with the next update)
+  if (landmark_->_prior_information > 0) {
+    _prior_coordinates  = (_prior_information*_prior_coordinates+landmark_->_prior_information*landmark_->_prior_coordinates)
+                          /(_prior_information+landmark_->_prior_information);
+    _prior_information += landmark_->_prior_information;
+  }
+  _number_of_marginalized_inliers  += landmark_->_number_of_marginalized_inliers;
+  _number_of_marginalized_outliers += landmark_->_number_of_marginalized_outliers;
+
+  //ds an archived landmark has no framepoints to relink - it takes over the track of the absorbed landmark if available
+  if (landmark_->_is_archived) {
+    landmark_->_origin      = nullptr;
+    landmark_->_last_update = nullptr;
+    return;
+  } else if (_is_archived) {
+    _origin      = landmark_->_origin;
+    _last_update = landmark_->_last_update;
+    for (FramePoint* point = _origin; point; point = point->next()) {
+      point->setLandmark(this);
+    }
+    _is_archived = false;
+    landmark_->_origin      = nullptr;
+    landmark_->_last_update = nullptr;
+    return;
+  }
+
   assert(!landmark_->_origin->previous());
   assert(landmark_->_origin->next());
   assert(landmark_->_origin->identifier() != _last_update->identifier());
@@ -263,4 +312,58 @@ void Landmark::merge(Landmark* landmark_) {
   landmark_->_origin = nullptr;
   landmark_->_last_update = nullptr;
 }
+
+void Landmark::archive() {
+
+  //ds decouple itself from all remaining framepoints (including untracked ones at the end of the track)
+  FramePoint* point = _origin;
+  while (point) {
+    point->setLandmark(nullptr);
+    point = point->next();
+  }
+  _origin      = nullptr;
+  _last_update = nullptr;
+
+  //ds release measurement memory (the measured frames have been compacted)
+  MeasurementVector().swap(_measurements);
+  std::vector<BinaryDescriptor>().swap(_descriptors);
+  _is_currently_tracked = false;
+  _is_archived          = true;
+}
+
+void Landmark::_marginalizeMeasurements() {
+  const Count& number_of_measurements_in_window = _parameters->number_of_measurements_in_window;
+  if (number_of_measurements_in_window == 0 || _measurements.size() <= number_of_measurements_in_window) {
+    return;
+  }
+  const Count number_of_measurements_to_marginalize = _measurements.size()-number_of_measurements_in_window;
+
+  //ds fuse the oldest measurements into the prior
+  for (Index index = 0; index < number_of_measurements_to_marginalize; ++index) {
+    const Measurement& measurement = _measurements[index];
+
+    //ds measurements behind the camera do not contribute (same as in the optimization)
+    const PointCoordinates camera_coordinates_sampled = measurement.frame->worldToCameraLeft()*_world_coordinates;
+    if (camera_coordinates_sampled.z() <= 0) {
+      ++_number_of_marginalized_outliers;
+      continue;
+    }
+
+    //ds freeze the robust weight of the measurement at the current estimate
+    real weight = measurement.inverse_depth_meters;
+    const real error_squared = weight*(camera_coordinates_sampled-measurement.camera_coordinates).squaredNorm();
+    if (error_squared > _parameters->maximum_error_squared_meters) {
+      weight *= _parameters->maximum_error_squared_meters/error_squared;
+      ++_number_of_marginalized_outliers;
+    } else {
+      ++_number_of_marginalized_inliers;
+    }
+
+    //ds the measurement error is invariant to the camera rotation: the prior is the weighted mean of the measured world coordinates
+    const PointCoordinates world_coordinates_measured = measurement.frame->cameraLeftToWorld()*measurement.camera_coordinates;
+    _prior_coordinates  = (_prior_information*_prior_coordinates+weight*world_coordinates_measured)/(_prior_information+weight);
+    _prior_information += weight;
+  }
+  _measurements.erase(_measurements.begin(), _measurements.begin()+number_of_measurements_to_marginalize);
+}
 }
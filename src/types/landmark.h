@@ -57,7 +57,9 @@ public:
   void setOrigin(FramePoint* origin_) {_origin = origin_;}
 
   inline const PointCoordinates& coordinates() const {return _world_coordinates;}
-  void setCoordinates(const PointCoordinates& coordinates_) {_world_coordinates = coordinates_;}
+
+  //! @brief sets the landmark coordinates (e.g. after optimization) - the marginalized prior is moved rigidly along
+  void setCoordinates(const PointCoordinates& coordinates_) {_prior_coordinates += coordinates_-_world_coordinates; _world_coordinates = coordinates_;}
 
   //! @brief replaces a matchable in the appearance map
   void replace(const HBSTMatchable* matchable_old_, HBSTMatchable* matchable_new_);
@@ -82,8 +84,16 @@ public:
   //! @param[in] landmark_ the landmark to absorbed, landmark_ will be freed and its memory location will point to this
   void merge(Landmark* landmark_);
 
+  //! @brief detaches the landmark from its framepoints and drops its measurements and descriptors (frames left the sliding window)
+  //! @brief the landmark is kept as a snapshot for the local maps and appearances referencing it
+  void archive();
+  inline const bool isArchived() const {return _is_archived;}
+
   //ds reset allocated object counter
-  static void reset() {_instances = 0;}
+  static void reset() {_instances = 0; _number_of_buffer_allocations = 0;}
+
+  //! @brief number of heap allocations of measurement and descriptor buffers by all landmarks (not covered by the landmark pool counters)
+  static const Count& numberOfBufferAllocations() {return _number_of_buffer_allocations;}
 
   //ds visualization only
   inline const bool isInLoopClosureQuery() const {return _is_in_loop_closure_query;}
@@ -107,7 +117,7 @@ protected:
   PointCoordinates _world_coordinates;
 
   //ds descriptors of this landmark which have not been converted to appearances yet
-  std::vector<cv::Mat> _descriptors;
+  std::vector<BinaryDescriptor> _descriptors;
 
   //ds appearances of this landmark that are captured in a local map (previously contained in _descriptors)
   HBSTMatchableMemoryMap _appearance_map;
@@ -117,20 +127,35 @@ protected:
 
   //ds flags
   bool _is_currently_tracked = false; //ds set if the landmark is visible (=tracked) in the current image
+  bool _is_archived          = false; //ds set if the landmark has no framepoints anymore (compacted frames)
 
-  //ds landmark coordinates optimization
+  //ds landmark coordinates optimization: measurements in the window (all if no window is set)
   MeasurementVector _measurements;
   Count _number_of_updates    = 0;
   Count _number_of_recoveries = 0;
 
+  //! @brief marginalized measurements (older than the window): the information of a measurement is isotropic (inverse depth weight),
+  //! @brief hence the prior is fully described by its accumulated weight and the weighted mean of the measured world coordinates
+  real _prior_information                = 0;
+  PointCoordinates _prior_coordinates    = PointCoordinates::Zero();
+  Count _number_of_marginalized_inliers  = 0;
+  Count _number_of_marginalized_outliers = 0;
+
   //ds grant access to landmark factory and helpers
   friend WorldMap;
   friend LocalMap;
+  friend ObjectPool<Landmark>;
 
   //ds visualization only
   bool _is_in_loop_closure_query     = false;
   bool _is_in_loop_closure_reference = false;
 
+//ds helpers
+protected:
+
+  //! @brief moves the oldest measurements into the prior until the window size is met (using their robust weights at the current estimate)
+  void _marginalizeMeasurements();
+
 //ds class specific
 private:
 
@@ -140,6 +165,9 @@ private:
   //ds inner instance count - incremented upon constructor call (also unsuccessful calls)
   static Count _instances;
 
+  //! @brief informative only
+  static Count _number_of_buffer_allocations;
+
 };
 
 typedef std::vector<Landmark*> LandmarkPointerVector;
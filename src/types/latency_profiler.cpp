@@ -0,0 +1,196 @@
+#include "latency_profiler.h"
+
+#include <fstream>
+#include <iomanip>
+
+namespace proslam {
+
+constexpr uint32_t LatencyHistogram::sub_bucket_half_count_magnitude;
+constexpr uint64_t LatencyHistogram::sub_bucket_count;
+constexpr uint64_t LatencyHistogram::sub_bucket_half_count;
+constexpr uint32_t LatencyHistogram::maximum_magnitude;
+constexpr uint64_t LatencyHistogram::maximum_trackable_nanoseconds;
+
+LatencyHistogram::LatencyHistogram(): _counts(sub_bucket_count+(maximum_magnitude-sub_bucket_half_count_magnitude-1)*sub_bucket_half_count, 0) {}
+
+void LatencyHistogram::record(const double& duration_seconds_) {
+
+  //ds quantize to nanoseconds (saturating)
+  uint64_t nanoseconds = maximum_trackable_nanoseconds;
+  if (duration_seconds_ <= 0) {
+    nanoseconds = 0;
+  } else if (duration_seconds_*1e9 < maximum_trackable_nanoseconds) {
+    nanoseconds = static_cast<uint64_t>(duration_seconds_*1e9);
+  }
+  ++_counts[_getBucketIndex(nanoseconds)];
+
+  //ds update exact statistics
+  if (_number_of_samples == 0 || nanoseconds < _minimum_nanoseconds) {
+    _minimum_nanoseconds = nanoseconds;
+  }
+  if (nanoseconds > _maximum_nanoseconds) {
+    _maximum_nanoseconds = nanoseconds;
+  }
+  _total_seconds += std::max(duration_seconds_, 0.0);
+  ++_number_of_samples;
+}
+
+const double LatencyHistogram::quantileSeconds(const double& quantile_) const {
+  if (_number_of_samples == 0) {
+    return 0;
+  }
+
+  //ds rank of the sample we are looking for (at least the first one)
+  const double quantile = std::min(std::max(quantile_, 0.0), 1.0);
+  const uint64_t rank   = std::max(static_cast<uint64_t>(std::ceil(quantile*_number_of_samples)), uint64_t(1));
+
+  //ds walk the buckets until the rank is reached
+  uint64_t number_of_samples_cumulative = 0;
+  for (size_t index = 0; index < _counts.size(); ++index) {
+    number_of_samples_cumulative += _counts[index];
+    if (number_of_samples_cumulative >= rank) {
+      return std::min(_getBucketUpperBound(index), _maximum_nanoseconds)*1e-9;
+    }
+  }
+  return maximumSeconds();
+}
+
+void LatencyHistogram::clear() {
+  std::fill(_counts.begin(), _counts.end(), 0);
+  _number_of_samples   = 0;
+  _minimum_nanoseconds = 0;
+  _maximum_nanoseconds = 0;
+  _total_seconds       = 0;
+}
+
+void LatencyHistogram::forEachBucket(const std::function<void(const double&, const uint64_t&)>& visitor_) const {
+  for (size_t index = 0; index < _counts.size(); ++index) {
+    if (_counts[index] > 0) {
+      visitor_(_getBucketUpperBound(index)*1e-9, _counts[index]);
+    }
+  }
+}
+
+const size_t LatencyHistogram::_getBucketIndex(const uint64_t& nanoseconds_) const {
+
+  //ds small values are counted exactly
+  if (nanoseconds_ < sub_bucket_count) {
+    return nanoseconds_;
+  }
+
+  //ds for values in [2^magnitude, 2^(magnitude+1)) the upper sub_bucket_half_count_magnitude+1 bits select the linear sub-bucket
+  const uint32_t magnitude = 63-__builtin_clzll(nanoseconds_);
+  const uint32_t shift     = magnitude-sub_bucket_half_count_magnitude;
+  const uint64_t sub_index = (nanoseconds_ >> shift)-sub_bucket_half_count;
+  return sub_bucket_count+(magnitude-sub_bucket_half_count_magnitude-1)*sub_bucket_half_count+sub_index;
+}
+
+const uint64_t LatencyHistogram::_getBucketUpperBound(const size_t& index_) const {
+  if (index_ < sub_bucket_count) {
+    return index_;
+  }
+  const size_t index_logarithmic = index_-sub_bucket_count;
+  const uint32_t magnitude       = sub_bucket_half_count_magnitude+1+index_logarithmic/sub_bucket_half_count;
+  const uint32_t shift           = magnitude-sub_bucket_half_count_magnitude;
+  const uint64_t sub_index       = sub_bucket_half_count+index_logarithmic%sub_bucket_half_count;
+  return ((sub_index+1) << shift)-1;
+}
+
+LatencyProfiler::LatencyProfiler(const std::vector<std::string>& stage_names_): _stage_names(stage_names_),
+                                                                                 _histograms(stage_names_.size()) {}
+
+void LatencyProfiler::record(const Index& stage_, const double& duration_seconds_) {
+  assert(stage_ < _histograms.size());
+  std::lock_guard<std::mutex> lock(_mutex_histograms);
+  _histograms[stage_].record(duration_seconds_);
+}
+
+void LatencyProfiler::clear() {
+  std::lock_guard<std::mutex> lock(_mutex_histograms);
+  for (LatencyHistogram& histogram: _histograms) {
+    histogram.clear();
+  }
+}
+
+const LatencyHistogram LatencyProfiler::histogram(const Index& stage_) const {
+  assert(stage_ < _histograms.size());
+  std::lock_guard<std::mutex> lock(_mutex_histograms);
+  return _histograms[stage_];
+}
+
+void LatencyProfiler::print(std::ostream& stream_) const {
+  std::lock_guard<std::mutex> lock(_mutex_histograms);
+  const std::ios::fmtflags flags  = stream_.flags();
+  const std::streamsize precision = stream_.precision();
+  stream_ << "             stage name |  samples |  mean (ms) |   p50 (ms) |   p95 (ms) |   p99 (ms) |   max (ms)" << std::endl;
+  stream_ << BAR << std::endl;
+  for (Index stage = 0; stage < _histograms.size(); ++stage) {
+    const LatencyHistogram& histogram = _histograms[stage];
+    if (histogram.numberOfSamples() == 0) {
+      continue;
+    }
+    stream_ << std::setw(23) << _stage_names[stage] << " | " << std::setw(8) << histogram.numberOfSamples() << std::fixed << std::setprecision(3)
+            << " | " << std::setw(10) << 1e3*histogram.meanSeconds()
+            << " | " << std::setw(10) << 1e3*histogram.quantileSeconds(0.5)
+            << " | " << std::setw(10) << 1e3*histogram.quantileSeconds(0.95)
+            << " | " << std::setw(10) << 1e3*histogram.quantileSeconds(0.99)
+            << " | " << std::setw(10) << 1e3*histogram.maximumSeconds() << std::endl;
+  }
+  stream_.flags(flags);
+  stream_.precision(precision);
+}
+
+void LatencyProfiler::writeJSON(const std::string& file_name_) const {
+  std::ofstream stream(file_name_, std::ofstream::out);
+  if (!stream.is_open()) {
+    throw std::runtime_error("LatencyProfiler::writeJSON|unable to open file: " + file_name_);
+  }
+  stream << std::setprecision(9);
+
+  //ds one object per stage, including the non-empty buckets (upper bound in seconds, count) for offline analysis
+  std::lock_guard<std::mutex> lock(_mutex_histograms);
+  stream << "{\n  \"stages\": [";
+  for (Index stage = 0; stage < _histograms.size(); ++stage) {
+    const LatencyHistogram& histogram = _histograms[stage];
+    stream << ((stage > 0) ? ",\n" : "\n");
+    stream << "    {\"name\": \"" << _stage_names[stage] << "\""
+           << ", \"samples\": " << histogram.numberOfSamples()
+           << ", \"total_seconds\": " << histogram.totalSeconds()
+           << ", \"min_seconds\": " << histogram.minimumSeconds()
+           << ", \"mean_seconds\": " << histogram.meanSeconds()
+           << ", \"p50_seconds\": " << histogram.quantileSeconds(0.5)
+           << ", \"p95_seconds\": " << histogram.quantileSeconds(0.95)
+           << ", \"p99_seconds\": " << histogram.quantileSeconds(0.99)
+           << ", \"max_seconds\": " << histogram.maximumSeconds()
+           << ", \"buckets\": [";
+    bool is_first_bucket = true;
+    histogram.forEachBucket([&](const double& upper_bound_seconds_, const uint64_t& number_of_samples_) {
+      stream << (is_first_bucket ? "" : ", ") << "[" << upper_bound_seconds_ << ", " << number_of_samples_ << "]";
+      is_first_bucket = false;
+    });
+    stream << "]}";
+  }
+  stream << "\n  ]\n}\n";
+  stream.close();
+  LOG_INFO(std::cerr << "LatencyProfiler::writeJSON|saved latency profile to: " << file_name_ << std::endl)
+}
+
+void LatencyProfiler::writeCSV(const std::string& file_name_) const {
+  std::ofstream stream(file_name_, std::ofstream::out);
+  if (!stream.is_open()) {
+    throw std::runtime_error("LatencyProfiler::writeCSV|unable to open file: " + file_name_);
+  }
+  stream << std::setprecision(9);
+  std::lock_guard<std::mutex> lock(_mutex_histograms);
+  stream << "stage,samples,total_seconds,min_seconds,mean_seconds,p50_seconds,p95_seconds,p99_seconds,max_seconds\n";
+  for (Index stage = 0; stage < _histograms.size(); ++stage) {
+    const LatencyHistogram& histogram = _histograms[stage];
+    stream << _stage_names[stage] << "," << histogram.numberOfSamples() << "," << histogram.totalSeconds() << ","
+           << histogram.minimumSeconds() << "," << histogram.meanSeconds() << ","
+           << histogram.quantileSeconds(0.5) << "," << histogram.quantileSeconds(0.95) << "," << histogram.quantileSeconds(0.99) << ","
+           << histogram.maximumSeconds() << "\n";
+  }
+  stream.close();
+  LOG_INFO(std::cerr << "LatencyProfiler::writeCSV|saved latency profile to: " << file_name_ << std::endl)
+}
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <mutex>
+#include <functional>
+#include "definitions.h"
+
+namespace proslam {
+
+//! @class latency histogram with logarithmic buckets and a fixed number of linear sub-buckets per power of two (HDR histogram layout)
+//! @brief durations are recorded in nanoseconds with a relative quantization error below 1% up to the maximum trackable duration (saturating above)
+//! @brief recording is constant time and allocation free, quantiles are obtained by a single pass over the buckets
+class LatencyHistogram {
+
+//ds object handling
+public:
+
+  //! @brief constructs an empty histogram (all buckets are allocated upfront)
+  LatencyHistogram();
+
+//ds functionality
+public:
+
+  //! @brief adds a duration sample
+  //! @param[in] duration_seconds_ measured duration, negative durations are recorded as 0
+  void record(const double& duration_seconds_);
+
+  //! @brief returns the duration below or at which the given fraction of all samples lies (conservative: upper bucket bound, capped at the maximum)
+  //! @param[in] quantile_ fraction in [0, 1], e.g. 0.99 for p99
+  //! @return the quantile duration in seconds, 0 if no samples have been recorded
+  const double quantileSeconds(const double& quantile_) const;
+
+  //! @brief removes all samples
+  void clear();
+
+  //! @brief calls visitor_(upper bucket bound in seconds, number of samples) for all non-empty buckets in increasing duration order
+  void forEachBucket(const std::function<void(const double&, const uint64_t&)>& visitor_) const;
+
+//ds getters/setters
+public:
+
+  const uint64_t& numberOfSamples() const {return _number_of_samples;}
+  const double minimumSeconds() const {return (_number_of_samples > 0) ? _minimum_nanoseconds*1e-9 : 0;}
+  const double maximumSeconds() const {return _maximum_nanoseconds*1e-9;}
+  const double meanSeconds() const {return (_number_of_samples > 0) ? _total_seconds/_number_of_samples : 0;}
+  const double totalSeconds() const {return _total_seconds;}
+
+//ds helpers
+protected:
+
+  //! @brief bucket index for a duration in nanoseconds (values below the sub-bucket count map directly)
+  const size_t _getBucketIndex(const uint64_t& nanoseconds_) const;
+
+  //! @brief largest duration in nanoseconds that maps to the given bucket
+  const uint64_t _getBucketUpperBound(const size_t& index_) const;
+
+//ds attributes
+protected:
+
+  //! @brief number of linear sub-buckets per power of two: 2^7 halves yield a relative bucket width below 1%
+  static constexpr uint32_t sub_bucket_half_count_magnitude = 7;
+  static constexpr uint64_t sub_bucket_count                = uint64_t(1) << (sub_bucket_half_count_magnitude+1);
+  static constexpr uint64_t sub_bucket_half_count           = uint64_t(1) << sub_bucket_half_count_magnitude;
+
+  //! @brief durations beyond 2^42 nanoseconds (~73 minutes) saturate
+  static constexpr uint32_t maximum_magnitude            = 42;
+  static constexpr uint64_t maximum_trackable_nanoseconds = (uint64_t(1) << maximum_magnitude)-1;
+
+  //! @brief sample counts per bucket
+  std::vector<uint64_t> _counts;
+
+  //! @brief exact statistics
+  uint64_t _number_of_samples   = 0;
+  uint64_t _minimum_nanoseconds = 0;
+  uint64_t _maximum_nanoseconds = 0;
+  double _total_seconds         = 0;
+};
+
+//! @class collection of named latency histograms, one per processing stage - recording and export are thread-safe
+//! @brief intended for per-frame (or per-event) stage timings, complementing the accumulated CHRONOMETER totals
+class LatencyProfiler {
+
+//ds object handling
+public:
+
+  //! @brief constructs a profiler with one histogram per stage
+  //! @param[in] stage_names_ stage names, the stage index corresponds to the position in this vector (and defines the report order)
+  LatencyProfiler(const std::vector<std::string>& stage_names_);
+
+  //! @brief prohibit default construction and copies
+  LatencyProfiler() = delete;
+  LatencyProfiler(const LatencyProfiler&) = delete;
+  LatencyProfiler& operator=(const LatencyProfiler&) = delete;
+
+//ds functionality
+public:
+
+  //! @brief adds a duration sample to a stage histogram
+  //! @param[in] stage_ stage index
+  //! @param[in] duration_seconds_ measured duration
+  void record(const Index& stage_, const double& duration_seconds_);
+
+  //! @brief removes all samples of all stages
+  void clear();
+
+  //! @brief prints a quantile table (count, mean, p50, p95, p99, max) for all stages with samples
+  void print(std::ostream& stream_) const;
+
+  //! @brief writes all stage summaries and histogram buckets as JSON
+  //! @param[in] file_name_ output file, throws on failure
+  void writeJSON(const std::string& file_name_) const;
+
+  //! @brief writes all stage summaries as CSV (one line per stage, durations in seconds)
+  //! @param[in] file_name_ output file, throws on failure
+  void writeCSV(const std::string& file_name_) const;
+
+//ds getters/setters
+public:
+
+  const std::vector<std::string>& stageNames() const {return _stage_names;}
+
+  //! @brief returns a copy of a stage histogram (consistent snapshot)
+  const LatencyHistogram histogram(const Index& stage_) const;
+
+//ds attributes
+protected:
+
+  //! @brief stage names and histograms (same order)
+  const std::vector<std::string> _stage_names;
+  std::vector<LatencyHistogram> _histograms;
+
+  //! @brief histogram access (recording may happen from frontend and backend threads)
+  mutable std::mutex _mutex_histograms;
+};
+}
@@ -53,9 +53,10 @@ LocalMap::LocalMap(FramePointerVector& frames_,
       if (landmark && landmarks_added.count(landmark->identifier()) == 0) {
 
         //ds create HBST matchables based on available landmark descriptors TODO move this operation into a method of the landmark
+        //ds the OpenCV representation required by HBST is only created here (not for every framepoint)
         HBSTTree::MatchableVector matchables(landmark->_descriptors.size());
         for (Count u = 0; u < matchables.size(); ++u) {
-          HBSTMatchable* matchable = new HBSTMatchable(landmark, landmark->_descriptors[u], _identifier);
+          HBSTMatchable* matchable = new HBSTMatchable(landmark, landmark->_descriptors[u].toMat(), _identifier);
           matchables[u]            = matchable;
           landmark->_appearance_map.insert(std::make_pair(matchable, matchable));
         }
@@ -0,0 +1,188 @@
+#pragma once
+#include "definitions.h"
+
+namespace proslam {
+
+//! @class slab allocator for objects of a single type: memory is requested in chunks of a fixed number of objects and recycled through a free list
+//! @brief chunks are only returned to the system on destruction or release, so in steady state the object storage itself requires no heap allocations
+//! @brief the pool counters cover slot chunks only: buffers owned by the objects (e.g. frame images, landmark measurements) are allocated
+//! @brief by the objects themselves and have to be counted separately (see countedPushBack)
+//! @brief the pool is not thread-safe: objects have to be created and destroyed under the same lock (e.g. the world map lock)
+template<typename ObjectType>
+class ObjectPool {
+
+//ds object handling
+public:
+
+  //! @brief constructs an empty pool (no memory is allocated until the first object is created)
+  //! @param[in] number_of_objects_per_chunk_ number of object slots requested per heap allocation
+  ObjectPool(const Count& number_of_objects_per_chunk_ = 1024): _number_of_objects_per_chunk(std::max(number_of_objects_per_chunk_, Count(1))) {}
+
+  //! @brief frees all chunks - all objects must have been destroyed before
+  ~ObjectPool() {
+    assert(_number_of_active_objects == 0);
+    for (uint8_t* chunk: _chunks) {
+      _allocator.deallocate(chunk, _number_of_objects_per_chunk*slot_size);
+    }
+  }
+
+  //! @brief prohibit copies (objects are referenced by address)
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator=(const ObjectPool&) = delete;
+
+//ds functionality
+public:
+
+  //! @brief constructs an object in a free slot, forwarding all arguments to the object constructor
+  //! @return pointer to the constructed object, owned by the pool until destroy is called
+  template<typename... ArgumentTypes>
+  ObjectType* create(ArgumentTypes&&... arguments_) {
+    void* slot = _acquireSlot();
+    ObjectType* object = nullptr;
+    try {
+      object = new (slot) ObjectType(std::forward<ArgumentTypes>(arguments_)...);
+    } catch (...) {
+
+      //ds give the slot back if construction failed
+      _releaseSlot(slot);
+      throw;
+    }
+    ++_number_of_active_objects;
+    ++_number_of_created_objects;
+    return object;
+  }
+
+  //! @brief destructs an object created by this pool and recycles its slot
+  //! @param[in] object_ object to destroy (no effect for nullptr)
+  void destroy(ObjectType* object_) {
+    if (!object_) {
+      return;
+    }
+    assert(_number_of_active_objects > 0);
+    object_->~ObjectType();
+    _releaseSlot(object_);
+    --_number_of_active_objects;
+  }
+
+  //! @brief rewinds the pool: all allocated chunks become available again in allocation order (restores memory locality after a complete purge)
+  //! @brief has no effect if there are still active objects (their slots must not be handed out again)
+  void reset() {
+    if (_number_of_active_objects > 0) {
+      LOG_WARNING(std::cerr << "ObjectPool::reset|cannot rewind pool with active objects: " << _number_of_active_objects << std::endl)
+      return;
+    }
+    _free_slots                    = nullptr;
+    _index_chunk                   = 0;
+    _number_of_used_slots_in_chunk = 0;
+  }
+
+  //! @brief returns all chunks to the system - throws if there are still active objects
+  void release() {
+    if (_number_of_active_objects > 0) {
+      throw std::runtime_error("ObjectPool::release|cannot free pool with active objects: " + std::to_string(_number_of_active_objects));
+    }
+    reset();
+    for (uint8_t* chunk: _chunks) {
+      _allocator.deallocate(chunk, _number_of_objects_per_chunk*slot_size);
+    }
+    _chunks.clear();
+  }
+
+//ds getters/setters
+public:
+
+  //! @brief number of objects currently alive
+  const Count& numberOfActiveObjects() const {return _number_of_active_objects;}
+
+  //! @brief number of objects created since construction
+  const Count& numberOfCreatedObjects() const {return _number_of_created_objects;}
+
+  //! @brief number of chunk allocations performed since construction (constant in steady state, excludes buffers owned by the objects)
+  const Count& numberOfChunkAllocations() const {return _number_of_chunk_allocations;}
+
+  //! @brief number of object slots currently held
+  const Count capacity() const {return _chunks.size()*_number_of_objects_per_chunk;}
+
+  //! @brief memory currently held in bytes
+  const size_t sizeBytes() const {return _chunks.size()*_number_of_objects_per_chunk*slot_size;}
+
+//ds helpers
+protected:
+
+  //! @brief returns a free slot: a recycled one if available, otherwise the next unused one (allocating a new chunk if required)
+  void* _acquireSlot() {
+    if (_free_slots) {
+      FreeSlot* slot = _free_slots;
+      _free_slots    = slot->next;
+      return slot;
+    }
+
+    //ds move on to the next chunk if the current one is used up
+    if (_index_chunk < _chunks.size() && _number_of_used_slots_in_chunk == _number_of_objects_per_chunk) {
+      ++_index_chunk;
+      _number_of_used_slots_in_chunk = 0;
+    }
+
+    //ds allocate a new chunk if there is none left
+    if (_index_chunk == _chunks.size()) {
+      _chunks.push_back(_allocator.allocate(_number_of_objects_per_chunk*slot_size));
+      ++_number_of_chunk_allocations;
+    }
+    void* slot = _chunks[_index_chunk]+_number_of_used_slots_in_chunk*slot_size;
+    ++_number_of_used_slots_in_chunk;
+    return slot;
+  }
+
+  //! @brief pushes a slot to the free list (the slot memory is reused for the list link)
+  void _releaseSlot(void* slot_) {
+    FreeSlot* slot = static_cast<FreeSlot*>(slot_);
+    slot->next     = _free_slots;
+    _free_slots    = slot;
+  }
+
+//ds attributes
+protected:
+
+  //! @brief free list link, stored in the memory of a destroyed object
+  struct FreeSlot {
+    FreeSlot* next;
+  };
+
+  //! @brief slot size: a multiple of the object alignment, large enough to hold a free list link
+  static constexpr size_t slot_size = (sizeof(ObjectType) > sizeof(FreeSlot)) ? sizeof(ObjectType) : sizeof(FreeSlot);
+
+  //! @brief chunk memory is aligned for Eigen members (same guarantee as EIGEN_MAKE_ALIGNED_OPERATOR_NEW)
+  Eigen::aligned_allocator<uint8_t> _allocator;
+
+  //! @brief allocated chunks, each holding _number_of_objects_per_chunk slots
+  std::vector<uint8_t*> _chunks;
+  const Count _number_of_objects_per_chunk;
+
+  //! @brief bump allocation state: current chunk and number of slots handed out from it
+  size_t _index_chunk                  = 0;
+  Count _number_of_used_slots_in_chunk = 0;
+
+  //! @brief recycled slots
+  FreeSlot* _free_slots = nullptr;
+
+  //! @brief informative only
+  Count _number_of_active_objects    = 0;
+  Count _number_of_created_objects   = 0;
+  Count _number_of_chunk_allocations = 0;
+};
+
+template<typename ObjectType>
+constexpr size_t ObjectPool<ObjectType>::slot_size;
+
+//! @brief appends an element to a buffer owned by a pooled object and counts the heap allocation if the buffer has to grow
+//! @param[in,out] buffer_ vector to append to
+//! @param[in] element_ element to append
+//! @param[in,out] number_of_allocations_ incremented if the append triggers a reallocation
+template<typename BufferType, typename ElementType>
+inline void countedPushBack(BufferType& buffer_, ElementType&& element_, Count& number_of_allocations_) {
+  if (buffer_.size() == buffer_.capacity()) {
+    ++number_of_allocations_;
+  }
+  buffer_.push_back(std::forward<ElementType>(element_));
+}
+}
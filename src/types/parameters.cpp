@@ -25,6 +25,9 @@ std::string ParameterCollection::banner =
 "-equalize-histogram (-eh):               equalize stereo image histogram before processing\n"
 "-recover-landmarks (-rl):                enables landmark track recovery\n"
 "-disable-bundle-adjustment (-dba):       disables periodic bundle adjustment for landmarks and frames\n"
+"-use-backend-thread (-ubt):              runs relocalization and pose graph optimization in a backend thread\n"
+"-latency-json (-lj)            <string>: exports per-stage latency histograms as JSON at the end of the run (and on SIGUSR1)\n"
+"-latency-csv (-lc)             <string>: exports per-stage latency quantiles as CSV at the end of the run (and on SIGUSR1)\n"
 DOUBLE_BAR;
 
 //! @brief macro wrapping the YAML node parsing for a single parameter
@@ -65,6 +68,16 @@ void CommandLineParameters::print() const {
   std::cerr << "-equalize-histogram (-eh)          " << option_equalize_histogram << std::endl;
   std::cerr << "-recover-landmarks (-rl)           " << option_recover_landmarks << std::endl;
   std::cerr << "-disable-bundle-adjustment (-dba)  " << option_disable_bundle_adjustment << std::endl;
+  std::cerr << "-use-backend-thread (-ubt)         " << option_use_backend_thread << std::endl;
+  if (option_use_backend_thread) {
+  std::cerr << "maximum_number_of_queued_local_maps " << maximum_number_of_queued_local_maps << std::endl;
+  }
+  if (latency_profile_json_file_name.length() > 0) {
+  std::cerr << "-latency-json (-lj)               '" << latency_profile_json_file_name << "'" << std::endl;
+  }
+  if (latency_profile_csv_file_name.length() > 0) {
+  std::cerr << "-latency-csv (-lc)                '" << latency_profile_csv_file_name << "'" << std::endl;
+  }
   if (dataset_file_name.length() > 0) {
   std::cerr << "-dataset                          '" << dataset_file_name  << "'" << std::endl;
   }
@@ -75,10 +88,12 @@ void AlignerParameters::print() const {
   std::cerr << "AlignerParameters::print|maximum_error_kernel: " << maximum_error_kernel << std::endl;
   std::cerr << "AlignerParameters::print|minimum_number_of_inliers: " << minimum_number_of_inliers << std::endl;
   std::cerr << "AlignerParameters::print|minimum_inlier_ratio: " << minimum_inlier_ratio << std::endl;
+  std::cerr << "AlignerParameters::print|number_of_linearization_threads: " << number_of_linearization_threads << std::endl;
 }
 
 void LandmarkParameters::print() const {
 //  std::cerr << "LandmarkParameters::print|minimum_number_of_forced_updates: " << minimum_number_of_forced_updates << std::endl;
+  std::cerr << "LandmarkParameters::print|number_of_measurements_in_window: " << number_of_measurements_in_window << std::endl;
 }
 
 void LocalMapParameters::print() const {
@@ -89,6 +104,9 @@ void WorldMapParameters::print() const {
   std::cerr << "WorldMapParameters::print|minimum_distance_traveled_for_local_map: " << minimum_distance_traveled_for_local_map << std::endl;
   std::cerr << "WorldMapParameters::print|minimum_degrees_rotated_for_local_map: " << minimum_degrees_rotated_for_local_map << std::endl;
   std::cerr << "WorldMapParameters::print|minimum_number_of_frames_for_local_map: " << minimum_number_of_frames_for_local_map << std::endl;
+  std::cerr << "WorldMapParameters::print|maximum_memory_megabytes: " << maximum_memory_megabytes << std::endl;
+  std::cerr << "WorldMapParameters::print|minimum_number_of_frames_in_window: " << minimum_number_of_frames_in_window << std::endl;
+  std::cerr << "WorldMapParameters::print|number_of_landmark_update_threads: " << number_of_landmark_update_threads << std::endl;
   landmark->print();
   local_map->print();
 }
@@ -97,19 +115,33 @@ void BaseFramePointGeneratorParameters::print() const {
   std::cerr << "BaseFramepointGeneratorParameters::print|target_number_of_keypoints_tolerance: " << target_number_of_keypoints_tolerance << std::endl;
   std::cerr << "BaseFramepointGeneratorParameters::print|detector_threshold_minimum: " << detector_threshold_minimum << std::endl;
   std::cerr << "BaseFramepointGeneratorParameters::print|detector_threshold_maximum_change: " << detector_threshold_maximum_change << std::endl;
+  std::cerr << "BaseFramepointGeneratorParameters::print|number_of_detection_threads: " << number_of_detection_threads << std::endl;
+  std::cerr << "BaseFramepointGeneratorParameters::print|enable_single_pass_detection: " << enable_single_pass_detection << std::endl;
   std::cerr << "BaseFramepointGeneratorParameters::print|matching_distance_tracking_threshold: " << minimum_descriptor_distance_tracking << std::endl;
   std::cerr << "BaseFramepointGeneratorParameters::print|enable_keypoint_binning: " << enable_keypoint_binning << std::endl;
   std::cerr << "BaseFramepointGeneratorParameters::print|bin_size_pixels: " << bin_size_pixels << std::endl;
+  std::cerr << "BaseFramepointGeneratorParameters::print|enable_coarse_to_fine_tracking: " << enable_coarse_to_fine_tracking << std::endl;
+  std::cerr << "BaseFramepointGeneratorParameters::print|number_of_pyramid_levels: " << number_of_pyramid_levels << std::endl;
+  std::cerr << "BaseFramepointGeneratorParameters::print|number_of_coarse_tracking_points: " << number_of_coarse_tracking_points << std::endl;
+  std::cerr << "BaseFramepointGeneratorParameters::print|coarse_to_fine_tracking_distance_pixels: " << coarse_to_fine_tracking_distance_pixels << std::endl;
+  std::cerr << "BaseFramepointGeneratorParameters::print|coarse_tracking_patch_radius_pixels: " << coarse_tracking_patch_radius_pixels << std::endl;
+  std::cerr << "BaseFramepointGeneratorParameters::print|minimum_coarse_tracking_correlation: " << minimum_coarse_tracking_correlation << std::endl;
+  std::cerr << "BaseFramepointGeneratorParameters::print|minimum_number_of_coarse_tracks: " << minimum_number_of_coarse_tracks << std::endl;
 }
 
 void StereoFramePointGeneratorParameters::print() const {
   std::cerr << "StereoFramepointGeneratorParameters::print|maximum_matching_distance_triangulation: " << maximum_matching_distance_triangulation << std::endl;
   std::cerr << "StereoFramepointGeneratorParameters::print|minimum_disparity_pixels: " << minimum_disparity_pixels << std::endl;
+  std::cerr << "StereoFramepointGeneratorParameters::print|enable_parallel_feature_extraction: " << enable_parallel_feature_extraction << std::endl;
   BaseFramePointGeneratorParameters::print();
 }
 
 void DepthFramePointGeneratorParameters::print() const {
   BaseFramePointGeneratorParameters::print();
+  std::cerr << "DepthFramePointGeneratorParameters::print|number_of_depth_map_threads: " << number_of_depth_map_threads << std::endl;
+  std::cerr << "DepthFramePointGeneratorParameters::print|enable_lazy_depth_map: " << enable_lazy_depth_map << std::endl;
+  std::cerr << "DepthFramePointGeneratorParameters::print|enable_sparse_depth_lookup: " << enable_sparse_depth_lookup << std::endl;
+  std::cerr << "DepthFramePointGeneratorParameters::print|sparse_depth_search_radius_pixels: " << sparse_depth_search_radius_pixels << std::endl;
 }
 
 PoseTracker3DParameters::PoseTracker3DParameters(): aligner(new AlignerParameters()) {}
@@ -117,6 +149,10 @@ PoseTracker3DParameters::PoseTracker3DParameters(): aligner(new AlignerParameter
 void PoseTracker3DParameters::print() const {
   std::cerr << "BaseTrackerParameters::print|minimum_number_of_landmarks_to_track: " << minimum_number_of_landmarks_to_track << std::endl;
   std::cerr << "BaseTrackerParameters::print|maximum_number_of_landmark_recoveries: " << maximum_number_of_landmark_recoveries << std::endl;
+  std::cerr << "BaseTrackerParameters::print|enable_ransac_initialization: " << enable_ransac_initialization << std::endl;
+  std::cerr << "BaseTrackerParameters::print|number_of_ransac_samples: " << number_of_ransac_samples << std::endl;
+  std::cerr << "BaseTrackerParameters::print|ransac_preemption_block_size: " << ransac_preemption_block_size << std::endl;
+  std::cerr << "BaseTrackerParameters::print|maximum_ransac_reprojection_error_pixels: " << maximum_ransac_reprojection_error_pixels << std::endl;
   aligner->print();
 }
 
@@ -125,14 +161,24 @@ void RelocalizerParameters::print() const {
   std::cerr << "RelocalizerParameters::print|preliminary_minimum_matching_ratio: " << preliminary_minimum_matching_ratio << std::endl;
   std::cerr << "RelocalizerParameters::print|minimum_number_of_matches_per_landmark: " << minimum_number_of_matched_landmarks << std::endl;
   std::cerr << "RelocalizerParameters::print|minimum_matches_per_correspondence: " << minimum_matches_per_correspondence << std::endl;
+  std::cerr << "RelocalizerParameters::print|number_of_verification_threads: " << number_of_verification_threads << std::endl;
+  std::cerr << "RelocalizerParameters::print|number_of_ransac_iterations: " << number_of_ransac_iterations << std::endl;
+  std::cerr << "RelocalizerParameters::print|enable_early_termination: " << enable_early_termination << std::endl;
+  std::cerr << "RelocalizerParameters::print|enable_asynchronous_processing: " << enable_asynchronous_processing << std::endl;
   aligner->print();
 }
 
 void GraphOptimizerParameters::print() const {
+  std::cerr << "GraphOptimizerParameters::print|linear_solver_type: " << linear_solver_type << std::endl;
+  std::cerr << "GraphOptimizerParameters::print|maximum_relative_fill_increase: " << maximum_relative_fill_increase << std::endl;
   std::cerr << "GraphOptimizerParameters::print|identifier_space: " << identifier_space << std::endl;
   std::cerr << "GraphOptimizerParameters::print|number_of_frames_per_bundle_adjustment: " << number_of_frames_per_bundle_adjustment << std::endl;
+  std::cerr << "GraphOptimizerParameters::print|number_of_keyframes_in_window: " << number_of_keyframes_in_window << std::endl;
+  std::cerr << "GraphOptimizerParameters::print|number_of_anchor_keyframes: " << number_of_anchor_keyframes << std::endl;
   std::cerr << "GraphOptimizerParameters::print|base_information_frame: " << base_information_frame << std::endl;
   std::cerr << "GraphOptimizerParameters::print|enable_robust_kernel_for_landmark_measurements: " << enable_robust_kernel_for_landmarks << std::endl;
+  std::cerr << "GraphOptimizerParameters::print|enable_incremental_optimization: " << enable_incremental_optimization << std::endl;
+  std::cerr << "GraphOptimizerParameters::print|number_of_local_maps_per_segment: " << number_of_local_maps_per_segment << std::endl;
 }
 
 void ImageViewerParameters::print() const {
@@ -251,6 +297,16 @@ void ParameterCollection::parseFromCommandLine(const int32_t& argc_, char ** arg
       command_line_parameters->tracker_mode = CommandLineParameters::TrackerMode::RGB_DEPTH;
     } else if (!std::strcmp(argv_[number_of_checked_parameters], "-recover-landmarks") || !std::strcmp(argv_[number_of_checked_parameters], "-rl")) {
       command_line_parameters->option_recover_landmarks = true;
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-use-backend-thread") || !std::strcmp(argv_[number_of_checked_parameters], "-ubt")) {
+      command_line_parameters->option_use_backend_thread = true;
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-latency-json") || !std::strcmp(argv_[number_of_checked_parameters], "-lj")) {
+      number_of_checked_parameters++;
+      if (number_of_checked_parameters == argc_) {break;}
+      command_line_parameters->latency_profile_json_file_name = argv_[number_of_checked_parameters];
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-latency-csv") || !std::strcmp(argv_[number_of_checked_parameters], "-lc")) {
+      number_of_checked_parameters++;
+      if (number_of_checked_parameters == argc_) {break;}
+      command_line_parameters->latency_profile_csv_file_name = argv_[number_of_checked_parameters];
     } else if (!std::strcmp(argv_[number_of_checked_parameters], "-configuration") || !std::strcmp(argv_[number_of_checked_parameters], "-c")) {
       number_of_checked_parameters++;
     } else {
@@ -304,13 +360,21 @@ void ParameterCollection::parseFromFile(const std::string& filename_) {
     PARSE_PARAMETER(configuration, command_line, command_line_parameters, option_equalize_histogram, bool)
     PARSE_PARAMETER(configuration, command_line, command_line_parameters, option_recover_landmarks, bool)
     PARSE_PARAMETER(configuration, command_line, command_line_parameters, option_disable_bundle_adjustment, bool)
+    PARSE_PARAMETER(configuration, command_line, command_line_parameters, option_use_backend_thread, bool)
+    PARSE_PARAMETER(configuration, command_line, command_line_parameters, maximum_number_of_queued_local_maps, Count)
+    PARSE_PARAMETER(configuration, command_line, command_line_parameters, latency_profile_json_file_name, std::string)
+    PARSE_PARAMETER(configuration, command_line, command_line_parameters, latency_profile_csv_file_name, std::string)
     PARSE_PARAMETER(configuration, command_line, command_line_parameters, maximum_time_interval_seconds, real)
 
     //Types
     PARSE_PARAMETER(configuration, world_map, world_map_parameters, minimum_distance_traveled_for_local_map, real)
     PARSE_PARAMETER(configuration, world_map, world_map_parameters, minimum_degrees_rotated_for_local_map, real)
     PARSE_PARAMETER(configuration, world_map, world_map_parameters, minimum_number_of_frames_for_local_map, Count)
+    PARSE_PARAMETER(configuration, world_map, world_map_parameters, maximum_memory_megabytes, real)
+    PARSE_PARAMETER(configuration, world_map, world_map_parameters, minimum_number_of_frames_in_window, Count)
+    PARSE_PARAMETER(configuration, world_map, world_map_parameters, number_of_landmark_update_threads, Count)
     PARSE_PARAMETER(configuration, landmark, world_map_parameters->landmark, maximum_error_squared_meters, real)
+    PARSE_PARAMETER(configuration, landmark, world_map_parameters->landmark, number_of_measurements_in_window, Count)
     PARSE_PARAMETER(configuration, local_map, world_map_parameters->local_map, minimum_number_of_landmarks, Count)
 
     //ds mode specific parameters
@@ -323,6 +387,7 @@ void ParameterCollection::parseFromFile(const std::string& filename_) {
         PARSE_PARAMETER(configuration, stereo_framepoint_generation, stereo_framepoint_generator_parameters, maximum_matching_distance_triangulation, int32_t)
         PARSE_PARAMETER(configuration, stereo_framepoint_generation, stereo_framepoint_generator_parameters, minimum_disparity_pixels, real)
         PARSE_PARAMETER(configuration, stereo_framepoint_generation, stereo_framepoint_generator_parameters, maximum_epipolar_search_offset_pixels, int32_t)
+        PARSE_PARAMETER(configuration, stereo_framepoint_generation, stereo_framepoint_generator_parameters, enable_parallel_feature_extraction, bool)
         break;
       }
       case CommandLineParameters::TrackerMode::RGB_DEPTH: {
@@ -332,6 +397,10 @@ void ParameterCollection::parseFromFile(const std::string& filename_) {
         PARSE_PARAMETER(configuration, depth_framepoint_generation, depth_framepoint_generator_parameters, depth_scale_factor_intensity_to_meters, real)
         PARSE_PARAMETER(configuration, depth_framepoint_generation, depth_framepoint_generator_parameters, enable_bilateral_filtering, bool)
         PARSE_PARAMETER(configuration, depth_framepoint_generation, depth_framepoint_generator_parameters, enable_point_triangulation, bool)
+        PARSE_PARAMETER(configuration, depth_framepoint_generation, depth_framepoint_generator_parameters, number_of_depth_map_threads, Count)
+        PARSE_PARAMETER(configuration, depth_framepoint_generation, depth_framepoint_generator_parameters, enable_lazy_depth_map, bool)
+        PARSE_PARAMETER(configuration, depth_framepoint_generation, depth_framepoint_generator_parameters, enable_sparse_depth_lookup, bool)
+        PARSE_PARAMETER(configuration, depth_framepoint_generation, depth_framepoint_generator_parameters, sparse_depth_search_radius_pixels, int32_t)
         break;
       }
       default: {
@@ -348,6 +417,8 @@ void ParameterCollection::parseFromFile(const std::string& filename_) {
     PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, detector_threshold_maximum_change, real)
     PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, number_of_detectors_vertical, int32_t)
     PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, number_of_detectors_horizontal, int32_t)
+    PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, number_of_detection_threads, Count)
+    PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, enable_single_pass_detection, bool)
     PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, minimum_descriptor_distance_tracking, real)
     PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, maximum_descriptor_distance_tracking, real)
     PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, maximum_reliable_depth_meters, real)
@@ -355,6 +426,13 @@ void ParameterCollection::parseFromFile(const std::string& filename_) {
     PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, minimum_depth_meters, real)
     PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, minimum_projection_tracking_distance_pixels, int32_t)
     PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, maximum_projection_tracking_distance_pixels, int32_t)
+    PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, enable_coarse_to_fine_tracking, bool)
+    PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, number_of_pyramid_levels, Count)
+    PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, number_of_coarse_tracking_points, Count)
+    PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, coarse_to_fine_tracking_distance_pixels, int32_t)
+    PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, coarse_tracking_patch_radius_pixels, int32_t)
+    PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, minimum_coarse_tracking_correlation, real)
+    PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, minimum_number_of_coarse_tracks, Count)
     PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, enable_keypoint_binning, bool)
     PARSE_PARAMETER(configuration, base_framepoint_generation, framepoint_generation_parameters, bin_size_pixels, Count)
 
@@ -365,6 +443,10 @@ void ParameterCollection::parseFromFile(const std::string& filename_) {
     PARSE_PARAMETER(configuration, tracking, tracker_parameters, maximum_number_of_landmark_recoveries, Count)
     PARSE_PARAMETER(configuration, tracking, tracker_parameters, minimum_delta_angular_for_movement, real)
     PARSE_PARAMETER(configuration, tracking, tracker_parameters, minimum_delta_translational_for_movement, real)
+    PARSE_PARAMETER(configuration, tracking, tracker_parameters, enable_ransac_initialization, bool)
+    PARSE_PARAMETER(configuration, tracking, tracker_parameters, number_of_ransac_samples, Count)
+    PARSE_PARAMETER(configuration, tracking, tracker_parameters, ransac_preemption_block_size, Count)
+    PARSE_PARAMETER(configuration, tracking, tracker_parameters, maximum_ransac_reprojection_error_pixels, real)
     PARSE_PARAMETER(configuration, tracking, tracker_parameters, aligner->error_delta_for_convergence, real)
     PARSE_PARAMETER(configuration, tracking, tracker_parameters, aligner->maximum_error_kernel, real)
     PARSE_PARAMETER(configuration, tracking, tracker_parameters, aligner->damping, real)
@@ -372,6 +454,7 @@ void ParameterCollection::parseFromFile(const std::string& filename_) {
     PARSE_PARAMETER(configuration, tracking, tracker_parameters, aligner->minimum_number_of_inliers, Count)
     PARSE_PARAMETER(configuration, tracking, tracker_parameters, aligner->minimum_inlier_ratio, real)
     PARSE_PARAMETER(configuration, tracking, tracker_parameters, aligner->enable_inverse_depth_as_information, bool)
+    PARSE_PARAMETER(configuration, tracking, tracker_parameters, aligner->number_of_linearization_threads, Count)
     PARSE_PARAMETER(configuration, tracking, tracker_parameters, good_tracking_ratio, real)
 
     //ds parse desired motion model as string
@@ -395,6 +478,10 @@ void ParameterCollection::parseFromFile(const std::string& filename_) {
     PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, preliminary_minimum_matching_ratio, real)
     PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, minimum_number_of_matched_landmarks, Count)
     PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, minimum_matches_per_correspondence, Count)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, number_of_verification_threads, Count)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, number_of_ransac_iterations, Count)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, enable_early_termination, bool)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, enable_asynchronous_processing, bool)
     PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, aligner->error_delta_for_convergence, real)
     PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, aligner->maximum_error_kernel, real)
     PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, aligner->damping, real)
@@ -406,15 +493,20 @@ void ParameterCollection::parseFromFile(const std::string& filename_) {
     PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, enable_full_bundle_adjustment, bool)
     PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, optimization_algorithm, std::string)
     PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, linear_solver_type, std::string)
+    PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, maximum_relative_fill_increase, real)
     PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, maximum_number_of_iterations, Count)
     PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, identifier_space, real)
     PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, number_of_frames_per_bundle_adjustment, Count)
+    PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, number_of_keyframes_in_window, Count)
+    PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, number_of_anchor_keyframes, Count)
     PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, base_information_frame, real)
     PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, free_translation_for_poses, bool)
     PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, base_information_frame_factor_for_translation, real)
     PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, enable_robust_kernel_for_poses, bool)
     PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, enable_robust_kernel_for_landmarks, bool)
     PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, minimum_estimation_delta_for_update_meters, real)
+    PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, enable_incremental_optimization, bool)
+    PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, number_of_local_maps_per_segment, Count)
 
     //ds viewers
     PARSE_PARAMETER(configuration, visualization, map_viewer_parameters, follow_robot, bool)
@@ -57,6 +57,15 @@ public:
   bool option_recover_landmarks         = true;
   bool option_disable_bundle_adjustment = true;
   bool option_save_pose_graph           = false;
+  bool option_use_backend_thread        = false;
+
+  //! @brief maximum number of local maps waiting for the backend (relocalization and pose graph optimization)
+  //! @brief the frontend blocks once the queue is full (only used with option_use_backend_thread)
+  Count maximum_number_of_queued_local_maps = 4;
+
+  //! @brief per-stage latency profile output files, written at the end of a run and on request (empty: no export)
+  std::string latency_profile_json_file_name = "";
+  std::string latency_profile_csv_file_name  = "";
 
   //! @brief sensor data synchronization interval size
   real maximum_time_interval_seconds = 0.001;
@@ -92,6 +101,9 @@ public:
 
   //! @brief enable inverse depth as information matrix factor for translation
   bool enable_inverse_depth_as_information = true;
+
+  //! @brief number of threads linearizing the measurements in parallel (frame aligners, 1: sequential processing)
+  Count number_of_linearization_threads = 1;
 };
 
 //! @class landmark parameters
@@ -112,6 +124,9 @@ public:
 
   //! @brief maximum number of LS iterations for landmark position optimization
   Count maximum_number_of_iterations = 100;
+
+  //! @brief number of most recent measurements in the landmark position optimization, older ones are marginalized into a prior (0: all measurements)
+  Count number_of_measurements_in_window = 10;
 };
 
 //! @class local map parameters
@@ -150,6 +165,16 @@ public:
   real minimum_degrees_rotated_for_local_map   = 0.5;
   Count minimum_number_of_frames_for_local_map = 4;
 
+  //! @brief memory budget for frame and landmark data in megabytes (sliding window mode, 0: unbounded)
+  //! @brief if exceeded, the oldest processed frames are compacted to pose and timestamp
+  real maximum_memory_megabytes = 0;
+
+  //! @brief number of most recent frames that are never compacted (sliding window)
+  Count minimum_number_of_frames_in_window = 100;
+
+  //! @brief number of threads computing the landmark world coordinates of moved local maps after pose graph optimization
+  Count number_of_landmark_update_threads = 1;
+
   //! @brief landmark generation parameters
   LandmarkParameters* landmark;
 
@@ -167,7 +192,9 @@ public:
   //! @brief parameter printing function
   virtual void print() const;
 
-  //! @brief desired descriptor type (OpenCV string + bit size): BRIEF-256, ORB-256, BRISK-512, FREAK-512, ..
+  //! @brief desired descriptor type (OpenCV string + bit size): BRIEF-128/256/512, ORB-256, BRISK-512, FREAK-512, ..
+  //! @brief the bit size is selected at runtime and may not exceed the storage size SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS (configure throws otherwise)
+  //! @brief 512 bit descriptors (e.g. BRISK-512, FREAK-512) require a build with -DSRRG_PROSLAM_DESCRIPTOR_SIZE_BITS=512
   std::string descriptor_type = "ORB-256";
 
   //! @brief dynamic thresholds for feature detection
@@ -180,6 +207,13 @@ public:
   uint32_t number_of_detectors_vertical   = 1;
   uint32_t number_of_detectors_horizontal = 1;
 
+  //! @brief number of threads processing the detector regions in parallel (1: sequential processing)
+  Count number_of_detection_threads = 1;
+
+  //! @brief run a single FAST pass over the full image and select the keypoints per detector region by score (instead of one detector call per region)
+  //! @brief each region keeps at most its target number of keypoints (plus tolerance), strongest first
+  bool enable_single_pass_detection = false;
+
   //! @brief number of camera image streams (required for detector regions)
   uint32_t number_of_cameras = 1;
 
@@ -187,7 +221,19 @@ public:
   int32_t minimum_projection_tracking_distance_pixels = 15;
   int32_t maximum_projection_tracking_distance_pixels = 50;
 
-  //! @brief dynamic thresholds for descriptor matching
+  //! @brief coarse-to-fine tracking: if the tracking distance exceeds coarse_to_fine_tracking_distance_pixels, the image offset
+  //! @brief of the predicted projections is estimated on the coarsest pyramid level first and tracking uses the tight distance
+  bool enable_coarse_to_fine_tracking             = false;
+  Count number_of_pyramid_levels                  = 3;
+  Count number_of_coarse_tracking_points          = 50;
+  int32_t coarse_to_fine_tracking_distance_pixels = 10;
+
+  //! @brief coarse level patch correlation: patch radius, minimum normalized correlation of a located point and minimum number of located points
+  int32_t coarse_tracking_patch_radius_pixels = 4;
+  real minimum_coarse_tracking_correlation    = 0.8;
+  Count minimum_number_of_coarse_tracks       = 5;
+
+  //! @brief dynamic thresholds for descriptor matching (bits, given for the storage size, the generators use values scaled to the active size)
   real minimum_descriptor_distance_tracking = 0.1*SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS;
   real maximum_descriptor_distance_tracking = 0.2*SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS;
 
@@ -211,7 +257,7 @@ public:
   //! @brief parameter printing function
   virtual void print() const;
 
-  //! @brief stereo: triangulation configuration
+  //! @brief stereo: triangulation configuration (bits, given for the storage size, the generators use values scaled to the active size)
   real maximum_matching_distance_triangulation = 0.2*SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS;
 
   //! @brief minimum considered disparity for triangulation
@@ -219,6 +265,9 @@ public:
 
   //! @brief maximum checked epipolar line offsets
   int32_t maximum_epipolar_search_offset_pixels  = 0;
+
+  //! @brief process left and right image simultaneously (keypoint detection and descriptor extraction)
+  bool enable_parallel_feature_extraction = false;
 };
 
 //! @class framepoint generation parameters for a rgbd camera setup
@@ -239,6 +288,18 @@ public:
 
   //! @brief enable point triangulation (for pixels invalid depths)
   bool enable_point_triangulation = false;
+
+  //! @brief number of threads for the row-parallel depth map computation (1: sequential processing)
+  Count number_of_depth_map_threads = 1;
+
+  //! @brief enable lazy depth map computation: depth points are resolved from the z-buffer only at queried (keypoint) pixels
+  bool enable_lazy_depth_map = false;
+
+  //! @brief enable sparse depth lookup: no depth map is computed, depth points are reprojected from the depth neighborhood of queried pixels
+  bool enable_sparse_depth_lookup = false;
+
+  //! @brief depth neighborhood radius around the located depth pixel, reprojected in sparse lookups
+  int32_t sparse_depth_search_radius_pixels = 2;
 };
 
 //! @class base tracker parameters
@@ -276,6 +337,12 @@ public:
   real minimum_delta_angular_for_movement       = 0.001;
   real minimum_delta_translational_for_movement = 0.01;
 
+  //! @brief pose initialization: preemptive RANSAC over P3P hypotheses (landmarks/points to keypoints), used to seed the aligner if the motion model guess fails
+  bool enable_ransac_initialization              = false;
+  Count number_of_ransac_samples                 = 50;
+  Count ransac_preemption_block_size             = 20;
+  real maximum_ransac_reprojection_error_pixels = 4;
+
   //! @brief desired motion model (if any)
   MotionModel motion_model = MotionModel::CONSTANT_VELOCITY;
 
@@ -296,7 +363,7 @@ public:
   //! @brief parameter printing function
   virtual void print() const;
 
-  //! @brief maximum descriptor distance for a valid match
+  //! @brief maximum descriptor distance for a valid match (bits, given for the storage size, the relocalizer uses a value scaled to the active size)
   real maximum_descriptor_distance = 0.1*SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS;
 
   //! @brief minimum query interspace
@@ -311,6 +378,18 @@ public:
   //! @brief correspondence retrieval
   Count minimum_matches_per_correspondence = 0;
 
+  //! @brief number of threads for the geometric verification of closure candidates
+  Count number_of_verification_threads = 1;
+
+  //! @brief number of 3-point RANSAC hypotheses to pre-check closure candidates before ICP (0: disabled)
+  Count number_of_ransac_iterations = 0;
+
+  //! @brief stop the verification at the first accepted closure in order of decreasing matching ratio (keeping only that closure, as prune)
+  bool enable_early_termination = false;
+
+  //! @brief place database queries are processed by a worker thread, closures are integrated once available (ignored with backend thread)
+  bool enable_asynchronous_processing = false;
+
   //! @brief parameters of aligner unit
   AlignerParameters* aligner;
 };
@@ -334,9 +413,13 @@ public:
   //! @brief g2o factor graph optimization algorithm: GAUSS_NEWTON, LEVENBERG
   std::string optimization_algorithm = "GAUSS_NEWTON";
 
-  //! @brief g2o linear solver type to perform optimization algorithm: CSPARSE, CHOLMOD
+  //! @brief g2o linear solver type to perform optimization algorithm: CSPARSE, CHOLMOD, CACHED_ORDERING
+  //! @brief CACHED_ORDERING keeps the pose graph structure and its fill-reducing ordering between optimizations and extends them as the graph grows
   std::string linear_solver_type = "CHOLMOD";
 
+  //! @brief CACHED_ORDERING: relative increase of the factor fill since the last full analysis that triggers a new ordering
+  real maximum_relative_fill_increase = 0.5;
+
   //! @brief maximum number of iterations graph optimization
   Count maximum_number_of_iterations = 100;
 
@@ -346,6 +429,13 @@ public:
   //! @brief determines window size for bundle adjustment
   Count number_of_frames_per_bundle_adjustment = 100;
 
+  //! @brief sliding window bundle adjustment: number of most recent keyframes that are optimized at every keyframe (0: periodic batch optimization)
+  Count number_of_keyframes_in_window = 0;
+
+  //! @brief sliding window bundle adjustment: number of fixed keyframes in front of the window (older states are removed from the graph)
+  //! @brief the oldest keyframe in the graph is always fixed, also if no anchors are configured
+  Count number_of_anchor_keyframes = 5;
+
   //! @brief base frame weight in pose graph (assuming 1 for landmarks)
   real base_information_frame = 1e5;
 
@@ -363,6 +453,12 @@ public:
 
   //! @brief minimum estimation correction to update the internal map
   real minimum_estimation_delta_for_update_meters = 0.01;
+
+  //! @brief optimize only the part of the pose graph affected by new closures (the local maps since the oldest reference, expanded over their closures)
+  bool enable_incremental_optimization = false;
+
+  //! @brief hierarchical pose graph: number of consecutive local maps condensed into a segment, closures are solved on the graph of segments (0: flat pose graph)
+  Count number_of_local_maps_per_segment = 0;
 };
 
 //! @class image viewer parameters
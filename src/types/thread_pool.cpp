@@ -0,0 +1,94 @@
+#include "thread_pool.h"
+
+namespace proslam {
+
+ThreadPool::ThreadPool(const Count& number_of_threads_) {
+  _workers.clear();
+
+  //ds the calling thread is always used for processing
+  for (Count u = 1; u < number_of_threads_; ++u) {
+    _workers.push_back(std::thread([=] {_work();}));
+  }
+  LOG_INFO(std::cerr << "ThreadPool::ThreadPool|constructed with threads: " << numberOfThreads() << std::endl)
+}
+
+ThreadPool::~ThreadPool() {
+  LOG_INFO(std::cerr << "ThreadPool::~ThreadPool|destroying" << std::endl)
+  {
+    std::lock_guard<std::mutex> lock(_mutex_tasks);
+    _is_termination_requested = true;
+  }
+  _tasks_available.notify_all();
+  for (std::thread& worker: _workers) {
+    worker.join();
+  }
+  _workers.clear();
+  LOG_INFO(std::cerr << "ThreadPool::~ThreadPool|destroyed" << std::endl)
+}
+
+void ThreadPool::execute(const Count& number_of_tasks_, const std::function<void(const Index&)>& task_) {
+
+  //ds nothing to parallelize
+  if (_workers.empty() || number_of_tasks_ < 2) {
+    for (Index index = 0; index < number_of_tasks_; ++index) {
+      task_(index);
+    }
+    return;
+  }
+  std::lock_guard<std::mutex> lock_execution(_mutex_execution);
+
+  //ds publish tasks
+  std::unique_lock<std::mutex> lock(_mutex_tasks);
+  _task                      = &task_;
+  _number_of_tasks           = number_of_tasks_;
+  _index_next_task           = 0;
+  _number_of_completed_tasks = 0;
+  lock.unlock();
+  _tasks_available.notify_all();
+  lock.lock();
+
+  //ds participate in processing
+  while (_index_next_task < _number_of_tasks) {
+    const Index index = _index_next_task;
+    ++_index_next_task;
+    lock.unlock();
+    task_(index);
+    lock.lock();
+    ++_number_of_completed_tasks;
+  }
+
+  //ds wait for the workers to complete their last tasks
+  _tasks_completed.wait(lock, [&] {return _number_of_completed_tasks == _number_of_tasks;});
+
+  //ds reset bookkeeping (workers go back to sleep)
+  _task            = nullptr;
+  _number_of_tasks = 0;
+  _index_next_task = 0;
+}
+
+void ThreadPool::_work() {
+  std::unique_lock<std::mutex> lock(_mutex_tasks);
+  while (true) {
+
+    //ds wait for a task or termination
+    _tasks_available.wait(lock, [&] {return _is_termination_requested || _index_next_task < _number_of_tasks;});
+    if (_is_termination_requested) {
+      break;
+    }
+
+    //ds grab the next task and process it without holding the lock
+    const Index index = _index_next_task;
+    ++_index_next_task;
+    const std::function<void(const Index&)>* task = _task;
+    lock.unlock();
+    (*task)(index);
+    lock.lock();
+
+    //ds signal if all tasks are completed
+    ++_number_of_completed_tasks;
+    if (_number_of_completed_tasks == _number_of_tasks) {
+      _tasks_completed.notify_all();
+    }
+  }
+}
+}
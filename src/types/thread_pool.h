@@ -0,0 +1,77 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "definitions.h"
+
+namespace proslam {
+
+//! @class minimal pool of persistent worker threads, processing an indexed set of tasks in parallel (parallel for)
+//! @brief tasks must not call execute on the same pool (no nesting) - concurrent execute calls from different threads are serialized
+class ThreadPool {
+
+//ds object handling
+public:
+
+  //! @brief constructs a pool with the given number of threads (including the calling thread)
+  //! @param[in] number_of_threads_ total number of threads - for 0 or 1 no workers are launched and all tasks run on the calling thread
+  ThreadPool(const Count& number_of_threads_);
+
+  //! @brief terminates and joins all workers
+  ~ThreadPool();
+
+  //! @brief prohibit default construction and copies
+  ThreadPool() = delete;
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+//ds functionality
+public:
+
+  //! @brief runs task_(index) for all indices in [0, number_of_tasks_) and blocks until all tasks are completed
+  //! @brief the calling thread participates in the processing, the assignment of indices to threads is arbitrary
+  //! @param[in] number_of_tasks_ number of tasks to process
+  //! @param[in] task_ task function, called with the task index
+  void execute(const Count& number_of_tasks_, const std::function<void(const Index&)>& task_);
+
+//ds getters/setters
+public:
+
+  //! @brief total number of threads used for processing (including the calling thread)
+  const Count numberOfThreads() const {return _workers.size()+1;}
+
+//ds helpers
+protected:
+
+  //! @brief worker loop
+  void _work();
+
+//ds attributes
+protected:
+
+  //! @brief worker threads (the calling thread is not included)
+  std::vector<std::thread> _workers;
+
+  //! @brief serializes concurrent execute calls
+  std::mutex _mutex_execution;
+
+  //! @brief task bookkeeping access and notification
+  std::mutex _mutex_tasks;
+  std::condition_variable _tasks_available;
+  std::condition_variable _tasks_completed;
+
+  //! @brief current task function (only set during execute)
+  const std::function<void(const Index&)>* _task = nullptr;
+
+  //! @brief task bookkeeping of the current execute call
+  Count _number_of_tasks           = 0;
+  Index _index_next_task           = 0;
+  Count _number_of_completed_tasks = 0;
+
+  //! @brief worker termination request
+  bool _is_termination_requested = false;
+};
+
+typedef std::shared_ptr<ThreadPool> ThreadPoolPtr;
+}
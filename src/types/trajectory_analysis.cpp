@@ -0,0 +1,273 @@
+#include "trajectory_analysis.h"
+
+#include <fstream>
+
+namespace proslam {
+
+PositionMeasurementVector loadPositionsTUM(const std::string& file_name_, const Count& number_of_poses_to_skip_) {
+  std::ifstream input_stream(file_name_);
+  if (!input_stream.good() || !input_stream.is_open()) {
+    throw std::runtime_error("loadPositionsTUM|unable to open: '" + file_name_ + "'");
+  }
+
+  //ds load poses
+  PositionMeasurementVector positions;
+  std::string buffer_line;
+  Count skipped_poses = 0;
+  while (std::getline(input_stream, buffer_line)) {
+
+    //ds get line to a string stream object
+    std::istringstream stringstream(buffer_line);
+
+    //ds possible values
+    double timestamp_seconds = 0;
+    real translation_x = 0;
+    real translation_y = 0;
+    real translation_z = 0;
+    real quaternion_w  = 0;
+    real quaternion_x  = 0;
+    real quaternion_y  = 0;
+    real quaternion_z  = 0;
+
+    //ds parse the full line and check for failure
+    if (!(stringstream >> timestamp_seconds >> translation_x >> translation_y >> translation_z
+                                            >> quaternion_x >> quaternion_y >> quaternion_z >> quaternion_w)) {
+      throw std::runtime_error("loadPositionsTUM|unable to parse pose lines in: '" + file_name_ + "'");
+    }
+    if (skipped_poses >= number_of_poses_to_skip_) {
+      positions.push_back(PositionMeasurement(timestamp_seconds, PointCoordinates(translation_x, translation_y, translation_z)));
+    } else {
+      ++skipped_poses;
+    }
+  }
+  input_stream.close();
+
+  //ds also cut skipped poses from the end
+  if (number_of_poses_to_skip_ >= positions.size()) {
+    throw std::runtime_error("loadPositionsTUM|insufficient number of measurements for number_of_poses_to_skip: " + std::to_string(number_of_poses_to_skip_));
+  }
+  positions.resize(positions.size()-number_of_poses_to_skip_);
+  return positions;
+}
+
+PositionMeasurementVector loadPositionsASL(const std::string& file_name_) {
+  std::ifstream input_stream(file_name_);
+  if (!input_stream.good() || !input_stream.is_open()) {
+    throw std::runtime_error("loadPositionsASL|unable to open: '" + file_name_ + "'");
+  }
+
+  //ds load ground truth poses
+  PositionMeasurementVector positions;
+  std::string buffer_line;
+  while (std::getline(input_stream, buffer_line)) {
+
+    //ds skip comment and empty lines
+    if (buffer_line.empty() || buffer_line[0] == '#') {
+      continue;
+    }
+
+    //ds parse control
+    std::string::size_type index_begin_item = 0;
+    std::string::size_type index_end_item   = 0;
+
+    //ds parse timestamp
+    index_end_item = buffer_line.find(",", index_begin_item);
+    const uint64_t timestamp_nanoseconds = std::atol(buffer_line.substr(index_begin_item, index_end_item).c_str());
+    const double timestamp_seconds       = timestamp_nanoseconds/1e9;
+    index_begin_item = index_end_item+1;
+
+    //ds position buffer
+    PointCoordinates position(PointCoordinates::Zero());
+    for (uint32_t row = 0; row < 3; ++row) {
+      index_end_item = buffer_line.find(",", index_begin_item);
+      position(row)  = std::strtod(buffer_line.substr(index_begin_item, index_end_item-index_begin_item).c_str(), 0);
+      index_begin_item = index_end_item+1;
+    }
+    positions.push_back(PositionMeasurement(timestamp_seconds, position));
+  }
+  input_stream.close();
+  return positions;
+}
+
+PositionMeasurementVector loadPositionsKITTI(const std::string& file_name_) {
+  std::ifstream input_stream(file_name_);
+  if (!input_stream.good() || !input_stream.is_open()) {
+    throw std::runtime_error("loadPositionsKITTI|unable to open: '" + file_name_ + "'");
+  }
+
+  //ds load poses, only the translation column is kept
+  PositionMeasurementVector positions;
+  std::string buffer_line;
+  while (std::getline(input_stream, buffer_line)) {
+    std::istringstream stringstream(buffer_line);
+    Matrix3_4 pose(Matrix3_4::Zero());
+    for (uint32_t row = 0; row < 3; ++row) {
+      for (uint32_t col = 0; col < 4; ++col) {
+        stringstream >> pose(row, col);
+      }
+    }
+    if (!stringstream) {
+      continue;
+    }
+    positions.push_back(PositionMeasurement(positions.size(), pose.col(3)));
+  }
+  input_stream.close();
+  return positions;
+}
+
+PositionCorrespondenceVector getPositionCorrespondences(const PositionMeasurementVector& positions_,
+                                                        const PositionMeasurementVector& positions_ground_truth_) {
+  PositionCorrespondenceVector position_correspondences;
+  PointCoordinates position_shift(PointCoordinates::Zero());
+
+  //ds for each measurement
+  for (uint64_t index_slam = 0; index_slam < positions_.size(); ++index_slam) {
+    PositionMeasurement measurement = positions_[index_slam];
+
+    //ds find closest ground truth point - bruteforce
+    double timestamp_difference_seconds_best = 1;
+    uint64_t index_best                      = 0;
+    for (uint64_t index_ground_truth = 0; index_ground_truth < positions_ground_truth_.size(); ++index_ground_truth) {
+      const double timestamp_difference_seconds = std::fabs(measurement.timestamp_seconds-positions_ground_truth_[index_ground_truth].timestamp_seconds);
+      if (timestamp_difference_seconds < timestamp_difference_seconds_best) {
+        timestamp_difference_seconds_best = timestamp_difference_seconds;
+        index_best = index_ground_truth;
+      }
+    }
+
+    //ds skip until we arrive at the ground truth timestamp (and if there is no ground truth to interpolate to)
+    if (index_best == 0) {
+      continue;
+    }
+
+    //ds solution
+    PositionMeasurement ground_truth_interpolated(measurement.timestamp_seconds, measurement.position);
+
+    //ds interpolation: check if before the system
+    if (positions_ground_truth_[index_best].timestamp_seconds < measurement.timestamp_seconds) {
+      if (index_best+1 == positions_ground_truth_.size()) {
+        continue;
+      }
+
+      //ds interpolate to next
+      ground_truth_interpolated.position = getInterpolatedPositionLinear(positions_ground_truth_[index_best], positions_ground_truth_[index_best+1], measurement);
+    } else {
+
+      //ds interpolate from previous
+      ground_truth_interpolated.position = getInterpolatedPositionLinear(positions_ground_truth_[index_best-1], positions_ground_truth_[index_best], measurement);
+    }
+
+    //ds for the first measurement - compute starting point offset
+    if (index_slam == 0) {
+      position_shift = ground_truth_interpolated.position;
+    }
+
+    //ds adjust position
+    measurement.position += position_shift;
+    position_correspondences.push_back(std::make_pair(measurement, ground_truth_interpolated));
+  }
+  return position_correspondences;
+}
+
+const TransformMatrix3D alignPositions(PositionCorrespondenceVector& position_correspondences_,
+                                       const Count& number_of_iterations_,
+                                       const real& maximum_error_kernel_,
+                                       const bool& verbose_) {
+
+  //ds objective
+  TransformMatrix3D transform_slam_to_ground_truth(TransformMatrix3D::Identity());
+
+  //ds ICP running variables
+  Matrix6 H(Matrix6::Zero());
+  Vector6 b(Vector6::Zero());
+
+  //ds perform least squares optimization
+  for (Count iteration = 0; iteration < number_of_iterations_; ++iteration) {
+
+    //ds initialize setup
+    H.setZero();
+    b.setZero();
+    Count number_of_inliers  = 0;
+    real total_error_squared = 0;
+
+    //ds for all SLAM trajectory poses
+    for (const PositionCorrespondence& position_correspondence: position_correspondences_) {
+
+      //ds compute current error
+      const PointCoordinates& measured_point_in_reference = position_correspondence.second.position;
+      const PointCoordinates sampled_point_in_reference   = transform_slam_to_ground_truth*position_correspondence.first.position;
+      const Vector3 error                                 = sampled_point_in_reference-measured_point_in_reference;
+
+      //ds update chi
+      const real error_squared = error.transpose()*error;
+
+      //ds check if outlier
+      real weight = 1.0;
+      if (error_squared > maximum_error_kernel_) {
+        weight = maximum_error_kernel_/error_squared;
+      } else {
+        ++number_of_inliers;
+      }
+      total_error_squared += error_squared;
+
+      //ds get the jacobian of the transform part = [I -2*skew(T*modelPoint)]
+      Matrix3_6 jacobian;
+      jacobian.block<3,3>(0,0).setIdentity();
+      jacobian.block<3,3>(0,3) = -2*srrg_core::skew(sampled_point_in_reference);
+
+      //ds precompute transposed
+      const Matrix6_3 jacobian_transposed(jacobian.transpose());
+
+      //ds accumulate
+      H += weight*jacobian_transposed*jacobian;
+      b += weight*jacobian_transposed*error;
+    }
+
+    //ds solve the system and update the estimate
+    transform_slam_to_ground_truth = srrg_core::v2t(static_cast<const Vector6&>(H.ldlt().solve(-b)))*transform_slam_to_ground_truth;
+
+    //ds enforce rotation symmetry
+    const Matrix3 rotation   = transform_slam_to_ground_truth.linear();
+    Matrix3 rotation_squared = rotation.transpose( )*rotation;
+    rotation_squared.diagonal().array()     -= 1;
+    transform_slam_to_ground_truth.linear() -= 0.5*rotation*rotation_squared;
+
+    //ds status
+    if (verbose_) {
+      std::printf("iteration: %03u total error (m^2): %12.3f (inliers: %4u/%4lu=%4.2f)\n",
+                  iteration, total_error_squared, number_of_inliers, position_correspondences_.size(), static_cast<double>(number_of_inliers)/position_correspondences_.size());
+    }
+  }
+
+  //ds compute optimal poses
+  for (PositionCorrespondence& position_correspondence: position_correspondences_) {
+    position_correspondence.first.position = transform_slam_to_ground_truth*position_correspondence.first.position;
+  }
+  return transform_slam_to_ground_truth;
+}
+
+const real getAbsoluteTranslationRootMeanSquaredError(const PositionCorrespondenceVector& position_correspondences_) {
+  if (position_correspondences_.empty()) {
+    return 0;
+  }
+
+  //ds accumulate absolute squared errors
+  real root_mean_squared_error_translation_absolute = 0;
+  for (const PositionCorrespondence& position_correspondence: position_correspondences_) {
+    root_mean_squared_error_translation_absolute += (position_correspondence.first.position-position_correspondence.second.position).squaredNorm();
+  }
+  root_mean_squared_error_translation_absolute /= position_correspondences_.size();
+  return std::sqrt(root_mean_squared_error_translation_absolute);
+}
+
+const PointCoordinates getInterpolatedPositionLinear(const PositionMeasurement& ground_truth_previous_,
+                                                     const PositionMeasurement& ground_truth_next_,
+                                                     const PositionMeasurement& measurement_) {
+  const double timestamp_difference_seconds_ground_truth = ground_truth_next_.timestamp_seconds-ground_truth_previous_.timestamp_seconds;
+  const double timestamp_difference_seconds              = measurement_.timestamp_seconds-ground_truth_previous_.timestamp_seconds;
+
+  //ds compute interpolated reference measurement
+  return ground_truth_previous_.position+timestamp_difference_seconds/timestamp_difference_seconds_ground_truth*
+                                         (ground_truth_next_.position-ground_truth_previous_.position);
+}
+}
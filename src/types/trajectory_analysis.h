@@ -0,0 +1,60 @@
+#pragma once
+#include "definitions.h"
+
+namespace proslam {
+
+//! @struct timestamped position, e.g. of a trajectory pose
+struct PositionMeasurement {
+  PositionMeasurement(const double& timestamp_seconds_,
+                      const PointCoordinates& position_): timestamp_seconds(timestamp_seconds_),
+                                                          position(position_) {}
+  PositionMeasurement(): timestamp_seconds(0), position(PointCoordinates::Zero()) {}
+  double timestamp_seconds;
+  PointCoordinates position;
+};
+typedef std::vector<PositionMeasurement> PositionMeasurementVector;
+
+//! @brief correspondence between an estimated (first) and a ground truth (second) position
+typedef std::pair<PositionMeasurement, PositionMeasurement> PositionCorrespondence;
+typedef std::vector<PositionCorrespondence> PositionCorrespondenceVector;
+
+//! @brief loads a trajectory in TUM format (timestamp x y z qx qy qz qw per line)
+//! @param[in] file_name_ trajectory file, throws if not readable or malformed
+//! @param[in] number_of_poses_to_skip_ number of poses to drop at the beginning and the end of the trajectory
+PositionMeasurementVector loadPositionsTUM(const std::string& file_name_, const Count& number_of_poses_to_skip_ = 0);
+
+//! @brief loads a ground truth trajectory in ASL format (EuRoC: timestamp [ns], x, y, z, .. per line, # for comments)
+//! @param[in] file_name_ ground truth file, throws if not readable
+PositionMeasurementVector loadPositionsASL(const std::string& file_name_);
+
+//! @brief loads a trajectory in KITTI format (row-major 3x4 isometry per line), timestamps are set to the pose index
+//! @param[in] file_name_ trajectory file, throws if not readable
+PositionMeasurementVector loadPositionsKITTI(const std::string& file_name_);
+
+//! @brief associates estimated positions with ground truth positions, linearly interpolated at the estimate timestamps
+//! @brief estimates without surrounding ground truth (within 1 second) are skipped, the first estimate defines the starting point offset
+//! @param[in] positions_ estimated positions
+//! @param[in] positions_ground_truth_ ground truth positions, sorted by timestamp
+//! @return the position correspondences (estimates shifted by the starting point offset)
+PositionCorrespondenceVector getPositionCorrespondences(const PositionMeasurementVector& positions_,
+                                                        const PositionMeasurementVector& positions_ground_truth_);
+
+//! @brief estimates the rigid transform from the estimated to the ground truth positions (robust least squares) and applies it to the estimates
+//! @param[in,out] position_correspondences_ correspondences, the estimated positions are replaced by the aligned ones
+//! @param[in] number_of_iterations_ number of least squares iterations
+//! @param[in] maximum_error_kernel_ robust kernel size (m^2)
+//! @param[in] verbose_ print the error for each iteration
+//! @return the estimated to ground truth transform
+const TransformMatrix3D alignPositions(PositionCorrespondenceVector& position_correspondences_,
+                                       const Count& number_of_iterations_ = 100,
+                                       const real& maximum_error_kernel_ = 1,
+                                       const bool& verbose_ = false);
+
+//! @brief root mean squared absolute translation error (ATE) over all correspondences
+const real getAbsoluteTranslationRootMeanSquaredError(const PositionCorrespondenceVector& position_correspondences_);
+
+//! @brief linear interpolation of a ground truth position at the timestamp of a measurement
+const PointCoordinates getInterpolatedPositionLinear(const PositionMeasurement& ground_truth_previous_,
+                                                     const PositionMeasurement& ground_truth_next_,
+                                                     const PositionMeasurement& measurement_);
+}
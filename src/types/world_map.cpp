@@ -2,12 +2,19 @@
 
 #include <fstream>
 #include <iomanip>
+#include <unordered_map>
 
 namespace proslam {
 using namespace srrg_core;
 
-WorldMap::WorldMap(const WorldMapParameters* parameters_): _parameters(parameters_) {
+WorldMap::WorldMap(const WorldMapParameters* parameters_): _frame_pool(256),
+                                                           _framepoint_pool(4096),
+                                                           _landmark_pool(1024),
+                                                           _parameters(parameters_) {
   LOG_INFO(std::cerr << "WorldMap::WorldMap|constructing" << std::endl)
+  if (_parameters->number_of_landmark_update_threads > 1) {
+    _thread_pool = std::make_shared<ThreadPool>(_parameters->number_of_landmark_update_threads);
+  }
   clear();
   LOG_INFO(std::cerr << "WorldMap::WorldMap|constructed" << std::endl)
 }
@@ -24,13 +31,13 @@ void WorldMap::clear() {
   //ds free landmarks
   LOG_INFO(std::cerr << "WorldMap::clear|deleting landmarks: " << _landmarks.size() << std::endl)
   for(LandmarkPointerMap::iterator it = _landmarks.begin(); it != _landmarks.end(); ++it) {
-    delete it->second;
+    _landmark_pool.destroy(it->second);
   }
 
   //ds free all frames
   LOG_INFO(std::cerr << "WorldMap::clear|deleting frames: " << _frames.size() << std::endl)
   for(FramePointerMap::iterator it = _frames.begin(); it != _frames.end(); ++it) {
-    delete it->second;
+    _frame_pool.destroy(it->second);
   }
 
   //ds free all local maps
@@ -45,13 +52,21 @@ void WorldMap::clear() {
   _frames.clear();
   _local_maps.clear();
   _currently_tracked_landmarks.clear();
+  _staged_landmark_coordinates.clear();
+  _identifier_next_frame_to_compact = 0;
+
+  //ds rewind object pools in bulk (memory is kept for the next run)
+  _landmark_pool.reset();
+  _framepoint_pool.reset();
+  _frame_pool.reset();
 }
 
 Frame* WorldMap::createFrame(const double& timestamp_image_left_seconds_){
 
   //ds update current frame
   _previous_frame = _current_frame;
-  _current_frame  = new Frame(this, _previous_frame, 0, robot_to_world, timestamp_image_left_seconds_);
+  _current_frame  = _frame_pool.create(this, _previous_frame, nullptr, robot_to_world, timestamp_image_left_seconds_);
+  _current_frame->_framepoint_pool = &_framepoint_pool;
 
   //ds check if the frame has a predecessor
   if (_previous_frame) {
@@ -72,7 +87,7 @@ Frame* WorldMap::createFrame(const double& timestamp_image_left_seconds_){
 }
 
 Landmark* WorldMap::createLandmark(FramePoint* origin_) {
-  Landmark* landmark = new Landmark(origin_, _parameters->landmark);
+  Landmark* landmark = _landmark_pool.create(origin_, _parameters->landmark);
   _landmarks.insert(std::make_pair(landmark->identifier(), landmark));
   return landmark;
 }
@@ -84,7 +99,7 @@ void WorldMap::removeLandmark(const Identifier& identifier_) {
     if (_landmarks.erase(identifier_) != 1) {
       LOG_WARNING(std::cerr << "WorldMap::removeLandmark|unable to remove landmark with ID: " << identifier_ << std::endl)
     } else {
-      delete landmark_to_remove;
+      _landmark_pool.destroy(landmark_to_remove);
     }
   } else {
     LOG_WARNING(std::cerr << "WorldMap::removeLandmark|unable to remove landmark with ID: " << identifier_ << std::endl)
@@ -95,6 +110,7 @@ LocalMap* WorldMap::createLocalMap(const bool& drop_framepoints_) {
   if (!_previous_frame) {
     return nullptr;
   }
+  CHRONOMETER_START(local_map_creation)
 
   //ds reset closure status
   _relocalized = false;
@@ -129,10 +145,12 @@ LocalMap* WorldMap::createLocalMap(const bool& drop_framepoints_) {
     resetWindowForLocalMapCreation(drop_framepoints_);
 
     //ds local map generated
+    CHRONOMETER_STOP(local_map_creation)
     return _current_local_map;
   } else {
 
     //ds no local map generated
+    CHRONOMETER_STOP(local_map_creation)
     return nullptr;
   }
 }
@@ -159,18 +177,85 @@ void WorldMap::resetWindowForLocalMapCreation(const bool& drop_framepoints_) {
   _frame_queue_for_local_map.clear();
 }
 
+Count WorldMap::compactFrames(const LocalMap* local_map_) {
+  if (_parameters->maximum_memory_megabytes <= 0 || !_current_frame || !local_map_) {
+    return 0;
+  }
+  CHRONOMETER_START(frame_compaction)
+
+  //ds only frames up to the processed keyframe and outside of the sliding window are considered (the last 2 frames are required for tracking)
+  const Count number_of_frames_in_window = std::max(_parameters->minimum_number_of_frames_in_window, Count(2));
+  if (_current_frame->identifier() < number_of_frames_in_window) {
+    CHRONOMETER_STOP(frame_compaction)
+    return 0;
+  }
+  const Identifier identifier_end = std::min(local_map_->keyframe()->identifier()+1, _current_frame->identifier()+1-number_of_frames_in_window);
+
+  //ds estimate the current memory footprint: all frame and landmark instances and the data of the frames that have not been compacted yet
+  //ds the data of the full frames dominates - it is bounded by the budget, hence this loop is as well
+  size_t memory_bytes = _frame_pool.numberOfActiveObjects()*sizeof(Frame)+_landmark_pool.numberOfActiveObjects()*sizeof(Landmark);
+  for (FramePointerMap::const_iterator iterator = _frames.lower_bound(_identifier_next_frame_to_compact); iterator != _frames.end(); ++iterator) {
+    memory_bytes += iterator->second->sizeBytes();
+  }
+
+  //ds compact the oldest frames until we meet the budget
+  const size_t maximum_memory_bytes = _parameters->maximum_memory_megabytes*1e6;
+  Count number_of_compacted_frames  = 0;
+  Count number_of_freed_landmarks   = 0;
+  FramePointerMap::iterator iterator = _frames.lower_bound(_identifier_next_frame_to_compact);
+  while (memory_bytes > maximum_memory_bytes && iterator != _frames.end() && iterator->first < identifier_end) {
+    Frame* frame = iterator->second;
+    memory_bytes -= frame->sizeBytes();
+
+    //ds archive landmarks whose tracks end in this frame (they have no measurements in the remaining frames)
+    for (FramePoint* frame_point: frame->createdPoints()) {
+      Landmark* landmark = frame_point->landmark();
+      if (landmark && landmark->_last_update->frame()->identifier() <= frame->identifier()) {
+        landmark->archive();
+        ++_number_of_archived_landmarks;
+
+        //ds landmarks that are not part of a local map are not referenced anymore and can be freed
+        if (landmark->_local_maps.empty()) {
+          _landmarks.erase(landmark->identifier());
+          _landmark_pool.destroy(landmark);
+          memory_bytes -= sizeof(Landmark);
+          ++number_of_freed_landmarks;
+        }
+      }
+    }
+
+    //ds drop points, features and images (this links remaining tracks to their next framepoint)
+    frame->compact();
+    ++number_of_compacted_frames;
+    ++iterator;
+    _identifier_next_frame_to_compact = frame->identifier()+1;
+  }
+  _memory_bytes_estimate       = memory_bytes;
+  _number_of_compacted_frames += number_of_compacted_frames;
+  if (number_of_compacted_frames > 0) {
+    LOG_DEBUG(std::cerr << "WorldMap::compactFrames|compacted frames: " << number_of_compacted_frames << " (freed landmarks: " << number_of_freed_landmarks
+                        << ") estimated memory (MB): " << memory_bytes/1e6 << std::endl)
+  }
+  if (memory_bytes > maximum_memory_bytes) {
+    LOG_DEBUG(std::cerr << "WorldMap::compactFrames|memory budget exceeded by sliding window (MB): " << memory_bytes/1e6 << std::endl)
+  }
+  CHRONOMETER_STOP(frame_compaction)
+  return number_of_compacted_frames;
+}
+
 void WorldMap::addLoopClosure(LocalMap* query_,
                               LocalMap* reference_,
                               const TransformMatrix3D& query_to_reference_,
                               const Closure::CorrespondencePointerVector& landmark_correspondences_,
                               const real& information_) {
 
-  //ds check if we relocalized after a lost track
-  if (_frames.at(0)->root() != _current_frame->root()) {
-    assert(_current_frame->localMap() == query_);
+  //ds check if we relocalized after a lost track (the query keyframe is the current frame unless the closure is processed asynchronously)
+  Frame* keyframe_query = query_->keyframe();
+  if (_frames.at(0)->root() != keyframe_query->root()) {
+    assert(keyframe_query->localMap() == query_);
 
-    //ds rudely link the current frame into the list (proper map merging will be coming soon!)
-    setTrack(_current_frame);
+    //ds rudely link the query keyframe into the list (proper map merging will be coming soon!)
+    setTrack(keyframe_query);
   }
 
   //ds add loop closure information to the world map
@@ -466,11 +551,58 @@ void WorldMap::mergeLandmarks(const Closure::ClosureConstraintVector& closures_)
     } else {
 
       //ds free landmark memory
-      delete landmark_query;
+      _landmark_pool.destroy(landmark_query);
     }
   }
   LOG_DEBUG(std::cerr << "WorldMap::mergeLandmarks|merged landmarks: " << merged_landmark_identifiers.size() << std::endl)
   _number_of_merged_landmarks += merged_landmark_identifiers.size();
   CHRONOMETER_STOP(landmark_merging)
 }
+
+void WorldMap::stageLandmarkCoordinates(const LocalMapPointerVector& local_maps_) {
+  CHRONOMETER_START(landmark_update)
+  _staged_landmark_coordinates.clear();
+
+  //ds determine the placing local map for every landmark (snapshots are referenced, not copied)
+  std::unordered_map<const Landmark*, Index> staged_indices;
+  for (LocalMap* local_map: local_maps_) {
+    for (Closure::LandmarkStateMapElement& element: local_map->landmarks()) {
+      const std::pair<std::unordered_map<const Landmark*, Index>::iterator, bool> insertion =
+        staged_indices.insert(std::make_pair(element.second.landmark, _staged_landmark_coordinates.size()));
+      if (insertion.second) {
+        _staged_landmark_coordinates.push_back(LandmarkCoordinatesUpdate(element.second.landmark, local_map, &element.second.coordinates_in_local_map));
+      } else {
+        LandmarkCoordinatesUpdate& update = _staged_landmark_coordinates[insertion.first->second];
+        update.local_map                  = local_map;
+        update.coordinates_in_local_map   = &element.second.coordinates_in_local_map;
+      }
+    }
+  }
+
+  //ds compute the world coordinates in contiguous blocks, one per thread
+  const uint64_t number_of_updates = _staged_landmark_coordinates.size();
+  const Count number_of_blocks     = (_thread_pool) ? _thread_pool->numberOfThreads() : 1;
+  auto computeBlock = [&](const Index& block_) {
+    for (uint64_t u = block_*number_of_updates/number_of_blocks; u < (block_+1)*number_of_updates/number_of_blocks; ++u) {
+      LandmarkCoordinatesUpdate& update = _staged_landmark_coordinates[u];
+      update.coordinates = update.local_map->robotToWorld()*(*update.coordinates_in_local_map);
+    }
+  };
+  if (number_of_blocks > 1) {
+    _thread_pool->execute(number_of_blocks, computeBlock);
+  } else {
+    computeBlock(0);
+  }
+  CHRONOMETER_STOP(landmark_update)
+}
+
+void WorldMap::commitLandmarkCoordinates() {
+  CHRONOMETER_START(landmark_update)
+  for (const LandmarkCoordinatesUpdate& update: _staged_landmark_coordinates) {
+    update.landmark->setCoordinates(update.coordinates);
+  }
+  LOG_DEBUG(std::cerr << "WorldMap::commitLandmarkCoordinates|updated landmarks: " << _staged_landmark_coordinates.size() << std::endl)
+  _staged_landmark_coordinates.clear();
+  CHRONOMETER_STOP(landmark_update)
+}
 }
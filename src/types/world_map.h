@@ -1,5 +1,6 @@
 #pragma once
 #include "local_map.h"
+#include "thread_pool.h"
 
 namespace proslam {
 
@@ -37,6 +38,12 @@ public:
   //ds resets the window for the local map generation
   void resetWindowForLocalMapCreation(const bool& drop_framepoints_ = false);
 
+  //! @brief enforces the memory budget (sliding window mode): compacts the oldest frames to pose and timestamp until the budget is met
+  //! @brief landmarks whose tracks ended in a compacted frame are archived (kept as snapshot if part of a local map, freed otherwise)
+  //! @param[in] local_map_ the most recent local map that has been processed by relocalization and pose graph (only older frames are compacted)
+  //! @return number of compacted frames
+  Count compactFrames(const LocalMap* local_map_);
+
   //! @brief adds a loop closure constraint between 2 local maps
   //! @param[in] query_ query local map
   //! @param[in] reference_ reference local map (fixed, closed against)
@@ -113,6 +120,14 @@ public:
   const LandmarkPointerVector& currentlyTrackedLandmarks() const {return _currently_tracked_landmarks;}
   void mergeLandmarks(const Closure::ClosureConstraintVector& closures_);
 
+  //! @brief computes the world coordinates of the landmarks in the provided local maps from their snapshots (e.g. after pose graph optimization)
+  //! @brief the map is not modified (no exclusive access required, parallel if configured) - the coordinates are assigned by commitLandmarkCoordinates
+  //! @param[in] local_maps_ moved local maps in order of creation, a landmark contained in several of them is placed by the most recent one
+  void stageLandmarkCoordinates(const LocalMapPointerVector& local_maps_);
+
+  //! @brief assigns the landmark coordinates computed by the last stageLandmarkCoordinates call (exclusive map access required)
+  void commitLandmarkCoordinates();
+
   LocalMap* currentLocalMap() {return _current_local_map;}
   const LocalMapPointerVector& localMaps() const {return _local_maps;}
 
@@ -123,6 +138,14 @@ public:
   const bool relocalized() const {return _relocalized;}
   const Count& numberOfClosures() const {return _number_of_closures;}
   const Count& numberOfMergedLandmarks() const {return _number_of_merged_landmarks;}
+  const Count& numberOfCompactedFrames() const {return _number_of_compacted_frames;}
+  const Count& numberOfArchivedLandmarks() const {return _number_of_archived_landmarks;}
+  const size_t& memoryBytesEstimate() const {return _memory_bytes_estimate;}
+
+  //! @brief object pools (allocation counters, a steady state map performs no chunk allocations - object buffers are counted by Frame and Landmark)
+  const ObjectPool<Frame>& framePool() const {return _frame_pool;}
+  const ObjectPool<FramePoint>& framepointPool() const {return _framepoint_pool;}
+  const ObjectPool<Landmark>& landmarkPool() const {return _landmark_pool;}
 
   //ds visualization only
   const FramePointerMap& frames() const {return _frames;}
@@ -143,6 +166,11 @@ public:
 
 protected:
 
+  //! @brief memory for all frames, framepoints and landmarks in the map (framepoints are created by the frames)
+  ObjectPool<Frame> _frame_pool;
+  ObjectPool<FramePoint> _framepoint_pool;
+  ObjectPool<Landmark> _landmark_pool;
+
   //ds robot path information
   const Frame* _root_frame = 0;
   Frame* _current_frame    = 0;
@@ -175,9 +203,37 @@ protected:
   LocalMap* _last_local_map_before_track_break = nullptr;
   LocalMap* _root_local_map                    = nullptr;
 
+  //! @brief sliding window: identifier of the oldest frame that has not been compacted yet
+  Identifier _identifier_next_frame_to_compact = 0;
+
+  //! @brief landmark coordinates computed from a local map snapshot, pending assignment
+  struct LandmarkCoordinatesUpdate {
+    LandmarkCoordinatesUpdate(Landmark* landmark_,
+                              const LocalMap* local_map_,
+                              const PointCoordinates* coordinates_in_local_map_): landmark(landmark_),
+                                                                                  local_map(local_map_),
+                                                                                  coordinates_in_local_map(coordinates_in_local_map_) {}
+    Landmark* landmark;
+    const LocalMap* local_map;
+    const PointCoordinates* coordinates_in_local_map;
+    PointCoordinates coordinates;
+  };
+
+  //! @brief landmark coordinates computed by stageLandmarkCoordinates
+  std::vector<LandmarkCoordinatesUpdate> _staged_landmark_coordinates;
+
+  //! @brief workers for the landmark coordinates computation (nullptr if single threaded)
+  ThreadPoolPtr _thread_pool = nullptr;
+
   //ds informative only
+  CREATE_CHRONOMETER(local_map_creation)
   CREATE_CHRONOMETER(landmark_merging)
-  Count _number_of_merged_landmarks = 0;
+  CREATE_CHRONOMETER(frame_compaction)
+  CREATE_CHRONOMETER(landmark_update)
+  Count _number_of_merged_landmarks   = 0;
+  Count _number_of_compacted_frames   = 0;
+  Count _number_of_archived_landmarks = 0;
+  size_t _memory_bytes_estimate       = 0;
 
 private:
 